@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <fmt/core.h>
+
+#include "batch.h"
+#include "bsm_c.h"
+#include "chain.h"
+#include "options.h"
+#include "outputs.h"
+#include "thread_pool.h"
+
+using namespace bsm;
+
+// Latency of pricing the calls and puts of a 500 strike chain, as for each refresh
+// of a quoting UI, as a chain, sharing the terms of its spot, expiry and rates, by
+// the kernel of the widest instruction set, across a pool, and as a batch of 1000
+// contracts, each built as OptionValues, as before chains. Volatilities are by strike.
+namespace
+{
+
+using value_type = double;
+using Clock = std::chrono::steady_clock;
+
+constexpr const std::size_t STRIKES = 500;
+constexpr const std::size_t RUNS = 2000;
+
+struct Latency
+{
+    double median_;
+    double p99_;
+};
+
+// Median and 99th percentile latency of the given pricing, in microseconds
+template <typename Fn>
+auto measure(Fn &&price) -> Latency {
+    std::vector<double> samples(RUNS);
+    for (std::size_t run = 0; run < 50; ++run) {
+        price();
+    }
+    for (auto &sample : samples) {
+        const auto start = Clock::now();
+        price();
+        sample = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+    std::sort(samples.begin(), samples.end());
+    return { samples[RUNS / 2], samples[RUNS * 99 / 100] };
+}
+
+void report(std::string_view name, std::string_view outputs, Latency latency, double baseline) {
+    fmt::print("{:>22} {:>12} {:>12.1f} {:>12.1f} {:>10.2f}x\n", name, outputs, latency.median_, latency.p99_,
+               baseline / latency.median_);
+}
+
+} // anonymous
+
+auto main() -> int {
+    std::vector<value_type> strikes(STRIKES), volatilities(STRIKES);
+    for (std::size_t strike = 0; strike < STRIKES; ++strike) {
+        strikes[strike] = 50.0 + static_cast<value_type>(strike) * 0.2;
+        volatilities[strike] = 0.15 + 0.001 * std::abs(strikes[strike] - 100.0);
+    }
+    const Chain<value_type> chain { 100.00, strikes, 0.5, volatilities, 0.03, 0.01 };
+    ThreadPool pool;
+
+    fmt::print("{} strike chain ({} contracts), {} kernel, {} threads\n\n", STRIKES, 2 * STRIKES, bsm_kernel_isa(), pool.size());
+    fmt::print("{:>22} {:>12} {:>12} {:>12} {:>11}\n", "pricing", "outputs", "median (us)", "p99 (us)", "speedup");
+
+    for (const auto &[outputs, name] : { std::pair { OutputMask { Output::Price, Output::Delta }, "price,delta" },
+                                         std::pair { OutputMask::firstOrder(), "first order" },
+                                         std::pair { OutputMask::all(), "all" } }) {
+        OptionBatch<value_type> batch;
+        BatchResults<value_type> batchResults;
+        BatchPricer<value_type> batchPricer(outputs);
+        const auto contracts = measure([&] {
+            batch.clear();
+            for (const auto type : { OptionType::Call, OptionType::Put }) {
+                for (std::size_t strike = 0; strike < STRIKES; ++strike) {
+                    batch.push(type, OptionValues<value_type> { chain.underlyingPrice_, strikes[strike], chain.timeToExpiry_,
+                                                                volatilities[strike], chain.riskFreeInterest_,
+                                                                chain.dividendYield_ });
+                }
+            }
+            batchPricer(batch, batchResults);
+        });
+
+        ChainResults<value_type> results;
+        ChainPricer<value_type> chainPricer(outputs);
+        const auto header = measure([&] { chainPricer(chain, results); });
+        const auto dispatched = measure([&] { priceChain(chain, results, outputs); });
+        const auto parallel = measure([&] { priceChain(chain, results, outputs, &pool); });
+
+        report("batch of contracts", name, contracts, contracts.median_);
+        report("chain", name, header, contracts.median_);
+        report("chain, dispatched", name, dispatched, contracts.median_);
+        report("chain, dispatched, pool", name, parallel, contracts.median_);
+    }
+    return 0;
+}
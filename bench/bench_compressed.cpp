@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fmt/core.h>
+
+#if defined(BSM_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(BSM_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+#include "compressed_reader.h"
+#include "input_reader.h"
+#include "thread_pool.h"
+
+using namespace bsm;
+
+// Reading and parsing a portfolio from an uncompressed file, read whole, against
+// gzip and zstd compressed files, decompressed as they are read, by one thread or
+// for zstd files of many frames, by one thread per frame in flight. Expiries are
+// given in years, as date parsing would otherwise dominate.
+namespace
+{
+
+using value_type = double;
+using Clock = std::chrono::steady_clock;
+using File = std::unique_ptr<std::FILE, decltype(&std::fclose)>;
+
+constexpr const std::size_t ROWS = std::size_t{1} << 22;
+constexpr const std::size_t FRAME_SIZE = std::size_t{4} << 20;
+
+auto seconds(Clock::time_point start) -> double {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+auto makeText() -> std::string {
+    std::string text = "option_type,underlying_price,strike_price,time_to_expiry,implied_volatility,interest_rate,dividend_yield,\n";
+    for (std::size_t row = 0; row < ROWS; ++row) {
+        text += fmt::format("{},100.00,{:.2f},{:.4f},0.2,0.03,0.01,\n", (row % 2) ? "put" : "call",
+                            80.0 + static_cast<double>(row % 41), 0.05 + static_cast<double>(row % 53) * 0.09);
+    }
+    return text;
+}
+
+auto write(std::string_view bytes) -> File {
+    File file(std::tmpfile(), &std::fclose);
+    std::fwrite(bytes.data(), 1, bytes.size(), file.get());
+    std::rewind(file.get());
+    return file;
+}
+
+#if defined(BSM_HAVE_ZLIB)
+auto gzip(std::string_view text) -> std::string {
+    z_stream stream {};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&stream, static_cast<uLong>(text.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    stream.avail_in = static_cast<uInt>(text.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+#endif
+
+#if defined(BSM_HAVE_ZSTD)
+// Compressed as frames of the given size, as by 'zstd -T<n> --block-size=<size>'
+auto zstd(std::string_view text, std::size_t frameSize) -> std::string {
+    std::string compressed;
+    for (std::size_t offset = 0; offset < text.size(); offset += frameSize) {
+        const auto part = text.substr(offset, frameSize);
+        std::string out(ZSTD_compressBound(part.size()), '\0');
+        out.resize(ZSTD_compress(out.data(), out.size(), part.data(), part.size(), 3));
+        compressed += out;
+    }
+    return compressed;
+}
+#endif
+
+template <typename Reader>
+auto parse(Reader &reader) -> std::size_t {
+    InputReader<value_type> input(Format::CSV);
+    std::size_t contracts = 0;
+    while (const auto line = reader.next()) {
+        contracts += std::get<1>(input.getOptionValues(line.value())).has_value();
+    }
+    return contracts;
+}
+
+void report(std::string_view name, std::size_t compressed, std::size_t text, std::size_t threads,
+            std::size_t contracts, double elapsed) {
+    fmt::print("{:>16} {:>12.1f} {:>8.2f} {:>8} {:>10.3f} {:>12.1f} {:>14.3e}{}\n",
+               name, static_cast<double>(compressed) / (1 << 20), static_cast<double>(text) / static_cast<double>(compressed),
+               threads, elapsed, static_cast<double>(text) / (1 << 20) / elapsed, static_cast<double>(contracts) / elapsed,
+               (contracts == ROWS) ? "" : " !");
+}
+
+void measure(std::string_view name, std::string_view bytes, std::size_t text, std::size_t threads) {
+    auto file = write(bytes);
+    const auto start = Clock::now();
+    if (name == "uncompressed") {
+        BufferReader reader(file.get());
+        const auto contracts = parse(reader);
+        report(name, bytes.size(), text, 1, contracts, seconds(start));
+    }
+    else {
+        CompressedReader reader(file.get(), detectCompression(file.get()), threads);
+        const auto contracts = parse(reader);
+        report(name, bytes.size(), text, reader.threads(), contracts, seconds(start));
+    }
+}
+
+} // anonymous
+
+auto main() -> int {
+    const auto text = makeText();
+    const auto threads = defaultThreads();
+
+    fmt::print("{} contracts, {:.1f} MiB of CSV, {} threads\n\n", ROWS, static_cast<double>(text.size()) / (1 << 20), threads);
+    fmt::print("{:>16} {:>12} {:>8} {:>8} {:>10} {:>12} {:>14}\n",
+               "input", "size (MiB)", "ratio", "threads", "read (s)", "text (MiB/s)", "parse (c/s)");
+
+    measure("uncompressed", text, text.size(), 1);
+#if defined(BSM_HAVE_ZLIB)
+    measure("gzip", gzip(text), text.size(), 1);
+#endif
+#if defined(BSM_HAVE_ZSTD)
+    measure("zstd", zstd(text, text.size()), text.size(), 1);
+    measure("zstd frames", zstd(text, FRAME_SIZE), text.size(), 1);
+    measure("zstd frames", zstd(text, FRAME_SIZE), text.size(), threads);
+#endif
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+
+#include "batch.h"
+#include "huge_pages.h"
+#include "input_reader.h"
+#include "options.h"
+#include "thread_pool.h"
+
+using namespace bsm;
+
+// Ingest, random access and pricing of a whole portfolio held in memory, with its
+// input and batch columns backed by regular, transparent huge and explicit huge
+// pages in turn. Explicit huge pages fall back to transparent where none are
+// reserved (see /proc/sys/vm/nr_hugepages), as reported by the huge pages in use.
+namespace
+{
+
+using value_type = double;
+using Clock = std::chrono::steady_clock;
+
+constexpr const std::size_t ROWS = std::size_t{1} << 21;
+constexpr const std::size_t GATHERS = std::size_t{1} << 23;
+
+auto seconds(Clock::time_point start) -> double {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Portfolio as CSV, with an expiry a year from today
+auto makeInput() -> std::unique_ptr<std::FILE, decltype(&std::fclose)> {
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::tmpfile(), &std::fclose);
+    const auto next = std::time(nullptr) + 365 * 24 * 60 * 60;
+    char date[16];
+    std::strftime(date, sizeof(date), "%Y-%m-%d", std::localtime(&next));
+
+    fmt::print(file.get(), "option_type,underlying_price,strike_price,expiry_time,implied_volatility,interest_rate,dividend_yield,\n");
+    for (std::size_t row = 0; row < ROWS; ++row) {
+        fmt::print(file.get(), "{},100.00,{:.2f},{},0.2,0.03,0.01,\n", (row % 2) ? "put" : "call", 80.0 + static_cast<double>(row % 41), date);
+    }
+    std::rewind(file.get());
+    return file;
+}
+
+// Huge pages backing anonymous memory of this process, in MiB
+auto hugePagesInUse() -> double {
+    std::ifstream rollup("/proc/self/smaps_rollup");
+    for (std::string line; std::getline(rollup, line); ) {
+        if (line.starts_with("AnonHugePages:")) {
+            return std::stod(line.substr(line.find(':') + 1)) / 1024;
+        }
+    }
+    return 0;
+}
+
+} // anonymous
+
+auto main() -> int {
+    auto input = makeInput();
+    ThreadPool pool;
+
+    // Random rows, as e.g. gathered by aggregation or repricing of a subset
+    std::vector<std::uint32_t> rows(GATHERS);
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<std::uint32_t> distribution(0, ROWS - 1);
+    std::generate(rows.begin(), rows.end(), [&]() { return distribution(generator); });
+
+    fmt::print("{} contracts, {} random gathers, {} threads\n\n", ROWS, GATHERS, pool.size());
+    fmt::print("{:>12} {:>10} {:>10} {:>10} {:>12} {:>14} {:>12}\n",
+               "pages", "read (s)", "scan (s)", "build (s)", "gather (ns)", "price (c/s)", "huge (MiB)");
+
+    for (const auto mode : { PageMode::None, PageMode::Transparent, PageMode::Explicit }) {
+        setPageMode(mode);
+        const auto baseline = hugePagesInUse();
+
+        auto start = Clock::now();
+        std::rewind(input.get());
+        BufferReader lines(input.get());
+        const auto read = seconds(start);
+
+        // Lines are only split here, as parsing of their expiry dates would dominate
+        start = Clock::now();
+        std::size_t bytes = 0;
+        while (const auto line = lines.next()) {
+            bytes += line->size();
+        }
+        const auto scan = seconds(start);
+
+        start = Clock::now();
+        OptionBatch<value_type> batch;
+        for (std::size_t row = 0; row < ROWS; ++row) {
+            const auto type = (row % 2) ? OptionType::Put : OptionType::Call;
+            batch.push(type, OptionValues<value_type> { 100.00, 80.0 + static_cast<value_type>(row % 41), 1, 0.2, 0.03, 0.01 });
+        }
+        const auto build = seconds(start);
+
+        start = Clock::now();
+        value_type sum = 0;
+        for (const auto row : rows) {
+            sum += batch.strikePrice_[row] * batch.volatility_[row] + batch.timeToExpiry_[row];
+        }
+        const auto gather = seconds(start) * 1E9 / static_cast<double>(GATHERS);
+
+        ParallelPricer<value_type> pricer(pool);
+        BatchResults<value_type> results;
+        pricer(batch, results);
+        double rate = 0;
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            start = Clock::now();
+            pricer(batch, results);
+            rate = std::max(rate, static_cast<double>(batch.size()) / seconds(start));
+        }
+
+        const auto name = (mode == PageMode::None) ? "none" : (mode == PageMode::Transparent) ? "transparent" : "explicit";
+        fmt::print("{:>12} {:>10.3f} {:>10.3f} {:>10.3f} {:>12.2f} {:>14.3e} {:>12.0f}{}\n",
+                   name, read, scan, build, gather, rate, hugePagesInUse() - baseline,
+                   (sum + static_cast<value_type>(bytes) == 0) ? "!" : "");
+    }
+    return 0;
+}
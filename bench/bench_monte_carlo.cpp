@@ -0,0 +1,49 @@
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <fmt/core.h>
+
+#include "monte_carlo.h"
+#include "options.h"
+
+using namespace bsm;
+
+// Accuracy against wall clock time of pseudo-random and quasi-random simulation,
+// measured against the closed form Black Scholes value of a European call
+namespace
+{
+
+using value_type = double;
+using Clock = std::chrono::steady_clock;
+
+void benchmark(const char *name, const Simulation &simulation, const OptionValues<value_type> &input, value_type reference) {
+    const MonteCarlo<value_type> mc(simulation);
+
+    const auto start = Clock::now();
+    const auto estimate = mc.estimate<CallExecutor>(input);
+    const auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    fmt::print("{:<14} {:>6} {:>9} {:>12.6f} {:>12.2e} {:>12.2e} {:>10.3f}\n",
+               name, simulation.steps_, estimate.paths_, estimate.value_,
+               std::fabs(estimate.value_ - reference), estimate.standardError_, elapsed);
+}
+
+} // anonymous
+
+auto main() -> int {
+    const OptionValues<value_type> input { 100.00, 95.00, 0.75, 0.25, 0.05, 0.02 };
+    const auto reference = BlackScholes<value_type>().callOptionValue(input);
+
+    fmt::print("Black Scholes reference: {:.6f}\n\n", reference);
+    fmt::print("{:<14} {:>6} {:>9} {:>12} {:>12} {:>12} {:>10}\n",
+               "sequence", "steps", "paths", "value", "abs error", "std error", "time (ms)");
+
+    // Without the control variate, which would otherwise recover the reference exactly
+    for (const std::size_t steps : { 1, 16 }) {
+        for (std::size_t paths = 1 << 10; paths <= (1 << 18); paths <<= 2) {
+            benchmark("pseudo-random", Simulation { paths, steps, MC_SEED, true, false, Sequence::PseudoRandom }, input, reference);
+            benchmark("sobol", Simulation { paths, steps, MC_SEED, true, false, Sequence::Sobol }, input, reference);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include <fmt/core.h>
+
+#include "batch.h"
+#include "options.h"
+#include "thread_pool.h"
+#include "topology.h"
+
+using namespace bsm;
+
+// Throughput of parallel batch pricing as threads are added, node by node, with
+// threads pinned to their NUMA node and chunks assigned per node, against unpinned
+// threads. Each pool is warmed up first, so that result columns are first touched
+// by the threads which then write them.
+namespace
+{
+
+using value_type = double;
+using Clock = std::chrono::steady_clock;
+
+constexpr const std::size_t ROWS = 1 << 20;
+constexpr const std::size_t REPEATS = 5;
+
+auto makeBatch() -> OptionBatch<value_type> {
+    OptionBatch<value_type> batch;
+    batch.reserve(ROWS);
+    for (std::size_t row = 0; row < ROWS; ++row) {
+        const auto type = (row % 2) ? OptionType::Put : OptionType::Call;
+        const auto strike = 80.0 + static_cast<value_type>(row % 41);
+        const auto time = 0.05 + static_cast<value_type>(row % 97) * 0.05;
+        batch.push(type, OptionValues<value_type> { 100.00, strike, time, 0.2, 0.03, 0.01 });
+    }
+    return batch;
+}
+
+// Contracts priced per second, at best of several repeats
+auto benchmark(ThreadPool &pool, const OptionBatch<value_type> &batch) -> double {
+    ParallelPricer<value_type> pricer(pool);
+    BatchResults<value_type> results;
+    pricer(batch, results);
+
+    double best = 0;
+    for (std::size_t repeat = 0; repeat < REPEATS; ++repeat) {
+        const auto start = Clock::now();
+        pricer(batch, results);
+        const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        best = std::max(best, static_cast<double>(batch.size()) / elapsed);
+    }
+    return best;
+}
+
+} // anonymous
+
+auto main() -> int {
+    const auto topology = discoverTopology();
+    const auto batch = makeBatch();
+
+    fmt::print("{} NUMA node(s), pricing {} contracts\n\n", topology.size(), batch.size());
+    fmt::print("{:>6} {:>8} {:>16} {:>16} {:>10}\n", "nodes", "threads", "pinned (c/s)", "unpinned (c/s)", "speedup");
+
+    double baseline = 0;
+    for (std::size_t nodes = 1; nodes <= topology.size(); ++nodes) {
+        const std::vector<NumaNode> used(topology.begin(), topology.begin() + static_cast<std::ptrdiff_t>(nodes));
+        std::size_t cpus = 0;
+        for (const auto &node : used) {
+            cpus += node.cpus_.size();
+        }
+
+        for (std::size_t threads = 1; threads <= cpus; threads *= 2) {
+            ThreadPool pinned(threads, Placement::Nodes, used);
+            ThreadPool unpinned(threads);
+            const auto pinnedRate = benchmark(pinned, batch);
+            const auto unpinnedRate = benchmark(unpinned, batch);
+            baseline = (baseline == 0) ? pinnedRate : baseline;
+
+            fmt::print("{:>6} {:>8} {:>16.3e} {:>16.3e} {:>10.2f}\n",
+                       nodes, threads, pinnedRate, unpinnedRate, pinnedRate / baseline);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <fmt/core.h>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Exec to exit time of the CLI, as invoked by callers pricing a single contract
+// per short lived subprocess. The bsm binary is taken from the first argument, or
+// else from alongside this benchmark, and its output is discarded.
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const std::size_t WARMUP = 10;
+constexpr const std::size_t RUNS = 500;
+
+// Expiry a year from today, as 'YYYY-mm-dd'
+auto expiry() -> std::string {
+    const auto next = std::time(nullptr) + 365 * 24 * 60 * 60;
+    char date[16];
+    std::strftime(date, sizeof(date), "%Y-%m-%d", std::localtime(&next));
+    return date;
+}
+
+// Time to spawn, and wait for the exit of, the given command, in microseconds
+auto run(const std::vector<char*> &argv) -> double {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+
+    const auto start = Clock::now();
+    pid_t pid = 0;
+    if (posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ) != 0) {
+        posix_spawn_file_actions_destroy(&actions);
+        return -1;
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    const auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    posix_spawn_file_actions_destroy(&actions);
+    return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? elapsed : -1;
+}
+
+} // anonymous
+
+auto main(int argc, char **argv) -> int {
+    std::string binary = (argc > 1) ? argv[1] : std::string(argv[0]);
+    if (argc <= 1) {
+        const auto slash = binary.rfind('/');
+        binary = ((slash == std::string::npos) ? std::string(".") : binary.substr(0, slash)) + "/bsm";
+    }
+
+    auto date = expiry();
+    std::string type = "-o", call = "call", underlying = "-u", spot = "100", strike = "-s", level = "95", time = "-t";
+    const std::vector<char*> command {
+        binary.data(), type.data(), call.data(), underlying.data(), spot.data(),
+        strike.data(), level.data(), time.data(), date.data(), nullptr
+    };
+
+    std::vector<double> times;
+    for (std::size_t i = 0; i < WARMUP + RUNS; ++i) {
+        const auto elapsed = run(command);
+        if (elapsed < 0) {
+            fmt::print("Failed to run {}\n", binary);
+            return 1;
+        }
+        if (i >= WARMUP) {
+            times.push_back(elapsed);
+        }
+    }
+
+    std::sort(times.begin(), times.end());
+    double total = 0;
+    for (const auto elapsed : times) {
+        total += elapsed;
+    }
+    const auto percentile = [&](double p) {
+        return times[std::min(times.size() - 1, static_cast<std::size_t>(p * static_cast<double>(times.size())))];
+    };
+
+    fmt::print("{} single contract runs of {}\n\n", RUNS, binary);
+    fmt::print("{:>10} {:>10} {:>10} {:>10} {:>10}\n", "min (us)", "p50 (us)", "p99 (us)", "max (us)", "mean (us)");
+    fmt::print("{:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}\n",
+               times.front(), percentile(0.5), percentile(0.99), times.back(), total / static_cast<double>(times.size()));
+    return 0;
+}
@@ -1,100 +1,315 @@
 #include "arg_parser.h"
 #include "constants.h"
 #include "helpers.h"
+#include "thread_pool.h"
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <fstream>
 
 namespace bsm
 {
 
+auto ArgParser::populateArgs(int argc, const char *const *argv) -> bool {
+    return populate(static_cast<std::size_t>(std::max(argc - 1, 0)), [argv](std::size_t i) {
+        return std::string_view(argv[i + 1]);
+    });
+}
+
 auto ArgParser::populateArgs(const Args &params) -> bool {
-    Args flags;
-    for (const auto &param : params) {
-        if (param.find_first_of('-') == 0) {
-            flags.push_back(param);
+    return populate(params.size(), [&params](std::size_t i) {
+        return std::string_view(params[i]);
+    });
+}
+
+// Run options are taken, with their values, wherever they appear. Of the remaining
+// parameters, which are the contract flags and their values, those starting with '-'
+// are counted as flags, of which there must be between the required and total number.
+template <typename Arg>
+auto ArgParser::populate(std::size_t count, Arg &&arg) -> bool {
+    std::size_t params = 0, flags = 0;
+    bool known = false;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto in = arg(i);
+        const auto *name = findFlag(in);
+        if (name != nullptr && name->kind_ == FlagKind::Run) {
+            if (i + 1 >= count) {
+                return false;
+            }
+            arguments_[flagIndex(name->flag_)] = arg(++i);
+            continue;
+        }
+
+        ++params;
+        if (!in.starts_with('-')) {
+            continue;
+        }
+        if (in == "-h" || in == "--help") {
+            return false;
+        }
+        ++flags;
+        if (name != nullptr) {
+            if (i + 1 >= count) {
+                return false;
+            }
+            arguments_[flagIndex(name->flag_)] = arg(i + 1);
+            known = true;
         }
     }
 
-    if (!validateFlags(flags)) {
-        return false;
+    if (params == 0) {
+        batch_ = !argument(Flag::Chain);
+        return batch_;
     }
+    const auto required = argument(Flag::Chain) ? NUM_CHAIN_FLAGS : NUM_BASE_FLAGS;
+    return known && flags >= required && flags <= NUM_ALL_FLAGS;
+}
 
-    for (size_t i = 0; i < params.size(); ++i) {
-        const auto &in = params[i];
-        if (std::find(in.cbegin(), in.cend(), '-') != in.end()) {
-            if (paramLookup.contains(in)) {
-                arguments_[paramLookup[in]] = params[i + 1];
-            }
-        }
+auto ArgParser::value(Flag flag) const -> std::string_view {
+    const auto &in = argument(flag);
+    if (!in) {
+        throw std::runtime_error("Missing required argument: " + std::string(FLAG_NAMES[flagIndex(flag)].long_));
     }
+    return in.value();
+}
 
-    return true;
+template <typename Number>
+auto ArgParser::number(Flag flag) const -> Number {
+    const auto in = value(flag);
+    Number number {};
+    const auto [end, error] = std::from_chars(in.data(), in.data() + in.size(), number);
+    if (error != std::errc() || end != in.data() + in.size()) {
+        throw std::runtime_error("Invalid number given for " + std::string(FLAG_NAMES[flagIndex(flag)].long_)
+                                 + ": " + std::string(in));
+    }
+    return number;
 }
 
 auto ArgParser::getOptionValues() -> OptionValues<ArgParser::value_type> {
-    const auto underlying = std::stod(arguments_[Flag::Underlying]);
-    const auto strike     = std::stod(arguments_[Flag::Strike]);
-    const auto expiry     = parseDate(arguments_[Flag::Expiry]);
-    const auto volatility = std::stod(arguments_[Flag::Volatility]);
-    const auto interest   = std::stod(arguments_[Flag::Interest]);
-    const auto yield      = std::stod(arguments_[Flag::Dividend]);
+    const auto underlying = number<value_type>(Flag::Underlying);
+    const auto strike     = number<value_type>(Flag::Strike);
+    const auto expiry     = parseDate(value(Flag::Expiry));
+    const auto volatility = argument(Flag::Volatility) ? number<value_type>(Flag::Volatility) : IMPLIED_VOL;
+    const auto interest   = argument(Flag::Interest)   ? number<value_type>(Flag::Interest)   : INTEREST;
+    const auto yield      = argument(Flag::Dividend)   ? number<value_type>(Flag::Dividend)   : YIELD;
 
     return OptionValues<value_type> { underlying, strike, expiry, volatility, interest, yield };
 }
 
 auto ArgParser::getOptionType() -> OptionType {
-    auto &input = arguments_[Flag::OptionType];
-    std::transform(input.begin(), input.end(), input.begin(), [](auto c) {
-            return std::tolower(c);
-    });
-    return (input.starts_with("c")) ? OptionType::Call : OptionType::Put;
+    const auto input = value(Flag::OptionType);
+    return (!input.empty() && std::tolower(static_cast<unsigned char>(input.front())) == 'c') ? OptionType::Call : OptionType::Put;
+}
+
+auto ArgParser::getOutputs() -> OutputMask {
+    if (!argument(Flag::Outputs)) {
+        return OutputMask::firstOrder();
+    }
+    return parseOutputs(value(Flag::Outputs));
 }
 
-auto ArgParser::validateFlags(const Args &flags) -> bool {
-    Args fullOpts = baseOpts;
-    for (const auto &opt : addOpts) {
-        fullOpts.push_back(opt);
+auto ArgParser::getThreads() -> size_t {
+    if (!argument(Flag::Threads)) {
+        return defaultThreads();
+    }
+    const auto threads = number<int>(Flag::Threads);
+    if (threads < 1) {
+        throw std::runtime_error("Number of threads must be at least one");
     }
+    return static_cast<size_t>(threads);
+}
 
-    const auto withinAll  = [&](std::string_view arg) {
-        return std::find(fullOpts.begin(), fullOpts.end(), arg) != fullOpts.end();
-    };
-    const auto withinHelp = [&](std::string_view arg) {
-        return (arg == "-h" || arg == "--help");
-    };
+auto ArgParser::getPlacement() -> Placement {
+    if (!argument(Flag::Affinity)) {
+        return Placement::None;
+    }
+    return parsePlacement(value(Flag::Affinity));
+}
 
-    const auto hasInterest = [&](std::string_view arg) {
-        return (arg == "-r" || arg == "--rate-of-interest");
-    };
-    const auto hasVolatility = [&](std::string_view arg) {
-        return (arg == "-v" || arg == "--volatility");
-    };
-    const auto hasDividend = [&](std::string_view arg) {
-        return (arg == "-d" || arg == "--dividend");
-    };
+auto ArgParser::getValidationTolerance() -> std::optional<value_type> {
+    if (!argument(Flag::Validate)) {
+        return std::nullopt;
+    }
+    const auto tolerance = number<value_type>(Flag::Validate);
+    if (tolerance <= 0) {
+        throw std::runtime_error("Greek validation tolerance must be greater than zero");
+    }
+    return tolerance;
+}
 
-    if (std::any_of(flags.begin(), flags.end(), withinHelp)) {
-        return false;
+auto ArgParser::getSurfaces() -> std::vector<VolSurface<value_type>> {
+    const auto path = getSurfacesFile();
+    if (!path) {
+        return {};
     }
+    std::ifstream file(path.value());
+    if (!file) {
+        throw std::runtime_error("Cannot open volatility surface file: " + path.value());
+    }
+    return readSurfaces<value_type>(file);
+}
 
-    if (flags.size() >= NUM_BASE_FLAGS && flags.size() <= NUM_ALL_FLAGS){
-        if (!std::any_of(flags.begin(), flags.end(), withinAll)) {
-            return false;
-        }
+auto ArgParser::getCurves() -> std::vector<DiscountCurve<value_type>> {
+    const auto path = getCurvesFile();
+    if (!path) {
+        return {};
+    }
+    std::ifstream file(path.value());
+    if (!file) {
+        throw std::runtime_error("Cannot open discount curve file: " + path.value());
+    }
+    return readCurves<value_type>(file);
+}
 
-        if (!std::any_of(flags.begin(), flags.end(), hasInterest)) {
-            arguments_[Flag::Interest] = std::to_string(INTEREST);
-        }
-        if (!std::any_of(flags.begin(), flags.end(), hasVolatility)) {
-            arguments_[Flag::Volatility] = std::to_string(IMPLIED_VOL);
-        }
-        if (!std::any_of(flags.begin(), flags.end(), hasDividend)) {
-            arguments_[Flag::Dividend]   = std::to_string(YIELD);
-        }
+auto ArgParser::getDividends() -> std::vector<DividendSchedule<value_type>> {
+    const auto path = getDividendsFile();
+    if (!path) {
+        return {};
     }
-    else {
-        return false;
+    std::ifstream file(path.value());
+    if (!file) {
+        throw std::runtime_error("Cannot open dividend file: " + path.value());
     }
+    return readDividends<value_type>(file);
+}
 
-    return true;
+auto ArgParser::getSurfacesFile() -> std::optional<std::string> {
+    if (!argument(Flag::Surfaces)) {
+        return std::nullopt;
+    }
+    return std::string(value(Flag::Surfaces));
+}
+
+auto ArgParser::getCurvesFile() -> std::optional<std::string> {
+    if (!argument(Flag::Curves)) {
+        return std::nullopt;
+    }
+    return std::string(value(Flag::Curves));
+}
+
+auto ArgParser::getDividendsFile() -> std::optional<std::string> {
+    if (!argument(Flag::Dividends)) {
+        return std::nullopt;
+    }
+    return std::string(value(Flag::Dividends));
+}
+
+auto ArgParser::getGrouping() -> std::optional<Grouping> {
+    if (!argument(Flag::Aggregate)) {
+        return std::nullopt;
+    }
+    return parseGrouping(value(Flag::Aggregate));
+}
+
+auto ArgParser::getInput() -> std::optional<std::string> {
+    if (!argument(Flag::Input)) {
+        return std::nullopt;
+    }
+    return std::string(value(Flag::Input));
+}
+
+auto ArgParser::getPageMode() -> PageMode {
+    if (!argument(Flag::HugePages)) {
+        return PageMode::None;
+    }
+    return parsePageMode(value(Flag::HugePages));
+}
+
+auto ArgParser::getCacheCapacity() -> std::optional<std::size_t> {
+    if (!argument(Flag::Cache)) {
+        return std::nullopt;
+    }
+    const auto capacity = number<long long>(Flag::Cache);
+    if (capacity < 1) {
+        throw std::runtime_error("Result cache capacity must be at least one");
+    }
+    return static_cast<std::size_t>(capacity);
+}
+
+auto ArgParser::getFormat() -> Format {
+    if (!argument(Flag::Format)) {
+        return Format::CSV;
+    }
+    return parseFormat(value(Flag::Format));
+}
+
+auto ArgParser::getCheckpoint() -> std::optional<std::string> {
+    if (!argument(Flag::Checkpoint)) {
+        return std::nullopt;
+    }
+    return std::string(value(Flag::Checkpoint));
+}
+
+auto ArgParser::getChunkLines() -> std::size_t {
+    if (!argument(Flag::ChunkLines)) {
+        return CHUNK_LINES;
+    }
+    const auto lines = number<long long>(Flag::ChunkLines);
+    if (lines < 1) {
+        throw std::runtime_error("Checkpoint chunks must be of at least one line");
+    }
+    return static_cast<std::size_t>(lines);
+}
+
+// Ladder of '--chain <from>:<to>:<step>' strikes, inclusive of both ends, over the underlying,
+// expiry, rate and yield of the contract flags. The volatility flag may give '@<surface_id>'
+// in place of a volatility, for the volatility of each strike on that surface.
+auto ArgParser::getChain() -> ChainLadder {
+    const auto spec = value(Flag::Chain);
+    std::array<value_type, 3> ladder {};
+    bool valid = true;
+    auto rest = spec;
+    for (std::size_t field = 0; field < ladder.size(); ++field) {
+        const auto pos = rest.find(':');
+        const auto text = rest.substr(0, pos);
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), ladder[field]);
+        const auto last = (field + 1 == ladder.size());
+        valid = valid && !text.empty() && error == std::errc() && end == text.data() + text.size()
+                && (last == (pos == std::string_view::npos));
+        rest.remove_prefix((pos == std::string_view::npos) ? rest.size() : pos + 1);
+    }
+    const auto [from, to, step] = ladder;
+    if (!valid || !(step > 0) || !(to >= from)) {
+        throw std::runtime_error("Invalid strike ladder given for --chain, expected <from>:<to>:<step>: " + std::string(spec));
+    }
+    // Strikes are stepped by index, rather than accumulated, so that the last is not lost to rounding
+    const auto steps = std::floor((to - from) / step + 1E-9);
+    if (steps >= static_cast<value_type>(MAX_CHAIN_STRIKES)) {
+        throw std::runtime_error("Strike ladder cannot be of more than " + std::to_string(MAX_CHAIN_STRIKES) + " strikes");
+    }
+    const auto strikes = static_cast<std::size_t>(steps) + 1;
+
+    ChainLadder chain;
+    chain.underlyingPrice_  = number<value_type>(Flag::Underlying);
+    chain.timeToExpiry_     = parseDate(value(Flag::Expiry));
+    chain.riskFreeInterest_ = argument(Flag::Interest) ? number<value_type>(Flag::Interest) : INTEREST;
+    chain.dividendYield_    = argument(Flag::Dividend) ? number<value_type>(Flag::Dividend) : YIELD;
+    chain.strikes_.resize(strikes);
+    for (std::size_t strike = 0; strike < strikes; ++strike) {
+        chain.strikes_[strike] = from + static_cast<value_type>(strike) * step;
+    }
+
+    if (!argument(Flag::Volatility) || !value(Flag::Volatility).starts_with('@')) {
+        chain.volatilities_ = { argument(Flag::Volatility) ? number<value_type>(Flag::Volatility) : IMPLIED_VOL };
+        return chain;
+    }
+    const auto id = value(Flag::Volatility).substr(1);
+    std::uint32_t surface = 0;
+    const auto [end, error] = std::from_chars(id.data(), id.data() + id.size(), surface);
+    if (error != std::errc() || end != id.data() + id.size()) {
+        throw std::runtime_error("Invalid volatility surface given for --volatility: " + std::string(id));
+    }
+    const auto surfaces = getSurfaces();
+    if (surface >= surfaces.size() || surfaces[surface].empty()) {
+        throw std::runtime_error("Cannot find volatility surface " + std::to_string(surface));
+    }
+    chain.volatilities_.resize(strikes);
+    for (std::size_t strike = 0; strike < strikes; ++strike) {
+        chain.volatilities_[strike] = surfaces[surface].volatility(chain.underlyingPrice_, chain.strikes_[strike],
+                                                                   chain.timeToExpiry_);
+    }
+    return chain;
 }
 
 } // bsm
@@ -1,10 +1,23 @@
+#include <cstdio>
 #include <cstdlib>
+#include <memory>
+#include <optional>
 #include <fmt/core.h>
 
+#include "aggregation.h"
 #include "arg_parser.h"
+#include "batch.h"
+#include "chain.h"
+#include "checkpoint.h"
+#include "compressed_reader.h"
 #include "constants.h"
+#include "finite_difference.h"
 #include "input_reader.h"
 #include "options.h"
+#include "output_writer.h"
+#include "outputs.h"
+#include "result_cache.h"
+#include "thread_pool.h"
 
 using namespace bsm;
 
@@ -19,6 +32,40 @@ void displayHelp() {
                 "\t-v | --volatility           : Implied volatility of underlying asset [optional]\n"
                 "\t-r | --rate-of-interest     : Risk Free interest rate [optional]\n\n"
                 "\t-d | --dividend-yield       : Dividend yield rate [optional]\n\n"
+                "\t--outputs                   : Comma separated outputs to derive, of: price, delta, gamma, "
+                "theta, vega, rho, vanna, volga, charm, speed, zomma, colour [optional]\n"
+                "\t--threads                   : Number of threads for parallel runs, defaults to all cores [optional]\n"
+                "\t--affinity                  : Placement of parallel run threads, of: none, nodes (pinned per NUMA node, "
+                "with chunks assigned per node), cores (pinned per CPU) [optional]\n"
+                "\t--validate-greeks           : Report greeks of standard input contracts which diverge from "
+                "bump and reprice greeks, by the given relative tolerance [optional]\n"
+                "\t--surfaces                  : CSV file of volatility surfaces, as rows of 'surface_id,expiry,moneyness,volatility'. "
+                "Standard input contracts may then give '@<surface_id>' in place of their volatility [optional]\n"
+                "\t--curves                    : CSV file of discount curves, as rows of 'curve_id,time,discount_factor'. "
+                "Standard input contracts may then give '@<curve_id>' in place of their interest rate [optional]\n"
+                "\t--dividends                 : CSV file of discrete cash dividends, as rows of 'underlying_id,time,amount[,rate]', "
+                "each underlying's discounted at its single rate, defaulting to 0.02. Their present value before expiry is "
+                "taken from the spot of standard input contracts of that underlying id [optional]\n"
+                "\t--aggregate                 : Comma separated keys, of: underlying, expiry, book (or all), by which "
+                "to net the quantity weighted outputs of standard input positions, rather than output each contract. "
+                "Contracts may be followed by quantity, underlying id and book id columns, of which those omitted default to 1, 0 and 0. Unreadable rows are an error [optional]\n"
+                "\t--input                     : CSV file of contracts, read whole, in place of standard input. Input files, "
+                "or standard input, may be gzip or zstd compressed [optional]\n"
+                "\t--huge-pages                : Backing of input and batch column buffers, of: none, transparent "
+                "(madvise), explicit (reserved huge pages, else transparent). Batches are then of 262144 rows, so that "
+                "their columns fill huge pages [optional]\n"
+                "\t--cache                     : Capacity of a cache of the outputs of contracts by their inputs, "
+                "so repeated contracts are priced once. Cache statistics are reported to standard error [optional]\n"
+                "\t--format                    : Format of batch input and contract output, of: csv, ndjson (one JSON "
+                "object per line, keyed by the CSV header names, output keyed by output name, echoing each request's "
+                "\"id\", else its \"line\" number, with an \"error\" for lines which are not contracts) [optional]\n"
+                "\t--checkpoint                : Directory to write the results of each chunk of input lines to, as a file "
+                "per chunk, with a manifest of the chunks completed. A rerun over the same input resumes after the last "
+                "chunk completed, if of the same valuation date, surfaces, curves and dividends [optional]\n"
+                "\t--chunk-lines               : Lines of input per checkpoint chunk, defaults to 1048576 [optional]\n"
+                "\t--chain                     : Ladder of strikes, as <from>:<to>:<step>, at each of which the call and put "
+                "of the given underlying price and expiry are priced, in place of the option type and strike. The volatility "
+                "may be given as '@<surface_id>', for the volatility of each strike on that surface [optional]\n\n"
                 "\t(-h | --help                : Display this help/usage message)\n"
                 "Optionally, if volatility, interest-rate, or dividend yield are omitted, the program will use "
                 "default assumptions for these values.\n");
@@ -30,49 +77,368 @@ void displayHelp() {
 }
 
 template <typename value_type = double>
-void optionRun(OptionType type, OptionValues<value_type> &&values, const bool multi) {
-    std::string_view delim = "\n";
-    if (multi) {
-        delim = " ";
-    }
+void optionRun(OptionType type, OptionValues<value_type> &&values, const OutputMask outputs) {
+    const auto run = [&](auto &&option, std::string_view label) {
+        if (outputs.contains(Output::Price)) {
+            fmt::print("{} Option Value: {:.2f}\n", label, option());
+        }
+        printGreeks(option);
+    };
 
     if (type == OptionType::Call) {
-        Option<CallExecutor> call(std::move(values));
-        fmt::print("Call Option Value: {:.2f}{}", call(), delim);
-        call.printGreeks(multi);
+        run(Option<CallExecutor>(std::move(values), outputs), "Call");
     }
     else if (type == OptionType::Put){
-        Option<PutExecutor> put(std::move(values));
-        fmt::print("Put Option Value: {:.2f}{}", put(), delim);
-        put.printGreeks(multi);
+        run(Option<PutExecutor>(std::move(values), outputs), "Put");
     }
 }
 
-auto main(int argc, char **argv) -> int {
-    ArgParser parser;
-    try {
-        fmt::print("Running black scholes merton\n");
-
-        if (argc < 2) {
-            InputReader reader(Format::CSV);
-            for (std::string stdin; std::getline(std::cin, stdin); ) {
-                if (!stdin.empty()) {
-                    auto [type, optionValues] = reader.getOptionValues(stdin);
-                    if (optionValues) {
-                        optionRun(type, std::move(optionValues.value()), true);
-                    }
+// Price the calls and puts of a ladder of strikes, across the pool only where the ladder
+// is of more than a chunk of strikes, as threads would otherwise only add to its latency
+void chainRun(ArgParser &parser, const OutputMask outputs) {
+    const auto ladder = parser.getChain();
+    const auto chain = ladder.chain();
+    std::optional<ThreadPool> pool;
+    if (chain.size() > CHUNK_SIZE && parser.getThreads() > 1) {
+        pool.emplace(parser.getThreads(), parser.getPlacement());
+    }
+
+    ChainResults<double> results;
+    priceChain(chain, results, outputs, pool ? &pool.value() : nullptr);
+    if (parser.getFormat() == Format::NDJSON) {
+        NdjsonChainWriter(outputs).write(chain, results);
+    }
+    else {
+        ChainWriter(outputs).write(chain, results);
+    }
+}
+
+// Lines of contracts, of the '--input' file, read whole into a buffer which may be
+// backed by huge pages, or else of standard input, read line by line. Either may be
+// gzip or zstd compressed, and is then decompressed on threads of its own.
+class Input
+{
+public:
+    Input(const std::optional<std::string> &path, std::size_t threads)
+        : file_(nullptr, &std::fclose)
+        , stdin_(stdin)
+    {
+        if (path) {
+            file_.reset(std::fopen(path->c_str(), "rb"));
+            if (!file_) {
+                throw std::runtime_error("Cannot open input file: " + path.value());
+            }
+        }
+        auto *file = file_ ? file_.get() : stdin;
+        const auto compression = detectCompression(file);
+        if (compression != Compression::None) {
+            compressed_.emplace(file, compression, threads);
+        }
+        else if (file_) {
+            buffer_.emplace(file);
+        }
+    }
+
+    auto next() -> std::optional<std::string_view> {
+        return compressed_ ? compressed_->next() : buffer_ ? buffer_->next() : stdin_.next();
+    }
+
+private:
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file_;
+    LineReader stdin_;
+    std::optional<BufferReader> buffer_;
+    std::optional<CompressedReader> compressed_;
+};
+
+// Rows of each batch, of as many under '--huge-pages' as back its columns of values,
+// and those of its results, with huge pages
+template <typename value_type = double>
+auto batchSize() -> std::size_t {
+    return (pageMode() == PageMode::None) ? BATCH_SIZE : HUGE_PAGE_BATCH_SIZE<value_type>;
+}
+
+// Read contracts from the input, processing each full batch in turn. The rows before
+// an invalid row are processed before its error is raised, as each row was once
+// written as it was read. Given requests, the request of each non-empty line, contract
+// or not, is added to them as read, for the process to answer with its batch.
+template <typename value_type = double, typename Process>
+void readBatches(Input &input, const Format format, Process &&process, const bool strict = false,
+                 std::vector<NdjsonRequest> *requests = nullptr) {
+    InputReader<value_type> reader(format, strict);
+    OptionBatch<value_type> batch;
+    const auto rows = batchSize<value_type>();
+    batch.reserve(rows);
+    const auto pending = [&] { return !batch.empty() || (requests && !requests->empty()); };
+
+    for (std::size_t number = 1; const auto line = input.next(); ++number) {
+        if (!line->empty()) {
+            try {
+                auto [type, optionValues, surface, curve, position] = reader.getOptionValues(*line);
+                if (optionValues) {
+                    batch.push(type, optionValues.value(), position.underlying_, surface, curve, position.quantity_,
+                               position.book_);
+                }
+                if (requests) {
+                    requests->push_back({ number, std::string(reader.requestId()), optionValues.has_value() });
                 }
             }
+            catch (...) {
+                if (pending()) {
+                    process(batch);
+                }
+                throw;
+            }
+        }
+        if (batch.size() == rows) {
+            process(batch);
+            batch.clear();
+        }
+    }
+    if (pending()) {
+        process(batch);
+    }
+}
+
+// Result cache of the '--cache' capacity, if any, reporting its statistics once the run ends
+template <typename value_type = double>
+class RunCache
+{
+public:
+    RunCache(const std::optional<std::size_t> capacity, const OutputMask outputs) {
+        if (capacity) {
+            cache_.emplace(capacity.value(), outputs);
+        }
+    }
+
+    RunCache(const RunCache &) = delete;
+    auto operator=(const RunCache &) -> RunCache& = delete;
+
+    ~RunCache() {
+        if (cache_) {
+            const auto stats = cache_->stats();
+            fmt::print(stderr, "Result cache: {} hits, {} misses, {} evictions, {} of {} entries, {:.1f}% hit rate\n",
+                       stats.hits_, stats.misses_, stats.evictions_, stats.size_, cache_->capacity(),
+                       100.0 * stats.hitRate());
+        }
+    }
+
+    auto get() -> ResultCache<value_type>* { return cache_ ? &cache_.value() : nullptr; }
+
+private:
+    std::optional<ResultCache<value_type>> cache_;
+};
+
+template <typename value_type = double>
+void batchRun(ThreadPool &pool, Input &input, const Format format, const OutputMask outputs,
+              const MarketData<value_type> &market, ResultCache<value_type> *cache) {
+    BatchResults<value_type> results;
+    ParallelPricer<value_type> pricer(pool, outputs, market, {}, cache);
+    OutputWriter<value_type> writer(outputs);
+    NdjsonWriter<value_type> ndjsonWriter(outputs);
+
+    std::vector<NdjsonRequest> requests;
+
+    readBatches<value_type>(input, format, [&](const OptionBatch<value_type> &batch) {
+        pricer(batch, results);
+        if (format == Format::NDJSON) {
+            ndjsonWriter.write(batch, results, requests);
+            requests.clear();
+        }
+        else {
+            writer.write(batch, results);
+        }
+    }, false, (format == Format::NDJSON) ? &requests : nullptr);
+}
+
+// Price the input in chunks of the checkpoint's lines, committing the results of each chunk
+// to a file of its own. Chunks committed by an earlier run are read through, unpriced, once
+// checked to be of the same lines. The first line is parsed in any case, as it may be the
+// CSV header by which the columns of every chunk are mapped.
+template <typename value_type = double>
+void checkpointRun(ThreadPool &pool, Input &input, const Format format, const OutputMask outputs,
+                   const MarketData<value_type> &market, ResultCache<value_type> *cache, Checkpoint &checkpoint) {
+    BatchResults<value_type> results;
+    ParallelPricer<value_type> pricer(pool, outputs, market, {}, cache);
+    OutputWriter<value_type> writer(outputs);
+    NdjsonWriter<value_type> ndjsonWriter(outputs);
+    InputReader<value_type> reader(format);
+    OptionBatch<value_type> batch;
+    std::vector<NdjsonRequest> requests; // of the lines of the batch, where NDJSON
+    const auto rows = batchSize<value_type>();
+    batch.reserve(rows);
+
+    std::size_t index = 0, resumed = 0;
+    Chunk chunk;
+    LineHash hash;
+    const Chunk *completed = nullptr;
+    Checkpoint::File file(nullptr, &std::fclose);
+
+    const auto process = [&] {
+        pricer(batch, results);
+        const auto formatted = (format == Format::NDJSON) ? ndjsonWriter.format(batch, results, requests) : writer.format(batch, results);
+        if (std::fwrite(formatted.data(), sizeof(char), formatted.size(), file.get()) != formatted.size()) {
+            throw std::runtime_error(fmt::format("Cannot write checkpoint chunk {}", index));
+        }
+        chunk.contracts_ += batch.size();
+        batch.clear();
+        requests.clear();
+    };
+
+    const auto endChunk = [&] {
+        if (completed) {
+            if (chunk.lines_ != completed->lines_ || hash.value() != completed->hash_) {
+                throw std::runtime_error(fmt::format("Input differs from that of checkpoint chunk {}", index));
+            }
+            ++resumed;
         }
         else {
-            const Args params { argv + 1, argv + argc };
-            if (!parser.populateArgs(params)) {
-                helpAndExit(EXIT_FAILURE);
+            if (!batch.empty() || !requests.empty()) {
+                process();
+            }
+            chunk.hash_ = hash.value();
+            checkpoint.commit(index, std::move(file), chunk);
+            file = Checkpoint::File(nullptr, &std::fclose);
+        }
+        ++index;
+        chunk = {};
+        hash = {};
+    };
+
+    for (std::size_t number = 1; const auto line = input.next(); ++number) {
+        const bool first = (number == 1);
+        if (chunk.lines_ == 0) {
+            completed = checkpoint.completed(index);
+            if (!completed) {
+                file = checkpoint.open(index);
             }
+        }
+        hash.add(*line);
+        ++chunk.lines_;
+
+        if ((!completed || first) && !line->empty()) {
+            auto [type, optionValues, surface, curve, position] = reader.getOptionValues(*line);
+            if (optionValues && !completed) {
+                batch.push(type, optionValues.value(), position.underlying_, surface, curve, position.quantity_, position.book_);
+            }
+            if (format == Format::NDJSON && !completed) {
+                requests.push_back({ number, std::string(reader.requestId()), optionValues.has_value() });
+            }
+        }
+        if (batch.size() == rows) {
+            process();
+        }
+        if (chunk.lines_ == checkpoint.chunkLines()) {
+            endChunk();
+        }
+    }
+    if (chunk.lines_ > 0) {
+        endChunk();
+    }
+    checkpoint.finish(index);
+
+    fmt::print(stderr, "Checkpoint: {} chunks, {} resumed, {} priced\n", index, resumed, index - resumed);
+}
+
+// Net the outputs of all positions by group, writing only the aggregated risk
+template <typename value_type = double>
+void aggregateRun(ThreadPool &pool, Input &input, const Format format, const OutputMask outputs, const Grouping grouping,
+                  const MarketData<value_type> &market, ResultCache<value_type> *cache) {
+    BatchResults<value_type> results;
+    ParallelPricer<value_type> pricer(pool, outputs, market, {}, cache);
+    Aggregator<value_type> aggregator(pool, outputs, grouping);
+
+    // Strictly read, as a skipped position would go missing from the totals unseen
+    readBatches<value_type>(input, format, [&](const OptionBatch<value_type> &batch) {
+        pricer(batch, results);
+        aggregator(batch, results);
+    }, true);
 
+    AggregateWriter(outputs).write(aggregator.totals());
+}
+
+// Report contracts whose analytic greeks diverge from bump and reprice greeks
+template <typename value_type = double>
+void validateRun(ThreadPool &pool, Input &input, const Format format, const value_type tolerance,
+                 const MarketData<value_type> &market) {
+    BatchPricer<value_type> pricer(OutputMask::firstOrder(), market);
+    FiniteDifference<value_type> numeric(pool, market);
+    BatchResults<value_type> analyticResults;
+    BatchResults<value_type> numericResults;
+    std::size_t contracts = 0, divergent = 0;
+
+    readBatches<value_type>(input, format, [&](const OptionBatch<value_type> &batch) {
+        pricer(batch, analyticResults);
+        numeric(batch, numericResults);
+
+        const auto divergences = FiniteDifference<value_type>::compare(analyticResults, numericResults, tolerance);
+        for (const auto &divergence : divergences) {
+            const auto label = (batch.type_[divergence.row_] == OptionType::Call) ? "Call" : "Put";
+            fmt::print("Row {} {} Option {}: analytic {:.5f}, numeric {:.5f}\n",
+                       contracts + divergence.row_, label, outputLabel(divergence.output_),
+                       divergence.analytic_, divergence.numeric_);
+        }
+        contracts += batch.size();
+        divergent += divergences.size();
+    });
+
+    fmt::print("Validated {} contracts, {} divergent greeks\n", contracts, divergent);
+}
+
+auto main(int argc, char **argv) -> int {
+    ArgParser parser;
+    try {
+        // NDJSON output is left unprefixed, so that it may be streamed as is
+        const auto populated = parser.populateArgs(argc, argv);
+        if (!populated || parser.getFormat() != Format::NDJSON) {
+            fmt::print("Running black scholes merton\n");
+        }
+        if (!populated) {
+            helpAndExit(EXIT_FAILURE);
+        }
+        const auto outputs = parser.getOutputs();
+
+        const auto tolerance = parser.getValidationTolerance();
+
+        if (parser.isBatchRun()) {
+            setPageMode(parser.getPageMode());
+            ThreadPool pool(parser.getThreads(), parser.getPlacement());
+            Input input(parser.getInput(), pool.size());
+            const auto format = parser.getFormat();
+            const auto grouping = parser.getGrouping();
+            RunCache cache(parser.getCacheCapacity(), outputs);
+            const auto checkpoint = parser.getCheckpoint();
+            if (checkpoint && (tolerance || grouping)) {
+                throw std::runtime_error("Checkpoints apply only to runs writing each contract, "
+                                         "not to --validate-greeks or --aggregate runs");
+            }
+            // Market data of the run, referenced by each of its pricers
+            const auto dividends = parser.getDividends();
+            const auto surfaces = parser.getSurfaces();
+            const auto curves = parser.getCurves();
+            const MarketData<> market { dividends, surfaces, curves };
+            if (checkpoint) {
+                Checkpoint chunks(checkpoint.value(), parser.getChunkLines(), format, outputs,
+                                  RunInputs { valuationDate(), parser.getSurfacesFile(), parser.getCurvesFile(),
+                                              parser.getDividendsFile() });
+                checkpointRun(pool, input, format, outputs, market, cache.get(), chunks);
+            }
+            else if (tolerance) {
+                validateRun(pool, input, format, tolerance.value(), market);
+            }
+            else if (grouping) {
+                aggregateRun(pool, input, format, outputs, grouping.value(), market, cache.get());
+            }
+            else {
+                batchRun(pool, input, format, outputs, market, cache.get());
+            }
+        }
+        else if (parser.isChainRun()) {
+            chainRun(parser, outputs);
+        }
+        else {
             auto optionValues = parser.getOptionValues();
             const auto type = parser.getOptionType();
-            optionRun(type, std::move(optionValues), false);
+            optionRun(type, std::move(optionValues), outputs);
         }
     }
     catch (const std::exception &e) {
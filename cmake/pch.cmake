@@ -8,7 +8,6 @@ target_precompile_headers(
 
 target_precompile_headers(
     bsm PRIVATE
-    <iostream>
     <functional>
     <unordered_map>
     <vector>
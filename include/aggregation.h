@@ -0,0 +1,198 @@
+#ifndef AGGREGATION_H
+#define AGGREGATION_H
+
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "batch.h"
+#include "outputs.h"
+#include "reduction.h"
+#include "thread_pool.h"
+
+namespace bsm
+{
+
+// Key of a group collapsed across all of its values, e.g. every book
+static constexpr const std::uint32_t ALL_KEYS = std::numeric_limits<std::uint32_t>::max();
+
+// Upper bound of each expiry bucket, in years, and its label
+static constexpr const double EXPIRY_BUCKETS[] { 1.0 / 12, 0.25, 0.5, 1, 2, 5, 10 };
+static constexpr const std::string_view EXPIRY_BUCKET_LABELS[] { "1M", "3M", "6M", "1Y", "2Y", "5Y", "10Y" };
+static constexpr const auto NUM_EXPIRY_BUCKETS = std::size(EXPIRY_BUCKETS);
+
+// Index of the bucket of the given time to expiry. Times to expiry are validated
+// to at most ten years, so always fall within the last bucket.
+template <typename value_type>
+constexpr auto expiryBucket(const value_type time) -> std::uint32_t {
+    const auto bucket = std::lower_bound(std::begin(EXPIRY_BUCKETS), std::end(EXPIRY_BUCKETS), static_cast<double>(time));
+    return static_cast<std::uint32_t>(std::min<std::size_t>(bucket - std::begin(EXPIRY_BUCKETS), NUM_EXPIRY_BUCKETS - 1));
+}
+
+// Keys by which positions are grouped, as selected by '--aggregate'.
+// Keys not selected are collapsed, so aggregate across all of their values.
+struct Grouping
+{
+    bool underlying_ = true;
+    bool expiry_ = true;
+    bool book_ = true;
+};
+
+// Parse a comma separated list of grouping keys, e.g. 'underlying,book'
+inline auto parseGrouping(std::string_view list) -> Grouping {
+    Grouping grouping { false, false, false };
+    while (!list.empty()) {
+        const auto pos = list.find(',');
+        const auto name = list.substr(0, pos);
+        if (name == "underlying") {
+            grouping.underlying_ = true;
+        }
+        else if (name == "expiry") {
+            grouping.expiry_ = true;
+        }
+        else if (name == "book") {
+            grouping.book_ = true;
+        }
+        else if (name != "all") {
+            throw std::runtime_error("Unknown aggregation key requested: " + std::string(name));
+        }
+        list.remove_prefix((pos == std::string_view::npos) ? list.size() : pos + 1);
+    }
+    return grouping;
+}
+
+struct RiskKey
+{
+    std::uint32_t underlying_ = ALL_KEYS;
+    std::uint32_t expiry_ = ALL_KEYS; // expiry bucket
+    std::uint32_t book_ = ALL_KEYS;
+
+    auto operator<=>(const RiskKey &rhs) const = default;
+};
+
+// Position weighted sums of the selected outputs of a group of contracts.
+// Sums are compensated, in double precision, regardless of the pricing precision.
+class Risk
+{
+public:
+    void add(double quantity, Output output, double value) {
+        sums_[static_cast<std::size_t>(output)] += quantity * value;
+    }
+
+    void addPosition(double quantity) {
+        ++positions_;
+        quantity_ += quantity;
+    }
+
+    void merge(const Risk &rhs) {
+        positions_ += rhs.positions_;
+        quantity_ += rhs.quantity_;
+        for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+            sums_[output] += rhs.sums_[output];
+        }
+    }
+
+    auto positions() const -> std::size_t { return positions_; }
+    auto quantity() const -> double { return quantity_.value(); }
+    auto operator[](Output output) const -> double { return sums_[static_cast<std::size_t>(output)].value(); }
+
+private:
+    std::size_t positions_ = 0;
+    CompensatedSum quantity_;
+    std::array<CompensatedSum, NUM_OUTPUTS> sums_ {};
+};
+
+// Aggregates the priced outputs of batches, weighted by each row's quantity, into
+// the net risk of each group of positions. Each fixed size chunk of a batch is
+// reduced in parallel to its own partial sums, in row order, and the partials are
+// then merged in chunk order, and batches in input order, so totals are identical
+// bit for bit regardless of thread count or scheduling.
+template <typename value_type = double>
+class Aggregator
+{
+public:
+    Aggregator() = delete;
+    explicit Aggregator(ThreadPool &pool, const OutputMask outputs, const Grouping grouping = {})
+        : pool_(pool)
+        , outputs_(outputs)
+        , grouping_(grouping)
+    {}
+
+    void operator()(const OptionBatch<value_type> &batch, const BatchResults<value_type> &results) {
+        if (results.size() != batch.size()) {
+            throw std::runtime_error("Cannot aggregate results of a different batch");
+        }
+        partials_.resize((batch.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        pool_.parallelFor(batch.size(), CHUNK_SIZE, [&](std::size_t begin, std::size_t end) {
+            reduce(batch, results, begin, end, partials_[begin / CHUNK_SIZE]);
+        });
+
+        for (const auto &partial : partials_) {
+            for (const auto &[key, risk] : partial) {
+                totals_[key].merge(risk);
+            }
+        }
+    }
+
+    auto key(const OptionBatch<value_type> &batch, std::size_t row) const -> RiskKey {
+        return {
+            grouping_.underlying_ ? batch.underlying_[row] : ALL_KEYS,
+            grouping_.expiry_ ? expiryBucket(batch.timeToExpiry_[row]) : ALL_KEYS,
+            grouping_.book_ ? batch.book_[row] : ALL_KEYS,
+        };
+    }
+
+    // Net risk of each group, ordered by key
+    auto totals() const -> const std::map<RiskKey, Risk>& { return totals_; }
+    auto outputs() const -> OutputMask { return outputs_; }
+
+    void clear() { totals_.clear(); }
+
+private:
+    using Partial = std::vector<std::pair<RiskKey, Risk>>;
+
+    // Reduce rows [begin, end) to partial sums per key, ordered by key
+    void reduce(const OptionBatch<value_type> &batch, const BatchResults<value_type> &results,
+                std::size_t begin, std::size_t end, Partial &partial) const {
+        thread_local std::vector<std::pair<RiskKey, std::size_t>> rows;
+        rows.clear();
+        for (auto row = begin; row < end; ++row) {
+            rows.emplace_back(key(batch, row), row);
+        }
+        std::sort(rows.begin(), rows.end());
+
+        partial.clear();
+        for (const auto &[key, row] : rows) {
+            if (partial.empty() || partial.back().first != key) {
+                partial.emplace_back(key, Risk {});
+            }
+            auto &risk = partial.back().second;
+            const double quantity = batch.quantity_[row];
+            risk.addPosition(quantity);
+            for (std::size_t index = 0; index < NUM_OUTPUTS; ++index) {
+                const auto output = static_cast<Output>(index);
+                if (outputs_.contains(output)) {
+                    risk.add(quantity, output, results.column(output)[row]);
+                }
+            }
+        }
+    }
+
+    ThreadPool &pool_;
+    OutputMask outputs_;
+    Grouping grouping_;
+    std::vector<Partial> partials_;     // by chunk of the current batch
+    std::map<RiskKey, Risk> totals_;
+};
+
+} // bsm
+
+#endif
@@ -0,0 +1,356 @@
+#ifndef AMERICAN_H
+#define AMERICAN_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "black_scholes.h"
+#include "constants.h"
+
+namespace bsm
+{
+
+// fwd declare option value type
+template<typename value_type>
+struct OptionValues;
+
+static constexpr const std::size_t CRITICAL_PRICE_ITERATIONS = 100;
+static constexpr const auto CRITICAL_PRICE_TOLERANCE = 1E-8;
+
+// Barone-Adesi & Whaley (1987) quadratic approximation of American option values.
+// The early exercise premium is added to the Black Scholes value, once the critical
+// underlying price, above (or below) which the option is exercised, is found by
+// Newton iteration. Exposes the same call and put valuations as BlackScholes, so
+// may be used as the pricing model of an Option or BatchPricer.
+template <typename value_type = double>
+class BaroneAdesiWhaley
+{
+public:
+    BaroneAdesiWhaley() = default;
+
+    auto operator==(const BaroneAdesiWhaley &) const -> bool = default;
+
+    auto callOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        // Never optimal to exercise a call early without a dividend yield
+        if (values.dividendYield_ <= 0) {
+            return bsm_.callOptionValue(values);
+        }
+
+        const auto q2 = exponent(values, multiplier(values), 1);
+        const auto critical = criticalPrice<true>(values, q2);
+        if (values.underlyingPrice_ >= critical) {
+            return values.underlyingPrice_ - values.strikePrice_;
+        }
+
+        const auto premium = (critical / q2) * (1 - (values.dividendDiscount_ * bsm_.cumulNormalDist(bsm_.d1(values, critical))));
+        return bsm_.callOptionValue(values) + (premium * std::pow(values.underlyingPrice_ / critical, q2));
+    }
+
+    auto putOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        // Never optimal to exercise a put early without a risk free interest rate
+        if (values.riskFreeInterest_ <= 0) {
+            return bsm_.putOptionValue(values);
+        }
+
+        const auto q1 = exponent(values, multiplier(values), -1);
+        const auto critical = criticalPrice<false>(values, q1);
+        if (values.underlyingPrice_ <= critical) {
+            return values.strikePrice_ - values.underlyingPrice_;
+        }
+
+        const auto premium = -(critical / q1) * (1 - (values.dividendDiscount_ * bsm_.cumulNormalDist(-bsm_.d1(values, critical))));
+        return bsm_.putOptionValue(values) + (premium * std::pow(values.underlyingPrice_ / critical, q1));
+    }
+
+private:
+    // Ratio of 2r/σ² to the interest discounted over time to expiry,
+    // tending to 2/σ²T as the risk free interest rate tends to zero
+    static auto multiplier(const OptionValues<value_type> &values) -> value_type {
+        const auto variance = values.volatility_ * values.volatility_;
+        if (values.riskFreeInterest_ <= 0) {
+            return 2 / (variance * values.timeToExpiry_);
+        }
+        return (2 * values.riskFreeInterest_ / variance) / (1 - values.interestDiscount_);
+    }
+
+    // Exponent of the early exercise premium, positive (q2) for calls, negative (q1) for puts
+    static auto exponent(const OptionValues<value_type> &values, const value_type multiplier, const int sign) -> value_type {
+        const auto carry = 2 * (values.riskFreeInterest_ - values.dividendYield_) / (values.volatility_ * values.volatility_);
+        const auto drift = carry - 1;
+        return (-drift + (sign * std::sqrt((drift * drift) + (4 * multiplier)))) / 2;
+    }
+
+    // Critical underlying price at which early exercise becomes optimal, seeded as
+    // per Barone-Adesi & Whaley from the perpetual boundary, and refined by Newton
+    template <bool call>
+    auto criticalPrice(const OptionValues<value_type> &values, const value_type q) const -> value_type {
+        const auto strike = values.strikePrice_;
+        const auto carry = values.riskFreeInterest_ - values.dividendYield_;
+        const auto volTime = values.volatility_ * values.sqrtime_;
+        const auto perpetual = strike / (1 - (1 / exponent(values, 2 * values.riskFreeInterest_ / (values.volatility_ * values.volatility_), call ? 1 : -1)));
+
+        auto critical = value_type{0};
+        if constexpr (call) {
+            const auto h2 = -((carry * values.timeToExpiry_) + (2 * volTime)) * strike / (perpetual - strike);
+            critical = strike + ((perpetual - strike) * (1 - std::exp(h2)));
+        }
+        else {
+            const auto h1 = ((carry * values.timeToExpiry_) - (2 * volTime)) * strike / (strike - perpetual);
+            critical = perpetual + ((strike - perpetual) * std::exp(h1));
+        }
+
+        for (std::size_t iteration = 0; iteration < CRITICAL_PRICE_ITERATIONS; ++iteration) {
+            const auto dOne = bsm_.d1(values, critical);
+            const auto density = std::exp(-dOne * dOne / 2) / std::sqrt(2 * M_PI);
+
+            if constexpr (call) {
+                const auto exercised = values.dividendDiscount_ * bsm_.cumulNormalDist(dOne);
+                const auto lhs = critical - strike;
+                const auto rhs = bsm_.callOptionValue(values, critical) + ((1 - exercised) * critical / q);
+                if (std::fabs(lhs - rhs) / strike < CRITICAL_PRICE_TOLERANCE) {
+                    break;
+                }
+                const auto slope = (exercised * (1 - (1 / q))) + ((1 - (values.dividendDiscount_ * density / volTime)) / q);
+                critical = (strike + rhs - (slope * critical)) / (1 - slope);
+            }
+            else {
+                const auto expires = values.dividendDiscount_ * bsm_.cumulNormalDist(-dOne);
+                const auto lhs = strike - critical;
+                const auto rhs = bsm_.putOptionValue(values, critical) - ((1 - expires) * critical / q);
+                if (std::fabs(lhs - rhs) / strike < CRITICAL_PRICE_TOLERANCE) {
+                    break;
+                }
+                const auto slope = (-expires * (1 - (1 / q))) - ((1 + (values.dividendDiscount_ * density / volTime)) / q);
+                critical = (strike - rhs + (slope * critical)) / (1 + slope);
+            }
+        }
+        return critical;
+    }
+
+    BlackScholes<value_type> bsm_;
+};
+
+// Bjerksund & Stensland (2002) approximation of American option values, by a two step
+// flat early exercise boundary. Puts are valued as calls by the put-call transformation
+// P(S, X, T, r, b, σ) = C(X, S, T, r - b, -b, σ), where b is the cost of carry.
+// Exposes the same call and put valuations as BlackScholes, so may be used as the
+// pricing model of an Option or BatchPricer.
+template <typename value_type = double>
+class BjerksundStensland
+{
+public:
+    BjerksundStensland() = default;
+
+    auto operator==(const BjerksundStensland &) const -> bool = default;
+
+    auto callOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        const auto carry = values.riskFreeInterest_ - values.dividendYield_;
+        if (carry >= values.riskFreeInterest_) {
+            return bsm_.callOptionValue(values);
+        }
+        return americanCall({ values.underlyingPrice_, values.strikePrice_, values.timeToExpiry_,
+                              values.riskFreeInterest_, carry, values.volatility_ });
+    }
+
+    auto putOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        if (values.riskFreeInterest_ <= 0) {
+            return bsm_.putOptionValue(values);
+        }
+        const auto carry = values.riskFreeInterest_ - values.dividendYield_;
+        return americanCall({ values.strikePrice_, values.underlyingPrice_, values.timeToExpiry_,
+                              values.riskFreeInterest_ - carry, -carry, values.volatility_ });
+    }
+
+    // Cumulative bivariate normal distribution, P(X < a, Y < b) for correlation rho,
+    // by Genz (2004) Gauss-Legendre quadrature, to double precision
+    auto cumulBivariateNormalDist(const value_type a, const value_type b, const value_type rho) const -> double {
+        return upperBivariateNormal(-a, -b, rho);
+    }
+
+private:
+    // Generalised inputs of an American call, with cost of carry b in place of the
+    // dividend yield, to which puts are transformed
+    struct Inputs
+    {
+        value_type spot_;
+        value_type strike_;
+        value_type time_;
+        value_type rate_;
+        value_type carry_;
+        value_type volatility_;
+    };
+
+    auto americanCall(const Inputs &in) const -> value_type {
+        const auto spot = in.spot_;
+        const auto strike = in.strike_;
+        const auto variance = in.volatility_ * in.volatility_;
+        const auto split = static_cast<value_type>(0.5) * (std::sqrt(static_cast<value_type>(5)) - 1) * in.time_;
+
+        const auto drift = (in.carry_ / variance) - static_cast<value_type>(0.5);
+        const auto beta = -drift + std::sqrt((drift * drift) + (2 * in.rate_ / variance));
+        const auto perpetual = beta / (beta - 1) * strike;
+        const auto floor = std::max(strike, in.rate_ / (in.rate_ - in.carry_) * strike);
+
+        const auto boundary = [&](value_type time) {
+            const auto h = -((in.carry_ * time) + (2 * in.volatility_ * std::sqrt(time))) * strike * strike / ((perpetual - floor) * floor);
+            return floor + ((perpetual - floor) * (1 - std::exp(h)));
+        };
+        const auto i1 = boundary(split);
+        const auto i2 = boundary(in.time_);
+
+        if (spot >= i2) {
+            return spot - strike;
+        }
+
+        const auto a1 = (i1 - strike) * std::pow(i1, -beta);
+        const auto a2 = (i2 - strike) * std::pow(i2, -beta);
+
+        const auto phiTerm = [&](value_type gamma, value_type h, value_type i) {
+            return this->phi(in, split, gamma, h, i);
+        };
+        const auto psiTerm = [&](value_type gamma, value_type h) {
+            return this->psi(in, split, gamma, h, i2, i1);
+        };
+
+        return (a2 * std::pow(spot, beta)) - (a2 * phiTerm(beta, i2, i2))
+            + phiTerm(1, i2, i2) - phiTerm(1, i1, i2)
+            - (strike * phiTerm(0, i2, i2)) + (strike * phiTerm(0, i1, i2))
+            + (a1 * phiTerm(beta, i1, i2)) - (a1 * psiTerm(beta, i1))
+            + psiTerm(1, i1) - psiTerm(1, strike)
+            - (strike * psiTerm(0, i1)) + (strike * psiTerm(0, strike));
+    }
+
+    auto phi(const Inputs &in, const value_type time, const value_type gamma,
+             const value_type h, const value_type i) const -> value_type {
+        const auto variance = in.volatility_ * in.volatility_;
+        const auto volTime = in.volatility_ * std::sqrt(time);
+        const auto lambda = (-in.rate_ + (gamma * in.carry_) + (static_cast<value_type>(0.5) * gamma * (gamma - 1) * variance)) * time;
+        const auto d = -(std::log(in.spot_ / h) + ((in.carry_ + ((gamma - static_cast<value_type>(0.5)) * variance)) * time)) / volTime;
+        const auto kappa = (2 * in.carry_ / variance) + ((2 * gamma) - 1);
+        return std::exp(lambda) * std::pow(in.spot_, gamma)
+            * (bsm_.cumulNormalDist(d) - (std::pow(i / in.spot_, kappa) * bsm_.cumulNormalDist(d - (2 * std::log(i / in.spot_) / volTime))));
+    }
+
+    auto psi(const Inputs &in, const value_type split, const value_type gamma,
+             const value_type h, const value_type i2, const value_type i1) const -> value_type {
+        const auto spot = in.spot_;
+        const auto variance = in.volatility_ * in.volatility_;
+        const auto drift = in.carry_ + ((gamma - static_cast<value_type>(0.5)) * variance);
+        const auto volSplit = in.volatility_ * std::sqrt(split);
+        const auto volTime = in.volatility_ * std::sqrt(in.time_);
+
+        const auto e1 = (std::log(spot / i1) + (drift * split)) / volSplit;
+        const auto e2 = (std::log(i2 * i2 / (spot * i1)) + (drift * split)) / volSplit;
+        const auto e3 = (std::log(spot / i1) - (drift * split)) / volSplit;
+        const auto e4 = (std::log(i2 * i2 / (spot * i1)) - (drift * split)) / volSplit;
+
+        const auto f1 = (std::log(spot / h) + (drift * in.time_)) / volTime;
+        const auto f2 = (std::log(i2 * i2 / (spot * h)) + (drift * in.time_)) / volTime;
+        const auto f3 = (std::log(i1 * i1 / (spot * h)) + (drift * in.time_)) / volTime;
+        const auto f4 = (std::log(spot * i1 * i1 / (h * i2 * i2)) + (drift * in.time_)) / volTime;
+
+        const auto rho = std::sqrt(split / in.time_);
+        const auto lambda = -in.rate_ + (gamma * in.carry_) + (static_cast<value_type>(0.5) * gamma * (gamma - 1) * variance);
+        const auto kappa = (2 * in.carry_ / variance) + ((2 * gamma) - 1);
+
+        return std::exp(lambda * in.time_) * std::pow(spot, gamma)
+            * (cumulBivariateNormalDist(-e1, -f1, rho)
+               - (std::pow(i2 / spot, kappa) * cumulBivariateNormalDist(-e2, -f2, rho))
+               - (std::pow(i1 / spot, kappa) * cumulBivariateNormalDist(-e3, -f3, -rho))
+               + (std::pow(i1 / i2, kappa) * cumulBivariateNormalDist(-e4, -f4, -rho)));
+    }
+
+    // Gauss-Legendre abscissae and weights, over half of [-1, 1], of increasing order
+    // for increasing correlation
+    static constexpr const double LOW_WEIGHTS[3] { 0.1713244923791705, 0.3607615730481386, 0.4679139345726913 };
+    static constexpr const double LOW_NODES[3]   { -0.9324695142031521, -0.6612093864662646, -0.2386191860831969 };
+    static constexpr const double MID_WEIGHTS[6] {
+        0.04717533638651183, 0.1069393259953182, 0.1600783285433463,
+        0.2031674267230658, 0.2334925365383548, 0.2491470458134029
+    };
+    static constexpr const double MID_NODES[6] {
+        -0.9815606342467192, -0.9041172563704748, -0.7699026741943047,
+        -0.5873179542866175, -0.3678314989981802, -0.1252334085114689
+    };
+    static constexpr const double HIGH_WEIGHTS[10] {
+        0.01761400713915226, 0.04060142980038705, 0.06267204833410904, 0.08327674157670474, 0.1019301198172405,
+        0.1181945319615183, 0.1316886384491765, 0.1420961093183822, 0.1491729864726038, 0.152753387130726
+    };
+    static constexpr const double HIGH_NODES[10] {
+        -0.9931285991850949, -0.9639719272779138, -0.9122344282513259, -0.8391169718222189, -0.7463319064601508,
+        -0.636053680726515, -0.5108670019508271, -0.3737060887154195, -0.2277858511416451, -0.07652652113349734
+    };
+
+    // P(X > h, Y > k), as given by Genz's BVND
+    auto upperBivariateNormal(double h, double k, const double r) const -> double {
+        const double *weights = LOW_WEIGHTS;
+        const double *nodes = LOW_NODES;
+        std::size_t count = 3;
+        if (std::fabs(r) >= 0.75) {
+            weights = HIGH_WEIGHTS;
+            nodes = HIGH_NODES;
+            count = 10;
+        }
+        else if (std::fabs(r) >= 0.3) {
+            weights = MID_WEIGHTS;
+            nodes = MID_NODES;
+            count = 6;
+        }
+
+        const auto normal = [](double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+        auto hk = h * k;
+        auto bvn = 0.0;
+
+        if (std::fabs(r) < 0.925) {
+            const auto hs = ((h * h) + (k * k)) / 2;
+            const auto asr = std::asin(r);
+            for (std::size_t i = 0; i < count; ++i) {
+                for (const auto sign : { 1.0, -1.0 }) {
+                    const auto sn = std::sin(asr * ((sign * nodes[i]) + 1) / 2);
+                    bvn += weights[i] * std::exp(((sn * hk) - hs) / (1 - (sn * sn)));
+                }
+            }
+            return (bvn * asr / (4 * M_PI)) + (normal(-h) * normal(-k));
+        }
+
+        if (r < 0) {
+            k = -k;
+            hk = -hk;
+        }
+        if (std::fabs(r) < 1) {
+            const auto as = (1 - r) * (1 + r);
+            auto a = std::sqrt(as);
+            const auto bs = (h - k) * (h - k);
+            const auto c = (4 - hk) / 8;
+            const auto d = (12 - hk) / 16;
+            bvn = a * std::exp(-((bs / as) + hk) / 2) * (1 - (c * (bs - as) * (1 - (d * bs / 5)) / 3) + (c * d * as * as / 5));
+            if (hk > -160) {
+                const auto b = std::sqrt(bs);
+                bvn -= std::exp(-hk / 2) * std::sqrt(2 * M_PI) * normal(-b / a) * b * (1 - (c * bs * (1 - (d * bs / 5)) / 3));
+            }
+            a /= 2;
+            for (std::size_t i = 0; i < count; ++i) {
+                for (const auto sign : { -1.0, 1.0 }) {
+                    const auto xs = std::pow(a * ((sign * nodes[i]) + 1), 2);
+                    const auto rs = std::sqrt(1 - xs);
+                    const auto asr = -((bs / xs) + hk) / 2;
+                    if (asr > -100) {
+                        bvn += a * weights[i] * std::exp(asr) * ((std::exp(-hk * (1 - rs) / (2 * (1 + rs))) / rs) - (1 + (c * xs * (1 + (d * xs)))));
+                    }
+                }
+            }
+            bvn = -bvn / (2 * M_PI);
+        }
+        if (r > 0) {
+            return bvn + normal(-std::max(h, k));
+        }
+        return -bvn + std::max(0.0, normal(-h) - normal(-k));
+    }
+
+    BlackScholes<value_type> bsm_;
+};
+
+} // bsm
+
+#endif
@@ -1,12 +1,27 @@
 #ifndef ARG_PARSER_H
 #define ARG_PARSER_H
 
-#include <functional>
-#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "constants.h"
 #include "options.h"
+#include "outputs.h"
+#include "aggregation.h"
+#include "chain.h"
+#include "checkpoint.h"
+#include "discount_curve.h"
+#include "dividends.h"
+#include "huge_pages.h"
+#include "input_reader.h"
+#include "thread_pool.h"
+#include "vol_surface.h"
 
 namespace bsm
 {
@@ -19,54 +34,171 @@ enum class Flag : char {
     Volatility = 'v',
     Interest   = 'r',
     Dividend   = 'd',
+
+    // Run options, applying to both direct and batch runs
+    Outputs    = 'O',
+    Threads    = 'T',
+    Validate   = 'V',
+    Surfaces   = 'S',
+    Curves     = 'C',
+    Dividends  = 'D',
+    Aggregate  = 'A',
+    Affinity   = 'P',
+    Input      = 'I',
+    HugePages  = 'H',
+    Cache      = 'K',
+    Format     = 'F',
+    Checkpoint = 'R',
+    ChunkLines = 'L',
+    Chain      = 'N',
 };
 
-using Args         = std::vector<std::string>;
-using ArgLookup    = std::unordered_map<std::string, Flag>;
-using Parser       = std::function<void(std::string_view)>;
-using ParserLookup = std::unordered_map<Flag, Parser>;
-using OptionMap    = std::unordered_map<Flag, std::string>;
-using ArgKeys      = std::vector<Flag>;
+using Args = std::vector<std::string>;
+
+enum class FlagKind : std::uint8_t {
+    Required,   // contract flags, required for a direct run
+    Optional,   // contract flags, defaulted where omitted
+    Run,        // run options, which always take a value
+};
 
-static const Args baseOpts {
-    "-o", "-u", "-s", "-t",
-    "--option-type", "--underlying-price", "--strike-price", "--time-to-expiry"
+struct FlagName
+{
+    std::string_view short_;
+    std::string_view long_;
+    Flag flag_;
+    FlagKind kind_;
 };
 
-static const Args addOpts {
-    "-v", "-r", "-d",
-    "--volatility", "--rate-of-interest", "--dividend"
+// All flags, by name. Run options have only long names.
+static constexpr const FlagName FLAG_NAMES[] {
+    { "-o", "--option-type",      Flag::OptionType, FlagKind::Required },
+    { "-u", "--underlying-price", Flag::Underlying, FlagKind::Required },
+    { "-s", "--strike-price",     Flag::Strike,     FlagKind::Required },
+    { "-t", "--time-to-expiry",   Flag::Expiry,     FlagKind::Required },
+    { "-v", "--volatility",       Flag::Volatility, FlagKind::Optional },
+    { "-r", "--rate-of-interest", Flag::Interest,   FlagKind::Optional },
+    { "-d", "--dividend",         Flag::Dividend,   FlagKind::Optional },
+    { "",   "--outputs",          Flag::Outputs,    FlagKind::Run },
+    { "",   "--threads",          Flag::Threads,    FlagKind::Run },
+    { "",   "--validate-greeks",  Flag::Validate,   FlagKind::Run },
+    { "",   "--surfaces",         Flag::Surfaces,   FlagKind::Run },
+    { "",   "--curves",           Flag::Curves,     FlagKind::Run },
+    { "",   "--dividends",        Flag::Dividends,  FlagKind::Run },
+    { "",   "--aggregate",        Flag::Aggregate,  FlagKind::Run },
+    { "",   "--affinity",         Flag::Affinity,   FlagKind::Run },
+    { "",   "--input",            Flag::Input,      FlagKind::Run },
+    { "",   "--huge-pages",       Flag::HugePages,  FlagKind::Run },
+    { "",   "--cache",            Flag::Cache,      FlagKind::Run },
+    { "",   "--format",           Flag::Format,     FlagKind::Run },
+    { "",   "--checkpoint",       Flag::Checkpoint, FlagKind::Run },
+    { "",   "--chunk-lines",      Flag::ChunkLines, FlagKind::Run },
+    { "",   "--chain",            Flag::Chain,      FlagKind::Run },
 };
 
-static ArgLookup paramLookup{
-    {"-o", Flag::OptionType}, {"--option-type",      Flag::OptionType},
-    {"-u", Flag::Underlying}, {"--underlying-price", Flag::Underlying},
-    {"-s", Flag::Strike},     {"--strike-price",     Flag::Strike},
-    {"-t", Flag::Expiry},     {"--time-to-expiry",   Flag::Expiry},
-    {"-v", Flag::Volatility}, {"--volatility",       Flag::Volatility},
-    {"-r", Flag::Interest},   {"--rate-of-interest", Flag::Interest},
-    {"-d", Flag::Dividend},   {"--dividend",         Flag::Dividend},
+static constexpr const auto NUM_FLAGS = std::size(FLAG_NAMES);
+
+constexpr auto countFlags(FlagKind kind) -> uint32_t {
+    return static_cast<uint32_t>(std::count_if(std::begin(FLAG_NAMES), std::end(FLAG_NAMES),
+                                               [kind](const FlagName &name) { return name.kind_ == kind; }));
+}
+
+static constexpr const uint32_t NUM_BASE_FLAGS = countFlags(FlagKind::Required);
+static constexpr const uint32_t NUM_ADDL_FLAGS = countFlags(FlagKind::Optional);
+static constexpr const uint32_t NUM_ALL_FLAGS  = NUM_BASE_FLAGS + NUM_ADDL_FLAGS;
+
+// Chain runs take their strikes from the ladder, and price both calls and puts,
+// so require only the underlying price and expiry of the contract flags
+static constexpr const uint32_t NUM_CHAIN_FLAGS = 2;
+static constexpr const std::size_t MAX_CHAIN_STRIKES = 100000;
+
+// Strikes and volatilities of a '--chain' run, which its Chain views
+struct ChainLadder
+{
+    double underlyingPrice_ = 0;
+    double timeToExpiry_ = 0;
+    double riskFreeInterest_ = 0;
+    double dividendYield_ = 0;
+    std::vector<double> strikes_;
+    std::vector<double> volatilities_;  // by strike, or one for every strike
+
+    auto chain() const -> Chain<double> {
+        return { underlyingPrice_, strikes_, timeToExpiry_, volatilities_, riskFreeInterest_, dividendYield_ };
+    }
 };
 
-static const uint32_t NUM_BASE_FLAGS = baseOpts.size() / 2;
-static const uint32_t NUM_ADDL_FLAGS = addOpts.size() / 2;
-static const uint32_t NUM_ALL_FLAGS  = NUM_BASE_FLAGS + NUM_ADDL_FLAGS;
+// Flag of the given short or long name, or null where none
+constexpr auto findFlag(std::string_view arg) -> const FlagName* {
+    for (const auto &name : FLAG_NAMES) {
+        if (!arg.empty() && (arg == name.short_ || arg == name.long_)) {
+            return &name;
+        }
+    }
+    return nullptr;
+}
+
+constexpr auto flagIndex(Flag flag) -> std::size_t {
+    for (std::size_t index = 0; index < NUM_FLAGS; ++index) {
+        if (FLAG_NAMES[index].flag_ == flag) {
+            return index;
+        }
+    }
+    return NUM_FLAGS;
+}
 
+// Parses command line arguments without allocating. Arguments are referenced
+// rather than copied, so must outlive the parser, as those of main() do.
 class ArgParser
 {
 public:
     using value_type = double;
     ArgParser() = default;
 
+    auto populateArgs(int argc, const char *const *argv) -> bool;
     auto populateArgs(const Args &params) -> bool;
+    // Temporaries would be destroyed while still referenced
+    auto populateArgs(Args &&params) -> bool = delete;
     auto getOptionValues() -> OptionValues<value_type>;
     auto getOptionType() -> OptionType;
-    auto getNumberArgs() const -> size_t { return arguments_.size(); }
+    auto getOutputs() -> OutputMask;
+    auto getThreads() -> size_t;
+    auto getPlacement() -> Placement;
+    auto getValidationTolerance() -> std::optional<value_type>;
+    auto getSurfaces() -> std::vector<VolSurface<value_type>>;
+    auto getCurves() -> std::vector<DiscountCurve<value_type>>;
+    auto getDividends() -> std::vector<DividendSchedule<value_type>>;
+    auto getSurfacesFile() -> std::optional<std::string>;
+    auto getCurvesFile() -> std::optional<std::string>;
+    auto getDividendsFile() -> std::optional<std::string>;
+    auto getGrouping() -> std::optional<Grouping>;
+    auto getInput() -> std::optional<std::string>;
+    auto getPageMode() -> PageMode;
+    auto getCacheCapacity() -> std::optional<std::size_t>;
+    auto getFormat() -> Format;
+    auto getCheckpoint() -> std::optional<std::string>;
+    auto getChunkLines() -> std::size_t;
+    auto getChain() -> ChainLadder;
+    auto getNumberArgs() const -> size_t {
+        return static_cast<size_t>(std::count_if(arguments_.begin(), arguments_.end(),
+                                                 [](const auto &argument) { return argument.has_value(); }));
+    }
+
+    // No contract flags given, i.e. contracts are read from standard input
+    auto isBatchRun() const -> bool { return batch_; }
+
+    // Contract flags given with '--chain', i.e. a ladder of strikes is priced
+    auto isChainRun() const -> bool { return !batch_ && argument(Flag::Chain).has_value(); }
 
 private:
-    auto validateFlags(const Args &flags) -> bool;
+    template <typename Arg>
+    auto populate(std::size_t count, Arg &&arg) -> bool;
+
+    auto argument(Flag flag) const -> const std::optional<std::string_view>& { return arguments_[flagIndex(flag)]; }
+    auto value(Flag flag) const -> std::string_view;
+    template <typename Number>
+    auto number(Flag flag) const -> Number;
 
-    OptionMap arguments_;
+    std::array<std::optional<std::string_view>, NUM_FLAGS> arguments_ {};
+    bool batch_ = false;
 };
 
 } //bsm
@@ -0,0 +1,201 @@
+#ifndef ASYNC_PRICER_H
+#define ASYNC_PRICER_H
+
+#include <algorithm>
+#include <array>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "batch.h"
+#include "black_scholes.h"
+#include "options.h"
+#include "outputs.h"
+#include "result_cache.h"
+
+namespace bsm
+{
+
+// Awaitable pricing for callers running on an event loop. Each co_await of price()
+// suspends its caller, and requests made before the loop next calls flush() are
+// coalesced and priced together, as batches of up to BATCH_SIZE rows, by a single
+// batch pricer, after which each caller is resumed, in request order, on the
+// thread calling flush(). Requests may be made from any thread. Given a result
+// cache, requests for contracts already priced, or repeated within a batch,
+// whether by the same or different callers, are answered without repricing.
+//
+//     auto quote = co_await pricer.price(OptionType::Call, values);
+//
+template <typename value_type = double,
+          typename Pricer = BlackScholes<value_type>>
+class AsyncPricer
+{
+    // Request of a suspended caller, held in its coroutine frame until resumed
+    struct Request
+    {
+        OptionType type_;
+        OptionValues<value_type> values_;
+        Quote<value_type> quote_;
+        std::exception_ptr error_;
+        std::coroutine_handle<> caller_;
+    };
+
+public:
+    class Awaitable
+    {
+    public:
+        Awaitable(AsyncPricer &pricer, OptionType type, const OptionValues<value_type> &values)
+            : pricer_(pricer)
+            , request_ { type, values, {}, nullptr, nullptr }
+        {}
+
+        auto await_ready() const noexcept -> bool { return false; }
+
+        void await_suspend(std::coroutine_handle<> caller) {
+            request_.caller_ = caller;
+            pricer_.enqueue(request_);
+        }
+
+        auto await_resume() -> Quote<value_type> {
+            if (request_.error_) {
+                std::rethrow_exception(request_.error_);
+            }
+            return request_.quote_;
+        }
+
+    private:
+        AsyncPricer &pricer_;
+        Request request_;
+    };
+
+    AsyncPricer() = default;
+    explicit AsyncPricer(const OutputMask outputs,
+                         const MarketData<value_type> market = {},
+                         Pricer pricer = Pricer(),
+                         ResultCache<value_type> *cache = nullptr)
+        : pricer_(outputs, market, std::move(pricer), cache)
+    {}
+
+    AsyncPricer(const AsyncPricer &) = delete;
+    auto operator=(const AsyncPricer &) -> AsyncPricer& = delete;
+
+    // Contracts of unknown type are rejected here, rather than failing their batch
+    auto price(OptionType type, const OptionValues<value_type> &values) -> Awaitable {
+        if (type == OptionType::None) {
+            throw std::runtime_error("Cannot price an option of unknown type!");
+        }
+        return Awaitable(*this, type, values);
+    }
+
+    // Price all pending requests and resume their callers. Requests made by
+    // resumed callers are priced in turn, until none are pending.
+    // Returns the number of callers resumed.
+    auto flush() -> std::size_t {
+        std::size_t resumed = 0;
+        while (true) {
+            {
+                std::lock_guard lock(mutex_);
+                if (pending_.empty()) {
+                    return resumed;
+                }
+                std::swap(pending_, inflight_);
+            }
+
+            for (std::size_t begin = 0; begin < inflight_.size(); begin += BATCH_SIZE) {
+                priceBatch(begin, std::min(begin + BATCH_SIZE, inflight_.size()));
+            }
+            // Callers may enqueue again once resumed, so are resumed only once all are priced
+            for (auto *request : inflight_) {
+                request->caller_.resume();
+                ++resumed;
+            }
+            inflight_.clear();
+        }
+    }
+
+    auto pending() const -> std::size_t {
+        std::lock_guard lock(mutex_);
+        return pending_.size();
+    }
+
+    auto outputs() const -> OutputMask { return pricer_.outputs(); }
+
+private:
+    void enqueue(Request &request) {
+        std::lock_guard lock(mutex_);
+        pending_.push_back(&request);
+    }
+
+    // Requests are validated alone, so that a request of invalid values fails only its
+    // own caller. Should a batch of valid requests still fail, e.g. in its pricing model,
+    // its requests are repriced one by one, failing only the requests which fail alone.
+    void priceBatch(std::size_t begin, std::size_t end) {
+        rows_.clear();
+        for (auto i = begin; i < end; ++i) {
+            try {
+                validate(inflight_[i]->values_);
+                rows_.push_back(i);
+            }
+            catch (...) {
+                inflight_[i]->error_ = std::current_exception();
+            }
+        }
+
+        try {
+            priceRows(rows_);
+        }
+        catch (...) {
+            for (const auto i : rows_) {
+                try {
+                    priceRows({ &i, 1 });
+                }
+                catch (...) {
+                    inflight_[i]->error_ = std::current_exception();
+                }
+            }
+        }
+    }
+
+    // Price the given inflight requests as a single batch
+    void priceRows(std::span<const std::size_t> rows) {
+        batch_.clear();
+        for (const auto i : rows) {
+            batch_.push(inflight_[i]->type_, inflight_[i]->values_);
+        }
+        pricer_(batch_, results_);
+
+        const auto outputs = pricer_.outputs();
+        for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+            if (outputs.contains(static_cast<Output>(output))) {
+                const auto &column = results_.column(static_cast<Output>(output));
+                for (std::size_t row = 0; row < rows.size(); ++row) {
+                    inflight_[rows[row]]->quote_.values_[output] = column[row];
+                }
+            }
+        }
+    }
+
+    // Values are public, so may be changed once validated by their construction,
+    // and are validated again by constructing their copy
+    static void validate(const OptionValues<value_type> &values) {
+        OptionValues<value_type> { values.underlyingPrice_, values.strikePrice_, values.timeToExpiry_,
+                                   values.volatility_, values.riskFreeInterest_, values.dividendYield_ };
+    }
+
+    BatchPricer<value_type, Pricer> pricer_;
+    OptionBatch<value_type> batch_;
+    BatchResults<value_type> results_;
+    mutable std::mutex mutex_;
+    std::vector<Request*> pending_;   // suspended requests, in request order
+    std::vector<Request*> inflight_;  // requests being priced by flush()
+    std::vector<std::size_t> rows_;   // inflight requests of the batch being priced, once validated
+};
+
+} // bsm
+
+#endif
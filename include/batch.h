@@ -0,0 +1,653 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "black_scholes.h"
+#include "discount_curve.h"
+#include "dividends.h"
+#include "huge_pages.h"
+#include "options.h"
+#include "outputs.h"
+#include "result_cache.h"
+#include "thread_pool.h"
+#include "vol_surface.h"
+
+namespace bsm
+{
+
+static constexpr const std::size_t BATCH_SIZE = 4096;
+
+// Rows of a batch of which each column of values fills a huge page, as the columns
+// of batches of BATCH_SIZE rows are too small to be backed by HugePageAllocator
+template <typename value_type = double>
+static constexpr const std::size_t HUGE_PAGE_BATCH_SIZE = HUGE_PAGE_SIZE / sizeof(value_type);
+
+// Column of a batch, of which those of whole portfolios may be backed by huge pages
+template <typename T>
+using BatchColumn = std::vector<T, HugePageAllocator<T>>;
+
+// Column (structure of arrays) storage for a batch of option contracts.
+// Rows are validated on entry, via the construction of OptionValues.
+template <typename value_type = double>
+struct OptionBatch
+{
+public:
+    OptionBatch() = default;
+
+    void push(OptionType type, const OptionValues<value_type> &values,
+              std::uint32_t underlying = 0, std::uint32_t surface = NO_SURFACE, std::uint32_t curve = NO_CURVE,
+              value_type quantity = 1, std::uint32_t book = 0) {
+        if (type == OptionType::None) {
+            throw std::runtime_error("Cannot batch an option of unknown type!");
+        }
+        type_.push_back(type);
+        underlying_.push_back(underlying);
+        surface_.push_back(surface);
+        curve_.push_back(curve);
+        book_.push_back(book);
+        quantity_.push_back(quantity);
+        underlyingPrice_.push_back(values.underlyingPrice_);
+        strikePrice_.push_back(values.strikePrice_);
+        timeToExpiry_.push_back(values.timeToExpiry_);
+        volatility_.push_back(values.volatility_);
+        riskFreeInterest_.push_back(values.riskFreeInterest_);
+        interestDiscount_.push_back(values.interestDiscount_);
+        dividendYield_.push_back(values.dividendYield_);
+    }
+
+    void reserve(std::size_t rows) {
+        type_.reserve(rows);
+        underlying_.reserve(rows);
+        surface_.reserve(rows);
+        curve_.reserve(rows);
+        book_.reserve(rows);
+        quantity_.reserve(rows);
+        underlyingPrice_.reserve(rows);
+        strikePrice_.reserve(rows);
+        timeToExpiry_.reserve(rows);
+        volatility_.reserve(rows);
+        riskFreeInterest_.reserve(rows);
+        interestDiscount_.reserve(rows);
+        dividendYield_.reserve(rows);
+    }
+
+    void clear() {
+        type_.clear();
+        underlying_.clear();
+        surface_.clear();
+        curve_.clear();
+        book_.clear();
+        quantity_.clear();
+        underlyingPrice_.clear();
+        strikePrice_.clear();
+        timeToExpiry_.clear();
+        volatility_.clear();
+        riskFreeInterest_.clear();
+        interestDiscount_.clear();
+        dividendYield_.clear();
+    }
+
+    auto size()  const -> std::size_t { return type_.size(); }
+    auto empty() const -> bool        { return type_.empty(); }
+
+    auto values(std::size_t row) const -> OptionValues<value_type> {
+        return OptionValues<value_type> {
+            underlyingPrice_[row], strikePrice_[row], timeToExpiry_[row],
+            volatility_[row], riskFreeInterest_[row], dividendYield_[row], interestDiscount_[row]
+        };
+    }
+
+    BatchColumn<OptionType> type_;
+    BatchColumn<std::uint32_t> underlying_; // index of the underlying's dividend schedule, if any
+    BatchColumn<std::uint32_t> surface_;    // index of the volatility surface, or NO_SURFACE for the row's own volatility
+    BatchColumn<std::uint32_t> curve_;      // index of the discount curve, or NO_CURVE for the row's own rate
+    BatchColumn<std::uint32_t> book_;       // book holding the position, for aggregation
+    BatchColumn<value_type> quantity_;      // signed number of contracts held
+    BatchColumn<value_type> underlyingPrice_;
+    BatchColumn<value_type> strikePrice_;
+    BatchColumn<value_type> timeToExpiry_;
+    BatchColumn<value_type> volatility_;
+    BatchColumn<value_type> riskFreeInterest_;
+    BatchColumn<value_type> interestDiscount_; // memoized on entry, or shared per expiry of a discount curve
+    BatchColumn<value_type> dividendYield_;
+};
+
+// Allocator which default initialises elements, leaving arithmetic elements
+// uninitialised on resize, so that the pages of a column are first touched,
+// and so placed on a NUMA node, by the pool thread that writes them.
+// Columns of whole portfolios may be backed by huge pages, as batch columns.
+template <typename T>
+struct FirstTouchAllocator : HugePageAllocator<T>
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = FirstTouchAllocator<U>; };
+
+    FirstTouchAllocator() = default;
+    template <typename U>
+    FirstTouchAllocator(const FirstTouchAllocator<U> &) noexcept {}
+
+    template <typename U>
+    void construct(U *ptr) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U *ptr, Args&&... args) {
+        ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+    }
+};
+
+template <typename value_type>
+using ResultColumn = std::vector<value_type, FirstTouchAllocator<value_type>>;
+
+// Column storage for the price and greeks of each row in a batch.
+// Only the columns selected by the output mask are populated, each
+// row of which is written by the pricer, so is left uninitialised here.
+template <typename value_type = double>
+struct BatchResults
+{
+public:
+    void resize(std::size_t rows, const OutputMask outputs = OutputMask::firstOrder()) {
+        rows_ = rows;
+        outputs_ = outputs;
+        for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+            const auto selected = outputs.contains(static_cast<Output>(output));
+            column(static_cast<Output>(output)).resize(selected ? rows : 0);
+        }
+    }
+
+    auto size()    const -> std::size_t { return rows_; }
+    auto outputs() const -> OutputMask  { return outputs_; }
+
+    auto column(Output output) -> ResultColumn<value_type>& {
+        return const_cast<ResultColumn<value_type>&>(std::as_const(*this).column(output));
+    }
+
+    auto column(Output output) const -> const ResultColumn<value_type>& {
+        switch (output) {
+        case Output::Price:  return price_;
+        case Output::Delta:  return delta_;
+        case Output::Gamma:  return gamma_;
+        case Output::Theta:  return theta_;
+        case Output::Vega:   return vega_;
+        case Output::Rho:    return rho_;
+        case Output::Vanna:  return vanna_;
+        case Output::Volga:  return volga_;
+        case Output::Charm:  return charm_;
+        case Output::Speed:  return speed_;
+        case Output::Zomma:  return zomma_;
+        case Output::Colour: return colour_;
+        default:
+            throw std::runtime_error("Cannot find results of unknown output!");
+        }
+    }
+
+    ResultColumn<value_type> price_;
+    ResultColumn<value_type> delta_;
+    ResultColumn<value_type> gamma_;
+    ResultColumn<value_type> theta_;
+    ResultColumn<value_type> vega_;
+    ResultColumn<value_type> rho_;
+    ResultColumn<value_type> vanna_;
+    ResultColumn<value_type> volga_;
+    ResultColumn<value_type> charm_;
+    ResultColumn<value_type> speed_;
+    ResultColumn<value_type> zomma_;
+    ResultColumn<value_type> colour_;
+
+private:
+    std::size_t rows_ = 0;
+    OutputMask outputs_;
+};
+
+// Market data shared by the rows of a batch, referenced by index from each row
+template <typename value_type = double>
+struct MarketData
+{
+    std::span<const DividendSchedule<value_type>> dividends_ = {}; // by underlying
+    std::span<const VolSurface<value_type>> surfaces_ = {};        // by surface id
+    std::span<const DiscountCurve<value_type>> curves_ = {};       // by curve id
+};
+
+// Prices a batch of mixed calls and puts, deriving only the selected outputs.
+// Rows are stably partitioned by option type into contiguous scratch columns,
+// so that each executor is run as a homogeneous kernel over its own range,
+// free of per-row type dispatch. Results are then scattered back to input order.
+// Discrete dividend schedules, indexed by each row's underlying, are applied to
+// the spot price as rows are gathered, volatilities of rows referencing a
+// surface are looked up from it, and rows referencing a discount curve take
+// the discount factor and zero rate of their expiry, memoized per pricer, or
+// read from the caches of a ParallelPricer shared by the pricers of its chunks.
+// Given a result cache, rows are then looked up by their resolved inputs, and
+// only rows neither cached nor repeated earlier in the range are priced.
+template <typename value_type = double,
+          typename Pricer = BlackScholes<value_type>>
+class BatchPricer
+{
+public:
+    BatchPricer() = default;
+    explicit BatchPricer(const OutputMask outputs,
+                         const MarketData<value_type> market = {},
+                         Pricer pricer = Pricer(),
+                         ResultCache<value_type> *cache = nullptr,
+                         const std::vector<DiscountCache<value_type>> *sharedDiscounts = nullptr)
+        : outputs_(outputs)
+        , market_(market)
+        , pricer_(std::move(pricer))
+        , sharedDiscounts_(sharedDiscounts)
+        , cache_(cache)
+    {
+        if (cache_ != nullptr) {
+            if (cache_->outputs() != outputs_) {
+                throw std::runtime_error("Cannot share a result cache between different outputs");
+            }
+            cache_->bind(pricer_);
+        }
+        if (sharedDiscounts_ == nullptr) {
+            discounts_.reserve(market_.curves_.size());
+            for (const auto &curve : market_.curves_) {
+                discounts_.emplace_back(curve);
+            }
+        }
+    }
+
+    void operator()(const OptionBatch<value_type> &batch, BatchResults<value_type> &results) {
+        results.resize(batch.size(), outputs_);
+        price(batch, 0, batch.size(), results);
+    }
+
+    // Price rows [begin, end) of the batch into the same rows of results,
+    // which must already be sized for the batch
+    void price(const OptionBatch<value_type> &batch, std::size_t begin, std::size_t end,
+               BatchResults<value_type> &results) {
+        auto puts = partition(batch, begin, end);
+        if (cache_ != nullptr) {
+            puts = lookup(puts, results);
+        }
+
+        scratch_.resize(order_.size(), outputs_);
+        kernel<CallExecutor>(0, puts);
+        kernel<PutExecutor>(puts, order_.size());
+
+        scatter(results);
+        if (cache_ != nullptr) {
+            remember(results);
+        }
+    }
+
+    auto outputs() const -> OutputMask { return outputs_; }
+
+private:
+    // Gather rows into partitioned_, calls first then puts, each in input order.
+    // Returns the index of the first put.
+    auto partition(const OptionBatch<value_type> &batch, std::size_t begin, std::size_t end) -> std::size_t {
+        order_.resize(end - begin);
+        std::size_t calls = 0;
+        for (std::size_t row = begin; row < end; ++row) {
+            calls += (batch.type_[row] == OptionType::Call);
+        }
+
+        std::size_t call = 0, put = calls;
+        for (std::size_t row = begin; row < end; ++row) {
+            order_[(batch.type_[row] == OptionType::Call) ? call++ : put++] = row;
+        }
+
+        const auto gather = [&](const auto &in, auto &out) {
+            out.resize(order_.size());
+            for (std::size_t i = 0; i < order_.size(); ++i) {
+                out[i] = in[order_[i]];
+            }
+        };
+        gather(batch.type_,             partitioned_.type_);
+        gather(batch.underlying_,       partitioned_.underlying_);
+        gather(batch.surface_,          partitioned_.surface_);
+        gather(batch.curve_,            partitioned_.curve_);
+        gather(batch.underlyingPrice_,  partitioned_.underlyingPrice_);
+        gather(batch.strikePrice_,      partitioned_.strikePrice_);
+        gather(batch.timeToExpiry_,     partitioned_.timeToExpiry_);
+        gather(batch.volatility_,       partitioned_.volatility_);
+        gather(batch.riskFreeInterest_, partitioned_.riskFreeInterest_);
+        gather(batch.interestDiscount_, partitioned_.interestDiscount_);
+        gather(batch.dividendYield_,    partitioned_.dividendYield_);
+
+        const auto &dividends = market_.dividends_;
+        if (!dividends.empty()) {
+            for (std::size_t i = 0; i < order_.size(); ++i) {
+                const auto underlying = partitioned_.underlying_[i];
+                if (underlying < dividends.size() && !dividends[underlying].empty()) {
+                    auto &spot = partitioned_.underlyingPrice_[i];
+                    spot = dividends[underlying].adjustedSpot(spot, partitioned_.timeToExpiry_[i]);
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < order_.size(); ++i) {
+            const auto surface = partitioned_.surface_[i];
+            if (surface == NO_SURFACE) {
+                continue;
+            }
+            if (surface >= market_.surfaces_.size() || market_.surfaces_[surface].empty()) {
+                throw std::runtime_error("Cannot find volatility surface " + std::to_string(surface));
+            }
+            partitioned_.volatility_[i] = market_.surfaces_[surface].volatility(
+                partitioned_.underlyingPrice_[i], partitioned_.strikePrice_[i], partitioned_.timeToExpiry_[i]);
+        }
+
+        for (std::size_t i = 0; i < order_.size(); ++i) {
+            const auto curve = partitioned_.curve_[i];
+            if (curve == NO_CURVE) {
+                continue;
+            }
+            if (curve >= market_.curves_.size() || market_.curves_[curve].empty()) {
+                throw std::runtime_error("Cannot find discount curve " + std::to_string(curve));
+            }
+            const auto expiry = partitioned_.timeToExpiry_[i];
+            const auto discount = sharedDiscounts_ ? (*sharedDiscounts_)[curve].cached(expiry) : discounts_[curve](expiry);
+            partitioned_.riskFreeInterest_[i] = discount.rate_;
+            partitioned_.interestDiscount_[i] = discount.factor_;
+        }
+
+        return calls;
+    }
+
+    // Take the rows found in the cache, and rows repeating another row of the range,
+    // from the partitioned rows, leaving only distinct rows to price, in their order.
+    // Returns the index of the first put left.
+    auto lookup(std::size_t puts, BatchResults<value_type> &results) -> std::size_t {
+        keys_.clear();
+        repeats_.clear();
+        pending_.clear();
+        const auto &rows = partitioned_;
+        std::size_t kept = 0, keptCalls = 0;
+        for (std::size_t i = 0; i < order_.size(); ++i) {
+            const ContractKey<value_type> key(rows.type_[i], rows.values(i));
+
+            Quote<value_type> quote;
+            if (cache_->find(key, quote)) {
+                for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+                    if (outputs_.contains(static_cast<Output>(output))) {
+                        results.column(static_cast<Output>(output))[order_[i]] = quote.values_[output];
+                    }
+                }
+                continue;
+            }
+            const auto [pending, added] = pending_.emplace(key, kept);
+            if (!added) {
+                repeats_.emplace_back(order_[i], pending->second);
+                continue;
+            }
+
+            keptCalls += (i < puts);
+            keys_.push_back(key);
+            order_[kept] = order_[i];
+            partitioned_.type_[kept]             = partitioned_.type_[i];
+            partitioned_.underlyingPrice_[kept]  = partitioned_.underlyingPrice_[i];
+            partitioned_.strikePrice_[kept]      = partitioned_.strikePrice_[i];
+            partitioned_.timeToExpiry_[kept]     = partitioned_.timeToExpiry_[i];
+            partitioned_.volatility_[kept]       = partitioned_.volatility_[i];
+            partitioned_.riskFreeInterest_[kept] = partitioned_.riskFreeInterest_[i];
+            partitioned_.interestDiscount_[kept] = partitioned_.interestDiscount_[i];
+            partitioned_.dividendYield_[kept]    = partitioned_.dividendYield_[i];
+            ++kept;
+        }
+        order_.resize(kept);
+        return keptCalls;
+    }
+
+    // Cache the priced rows, and copy their results to the rows repeating them
+    void remember(BatchResults<value_type> &results) {
+        for (std::size_t i = 0; i < keys_.size(); ++i) {
+            Quote<value_type> quote;
+            for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+                if (outputs_.contains(static_cast<Output>(output))) {
+                    quote.values_[output] = scratch_.column(static_cast<Output>(output))[i];
+                }
+            }
+            cache_->insert(keys_[i], quote);
+        }
+        for (const auto &[row, kept] : repeats_) {
+            for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+                if (outputs_.contains(static_cast<Output>(output))) {
+                    auto &column = results.column(static_cast<Output>(output));
+                    column[row] = scratch_.column(static_cast<Output>(output))[kept];
+                }
+            }
+        }
+    }
+
+    // Output selection is invariant across the range, so each
+    // branch below is hoisted out of the loop by the compiler.
+    template <typename Executor>
+    void kernel(std::size_t begin, std::size_t end) {
+        const auto wants = [this](Output output) { return outputs_.contains(output); };
+        for (std::size_t i = begin; i < end; ++i) {
+            Option<Executor, value_type, Pricer> option(partitioned_.values(i), pricer_, outputs_);
+            if (wants(Output::Price))  { scratch_.price_[i]  = option(); }
+            if (wants(Output::Delta))  { scratch_.delta_[i]  = option.delta(); }
+            if (wants(Output::Gamma))  { scratch_.gamma_[i]  = option.gamma(); }
+            if (wants(Output::Theta))  { scratch_.theta_[i]  = option.theta(); }
+            if (wants(Output::Vega))   { scratch_.vega_[i]   = option.vega(); }
+            if (wants(Output::Rho))    { scratch_.rho_[i]    = option.rho(); }
+            if (wants(Output::Vanna))  { scratch_.vanna_[i]  = option.vanna(); }
+            if (wants(Output::Volga))  { scratch_.volga_[i]  = option.volga(); }
+            if (wants(Output::Charm))  { scratch_.charm_[i]  = option.charm(); }
+            if (wants(Output::Speed))  { scratch_.speed_[i]  = option.speed(); }
+            if (wants(Output::Zomma))  { scratch_.zomma_[i]  = option.zomma(); }
+            if (wants(Output::Colour)) { scratch_.colour_[i] = option.colour(); }
+        }
+    }
+
+    void scatter(BatchResults<value_type> &results) const {
+        for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+            const auto &in = scratch_.column(static_cast<Output>(output));
+            auto &out = results.column(static_cast<Output>(output));
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                out[order_[i]] = in[i];
+            }
+        }
+    }
+
+    OutputMask outputs_ = OutputMask::firstOrder();
+    MarketData<value_type> market_;
+    Pricer pricer_;
+    std::vector<DiscountCache<value_type>> discounts_; // by curve id
+    const std::vector<DiscountCache<value_type>> *sharedDiscounts_ = nullptr; // by curve id, in place of discounts_
+    std::vector<std::size_t> order_;       // input row of each partitioned row
+    OptionBatch<value_type> partitioned_;  // input rows, calls first then puts
+    BatchResults<value_type> scratch_;     // results in partitioned order
+    ResultCache<value_type> *cache_ = nullptr;
+    std::vector<ContractKey<value_type>> keys_;                    // key of each row left to price
+    std::vector<std::pair<std::size_t, std::size_t>> repeats_;     // input row, and the row left to price it repeats
+    std::unordered_map<ContractKey<value_type>, std::size_t, ContractHash<value_type>> pending_;
+};
+
+// Prices fixed size chunks of a batch in parallel across a thread pool,
+// each chunk by its own batch pricer, sharing any result cache. Discount
+// factors are cached by the parallel pricer, across all of its batches, so
+// each distinct expiry of a curve is discounted once. The expiries of each
+// batch are cached ahead of its chunks, which then only read the caches.
+template <typename value_type = double,
+          typename Pricer = BlackScholes<value_type>>
+class ParallelPricer
+{
+public:
+    ParallelPricer() = delete;
+    explicit ParallelPricer(ThreadPool &pool,
+                            const OutputMask outputs = OutputMask::firstOrder(),
+                            const MarketData<value_type> market = {},
+                            Pricer pricer = Pricer(),
+                            ResultCache<value_type> *cache = nullptr)
+        : pool_(pool)
+        , outputs_(outputs)
+        , market_(market)
+        , pricer_(std::move(pricer))
+        , cache_(cache)
+    {
+        if (cache_ != nullptr) {
+            if (cache_->outputs() != outputs_) {
+                throw std::runtime_error("Cannot share a result cache between different outputs");
+            }
+            cache_->bind(pricer_);
+        }
+        discounts_.reserve(market_.curves_.size());
+        for (const auto &curve : market_.curves_) {
+            discounts_.emplace_back(curve);
+        }
+    }
+
+    void operator()(const OptionBatch<value_type> &batch, BatchResults<value_type> &results) {
+        results.resize(batch.size(), outputs_);
+        if (!discounts_.empty()) {
+            for (std::size_t row = 0; row < batch.size(); ++row) {
+                const auto curve = batch.curve_[row];
+                if (curve < discounts_.size() && !market_.curves_[curve].empty()) {
+                    discounts_[curve](batch.timeToExpiry_[row]);
+                }
+            }
+        }
+        pool_.parallelFor(batch.size(), CHUNK_SIZE, [&](std::size_t begin, std::size_t end) {
+            BatchPricer<value_type, Pricer> pricer(outputs_, market_, pricer_, cache_, &discounts_);
+            pricer.price(batch, begin, end, results);
+        });
+    }
+
+    // Discount caches, by curve id, of the distinct expiries of all batches priced
+    auto discounts() const -> const std::vector<DiscountCache<value_type>>& { return discounts_; }
+
+private:
+    ThreadPool &pool_;
+    OutputMask outputs_;
+    MarketData<value_type> market_;
+    Pricer pricer_;
+    ResultCache<value_type> *cache_;
+    std::vector<DiscountCache<value_type>> discounts_; // by curve id
+};
+
+// Contract columns owned by the caller, e.g. NumPy arrays, read in place.
+// Types are 0 for calls and 1 for puts; yields may be null, for no dividends.
+template <typename value_type = double>
+struct ColumnView
+{
+    std::size_t rows_ = 0;
+    const std::int32_t *type_ = nullptr;
+    const value_type *underlyingPrice_ = nullptr;
+    const value_type *strikePrice_ = nullptr;
+    const value_type *timeToExpiry_ = nullptr;
+    const value_type *volatility_ = nullptr;
+    const value_type *riskFreeInterest_ = nullptr;
+    const value_type *dividendYield_ = nullptr;
+};
+
+// Result columns owned by the caller, by output, of which only the selected are written
+template <typename value_type = double>
+using OutputColumns = std::array<value_type*, NUM_OUTPUTS>;
+
+// Prices caller owned columns in parallel, chunk by chunk, writing each chunk's
+// results directly to the caller's result columns, so no batch of the whole input
+// is built. Rows failing validation are reported by index.
+template <typename value_type = double,
+          typename Pricer = BlackScholes<value_type>>
+class ColumnPricer
+{
+public:
+    ColumnPricer() = delete;
+    explicit ColumnPricer(ThreadPool &pool,
+                          const OutputMask outputs = OutputMask::firstOrder(),
+                          const MarketData<value_type> market = {},
+                          Pricer pricer = Pricer())
+        : pool_(pool)
+        , outputs_(outputs)
+        , market_(market)
+        , pricer_(std::move(pricer))
+    {}
+
+    void operator()(const ColumnView<value_type> &columns, const OutputColumns<value_type> &results) const {
+        if (columns.rows_ > 0 && (columns.type_ == nullptr || columns.underlyingPrice_ == nullptr
+                                  || columns.strikePrice_ == nullptr || columns.timeToExpiry_ == nullptr
+                                  || columns.volatility_ == nullptr || columns.riskFreeInterest_ == nullptr)) {
+            throw std::runtime_error("Cannot price columns without contract values");
+        }
+        for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+            if (outputs_.contains(static_cast<Output>(output)) && results[output] == nullptr) {
+                throw std::runtime_error("Cannot price columns without a result column for "
+                                         + std::string(outputName(static_cast<Output>(output))));
+            }
+        }
+
+        pool_.parallelFor(columns.rows_, CHUNK_SIZE, [&](std::size_t begin, std::size_t end) {
+            thread_local OptionBatch<value_type> batch;
+            thread_local BatchResults<value_type> chunk;
+            batch.clear();
+            for (auto row = begin; row < end; ++row) {
+                push(columns, row, batch);
+            }
+
+            BatchPricer<value_type, Pricer> pricer(outputs_, market_, pricer_);
+            pricer(batch, chunk);
+            for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+                if (outputs_.contains(static_cast<Output>(output))) {
+                    const auto &column = chunk.column(static_cast<Output>(output));
+                    std::copy(column.begin(), column.end(), results[output] + begin);
+                }
+            }
+        });
+    }
+
+    auto outputs() const -> OutputMask { return outputs_; }
+
+private:
+    static void push(const ColumnView<value_type> &columns, std::size_t row, OptionBatch<value_type> &batch) {
+        const auto type = columns.type_[row];
+        try {
+            if (type != static_cast<std::int32_t>(OptionType::Call) && type != static_cast<std::int32_t>(OptionType::Put)) {
+                throw std::runtime_error("Unknown option type: " + std::to_string(type));
+            }
+            batch.push(static_cast<OptionType>(type),
+                       OptionValues<value_type> {
+                           columns.underlyingPrice_[row], columns.strikePrice_[row], columns.timeToExpiry_[row],
+                           columns.volatility_[row], columns.riskFreeInterest_[row],
+                           (columns.dividendYield_ != nullptr) ? columns.dividendYield_[row] : value_type{0} });
+        }
+        catch (const std::exception &e) {
+            throw std::runtime_error("Row " + std::to_string(row) + ": " + e.what());
+        }
+    }
+
+    ThreadPool &pool_;
+    OutputMask outputs_;
+    MarketData<value_type> market_;
+    Pricer pricer_;
+};
+
+#ifdef BSM_EXTERN_TEMPLATES
+// Instantiated by libbsm, see lib/instantiations.cpp
+extern template struct OptionBatch<float>;
+extern template struct OptionBatch<double>;
+extern template struct BatchResults<float>;
+extern template struct BatchResults<double>;
+extern template class BatchPricer<float>;
+extern template class BatchPricer<double>;
+extern template class ParallelPricer<float>;
+extern template class ParallelPricer<double>;
+extern template class ColumnPricer<float>;
+extern template class ColumnPricer<double>;
+#endif
+
+} // bsm
+
+#endif
@@ -16,27 +16,43 @@ class BlackScholes
 public:
     BlackScholes() = default;
 
+    constexpr auto operator==(const BlackScholes &) const -> bool = default;
+
     constexpr auto callOptionValue(const OptionValues<value_type> &values) const -> value_type {
-        const auto dOne = d1(values);
-        const auto returns = returnsProbability(values.underlyingPrice_ * 1, dOne); // e^(-rf*t) assume divid rf = 0 i.e. this term = 1
+        return callOptionValue(values, values.underlyingPrice_);
+    }
+
+    constexpr auto putOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        return putOptionValue(values, values.underlyingPrice_);
+    }
+
+    // Value at an alternate underlying price, reusing the memoized discount terms of the
+    // given values, e.g. at the early exercise boundary of American approximations.
+    constexpr auto callOptionValue(const OptionValues<value_type> &values, const value_type spot) const -> value_type {
+        const auto dOne = d1(values, spot);
+        const auto returns = returnsProbability(spot * values.dividendDiscount_, dOne);
         const auto cost = costProbability(values, d2(dOne, values));
         const auto value = returns - cost;
         return (value > 0) ? value : 0.00;
     }
 
-    constexpr auto putOptionValue(const OptionValues<value_type> &values) const -> value_type {
-        const auto dOne = d1(values);
+    constexpr auto putOptionValue(const OptionValues<value_type> &values, const value_type spot) const -> value_type {
+        const auto dOne = d1(values, spot);
         const auto cost = costProbability(values, -d2(dOne, values));
-        const auto returns = returnsProbability(values.underlyingPrice_ * 1, -dOne); // e^(-rf*t) assume divid rf = 0 i.e. this term = 1
+        const auto returns = returnsProbability(spot * values.dividendDiscount_, -dOne);
         const auto value = cost - returns;
         return (value > 0) ? value : 0.00;
     }
 
     constexpr auto d1(const OptionValues<value_type> &values) const -> value_type {
-        const auto ratio = std::log(values.underlyingPrice_ / values.strikePrice_);
+        return d1(values, values.underlyingPrice_);
+    }
+
+    constexpr auto d1(const OptionValues<value_type> &values, const value_type spot) const -> value_type {
+        const auto ratio = std::log(spot / values.strikePrice_);
         const auto volVariance = std::pow(values.volatility_, 2) / 2;
-        const auto discountedTime = values.riskFreeInterest_ - values.dividendYield_ + volVariance; // minus divid, assumed 0 here.
-        const auto probability = (ratio + discountedTime) * values.timeToExpiry_;
+        const auto discountedTime = (values.riskFreeInterest_ - values.dividendYield_ + volVariance) * values.timeToExpiry_;
+        const auto probability = ratio + discountedTime;
         const auto time = values.volatility_ * (std::sqrt(values.timeToExpiry_));
         return (1 / time) * probability;
     }
@@ -56,11 +72,16 @@ private:
     }
 
     constexpr auto costProbability(const OptionValues<value_type> &values, const value_type ratio) const -> value_type {
-        const auto riskFreeReturns = std::exp(-values.riskFreeInterest_ * values.timeToExpiry_);
-        return values.strikePrice_ * riskFreeReturns * cumulNormalDist(ratio);
+        return values.strikePrice_ * values.interestDiscount_ * cumulNormalDist(ratio);
     }
 };
 
+#ifdef BSM_EXTERN_TEMPLATES
+// Instantiated by libbsm, see lib/instantiations.cpp
+extern template class BlackScholes<float>;
+extern template class BlackScholes<double>;
+#endif
+
 } // bsm
 
 #endif
@@ -0,0 +1,92 @@
+#ifndef BROWNIAN_BRIDGE_H
+#define BROWNIAN_BRIDGE_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace bsm
+{
+
+// Constructs Brownian paths over equal time steps by bisection, as given by Jäckel (2002).
+// The first normal fixes the terminal value, and each following normal the midpoint of
+// the widest remaining interval, so that the leading dimensions of a low discrepancy
+// sequence, which are the most evenly distributed, determine most of the path variance.
+template <typename value_type = double>
+class BrownianBridge
+{
+public:
+    explicit BrownianBridge(std::size_t steps)
+        : steps_(steps)
+        , bridge_(steps)
+        , left_(steps)
+        , right_(steps)
+        , leftWeight_(steps)
+        , rightWeight_(steps)
+        , deviation_(steps)
+    {
+        // Unit time steps, so that increments are standard normal
+        const auto time = [](std::size_t step) { return static_cast<value_type>(step + 1); };
+
+        std::vector<bool> built(steps_, false);
+        built[steps_ - 1] = true;
+        bridge_[0] = steps_ - 1;
+        deviation_[0] = std::sqrt(time(steps_ - 1));
+
+        for (std::size_t i = 1, j = 0; i < steps_; ++i) {
+            while (built[j]) {
+                ++j;
+            }
+            auto k = j;
+            while (!built[k]) {
+                ++k;
+            }
+            const auto l = j + ((k - 1 - j) / 2);
+            built[l] = true;
+            bridge_[i] = l;
+            left_[i] = j;
+            right_[i] = k;
+
+            const auto start = (j == 0) ? value_type{0} : time(j - 1);
+            leftWeight_[i] = (time(k) - time(l)) / (time(k) - start);
+            rightWeight_[i] = (time(l) - start) / (time(k) - start);
+            deviation_[i] = std::sqrt((time(l) - start) * (time(k) - time(l)) / (time(k) - start));
+
+            j = k + 1;
+            if (j >= steps_) {
+                j = 0;
+            }
+        }
+    }
+
+    auto steps() const -> std::size_t { return steps_; }
+
+    // Transform steps() independent standard normals into the standard normal
+    // increments of a Brownian path, in time order
+    void transform(const value_type *normals, value_type *increments) const {
+        increments[steps_ - 1] = deviation_[0] * normals[0];
+        for (std::size_t i = 1; i < steps_; ++i) {
+            const auto j = left_[i];
+            const auto k = right_[i];
+            const auto l = bridge_[i];
+            const auto start = (j == 0) ? value_type{0} : leftWeight_[i] * increments[j - 1];
+            increments[l] = start + (rightWeight_[i] * increments[k]) + (deviation_[i] * normals[i]);
+        }
+        for (std::size_t step = steps_ - 1; step > 0; --step) {
+            increments[step] -= increments[step - 1];
+        }
+    }
+
+private:
+    std::size_t steps_;
+    std::vector<std::size_t> bridge_;     // step constructed by each normal
+    std::vector<std::size_t> left_;       // one past the step bounding it on the left
+    std::vector<std::size_t> right_;      // step bounding it on the right
+    std::vector<value_type> leftWeight_;
+    std::vector<value_type> rightWeight_;
+    std::vector<value_type> deviation_;
+};
+
+} // bsm
+
+#endif
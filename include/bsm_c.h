@@ -0,0 +1,122 @@
+#ifndef BSM_C_H
+#define BSM_C_H
+
+/*
+ * Stable C ABI of libbsm, for pricing batches of European options in process,
+ * e.g. from Python (ctypes, cffi) or Java (JNA, Panama), over caller owned
+ * column arrays. Structures are only ever extended at their end, and the ABI
+ * version is incremented whenever they are.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Symbols are exported by the shared library as it is built (BSM_BUILDING_LIB),
+ * and imported by its consumers. Consumers of the static library define BSM_STATIC,
+ * as its CMake target does for them.
+ */
+#if defined(_WIN32)
+#if defined(BSM_STATIC)
+#define BSM_API
+#elif defined(BSM_BUILDING_LIB)
+#define BSM_API __declspec(dllexport)
+#else
+#define BSM_API __declspec(dllimport)
+#endif
+#else
+#define BSM_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BSM_ABI_VERSION 1
+
+/* Option types of the type column */
+#define BSM_CALL 0
+#define BSM_PUT  1
+
+/* Status codes */
+#define BSM_OK               0
+#define BSM_INVALID_ARGUMENT 1  /* null or mismatched arguments */
+#define BSM_INVALID_ROW      2  /* a row failed validation, see bsm_last_error() */
+#define BSM_FAILURE          3
+
+/* Contract columns, each of rows elements. Yields may be null, for no dividends. */
+typedef struct bsm_columns_d
+{
+    size_t rows;
+    const int32_t *type;
+    const double *underlying_price;
+    const double *strike_price;
+    const double *time_to_expiry;     /* in years */
+    const double *volatility;
+    const double *risk_free_interest;
+    const double *dividend_yield;
+} bsm_columns_d;
+
+typedef struct bsm_columns_f
+{
+    size_t rows;
+    const int32_t *type;
+    const float *underlying_price;
+    const float *strike_price;
+    const float *time_to_expiry;
+    const float *volatility;
+    const float *risk_free_interest;
+    const float *dividend_yield;
+} bsm_columns_f;
+
+/* Result columns, each of rows elements. Only non-null columns are derived. */
+typedef struct bsm_results_d
+{
+    double *price;
+    double *delta;
+    double *gamma;
+    double *theta;
+    double *vega;
+    double *rho;
+    double *vanna;
+    double *volga;
+    double *charm;
+    double *speed;
+    double *zomma;
+    double *colour;
+} bsm_results_d;
+
+typedef struct bsm_results_f
+{
+    float *price;
+    float *delta;
+    float *gamma;
+    float *theta;
+    float *vega;
+    float *rho;
+    float *vanna;
+    float *volga;
+    float *charm;
+    float *speed;
+    float *zomma;
+    float *colour;
+} bsm_results_f;
+
+/* ABI version of the loaded library, to be checked against BSM_ABI_VERSION */
+BSM_API int bsm_abi_version(void);
+
+/* Instruction set of the kernel selected for this machine, e.g. "avx2" */
+BSM_API const char *bsm_kernel_isa(void);
+
+/* Price each row into the non-null result columns. Returns a status code. */
+BSM_API int bsm_price_batch_d(const bsm_columns_d *columns, bsm_results_d *results);
+BSM_API int bsm_price_batch_f(const bsm_columns_f *columns, bsm_results_f *results);
+
+/* Description of the last error on the calling thread, or an empty string */
+BSM_API const char *bsm_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef CHAIN_H
+#define CHAIN_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "batch.h"
+#include "constants.h"
+#include "options.h"
+#include "outputs.h"
+#include "thread_pool.h"
+
+namespace bsm
+{
+
+// Calls and puts of one underlying and expiry over a ladder of strikes, as quoted
+// together. Volatilities are by strike, or a single volatility for every strike.
+template <typename value_type = double>
+struct Chain
+{
+    value_type underlyingPrice_ = 0;
+    std::span<const value_type> strikes_ = {};
+    value_type timeToExpiry_ = 0;
+    std::span<const value_type> volatilities_ = {};
+    value_type riskFreeInterest_ = 0;
+    value_type dividendYield_ = 0;
+
+    auto size() const -> std::size_t { return strikes_.size(); }
+
+    auto volatility(std::size_t strike) const -> value_type {
+        return volatilities_[(volatilities_.size() == 1) ? 0 : strike];
+    }
+};
+
+// Selected outputs of the call and of the put at each strike of a chain
+template <typename value_type = double>
+struct ChainResults
+{
+    BatchResults<value_type> calls_;
+    BatchResults<value_type> puts_;
+};
+
+// Prices chains, deriving the selected outputs of both the call and the put at each
+// strike. Terms of the chain's spot, expiry, rate and yield are derived once for all
+// strikes, and those of each strike, d1, d2, their probabilities and the density of
+// d1, once for both its call and put. Each stage runs over the strikes as columns,
+// so that its arithmetic is vectorised, with strikes as lanes, leaving only the
+// log, erfc and exp of libm as scalar calls. Values match those of Option, and so
+// of BatchPricer, for the same contracts.
+template <typename value_type = double>
+class ChainPricer
+{
+public:
+    ChainPricer() = default;
+    explicit ChainPricer(const OutputMask outputs)
+        : outputs_(outputs)
+    {}
+
+    void operator()(const Chain<value_type> &chain, ChainResults<value_type> &results) {
+        validate(chain);
+        results.calls_.resize(chain.size(), outputs_);
+        results.puts_.resize(chain.size(), outputs_);
+        price(chain, 0, chain.size(), results);
+    }
+
+    // Validate the chain's contracts, as their OptionValues would be, reporting the
+    // first strike failing validation by index
+    static void validate(const Chain<value_type> &chain) {
+        if (chain.volatilities_.size() != 1 && chain.volatilities_.size() != chain.size()) {
+            throw std::runtime_error("Chain must have a volatility for each strike, or a single volatility");
+        }
+        const auto valid = [](value_type value, value_type min, value_type max) { return value >= min && value < max; };
+        for (std::size_t strike = 0; strike < chain.size(); ++strike) {
+            if (valid(chain.strikes_[strike], MIN_PRICE, MAX_PRICE) && valid(chain.volatility(strike), MIN_PC, MAX_PC)) {
+                continue;
+            }
+            try {
+                OptionValues<value_type> { chain.underlyingPrice_, chain.strikes_[strike], chain.timeToExpiry_,
+                                           chain.volatility(strike), chain.riskFreeInterest_, chain.dividendYield_ };
+            }
+            catch (const std::exception &e) {
+                throw std::runtime_error("Strike " + std::to_string(strike) + ": " + e.what());
+            }
+        }
+        // Terms shared by every strike
+        if (chain.size() > 0) {
+            OptionValues<value_type> { chain.underlyingPrice_, chain.strikes_[0], chain.timeToExpiry_,
+                                       chain.volatility(0), chain.riskFreeInterest_, chain.dividendYield_ };
+        }
+    }
+
+    // Price strikes [begin, end) of a validated chain into the same rows of results,
+    // which must already be sized for the chain
+    void price(const Chain<value_type> &chain, std::size_t begin, std::size_t end, ChainResults<value_type> &results) {
+        const auto count = end - begin;
+        const auto spot = chain.underlyingPrice_;
+        const auto time = chain.timeToExpiry_;
+        const auto rate = chain.riskFreeInterest_;
+        const auto yield = chain.dividendYield_;
+        const auto sqrtime = std::sqrt(time);
+        const auto interestDiscount = std::exp(-rate * time);
+        const auto dividendDiscount = std::exp(-yield * time);
+        const auto *strike = chain.strikes_.data() + begin;
+
+        for (auto *column : { &volatility_, &volTime_, &d1_, &d2_, &nd1_ }) {
+            column->resize(count);
+        }
+        for (auto &column : probability_) {
+            column.resize(count);
+        }
+        auto *vol = volatility_.data();
+        auto *volTime = volTime_.data();
+        auto *d1 = d1_.data();
+        auto *d2 = d2_.data();
+        auto *nd1 = nd1_.data();
+        auto *exercised = probability_[0].data(); // N(d1)
+        auto *expires = probability_[1].data();   // N(-d1)
+        auto *returns = probability_[2].data();   // N(d2)
+        auto *cost = probability_[3].data();      // N(-d2)
+
+        for (std::size_t i = 0; i < count; ++i) {
+            vol[i] = chain.volatility(begin + i);
+            d1[i] = std::log(spot / strike[i]);
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            volTime[i] = vol[i] * sqrtime;
+            d1[i] = (1 / volTime[i]) * (d1[i] + (rate - yield + vol[i] * vol[i] / 2) * time);
+            d2[i] = d1[i] - volTime[i];
+        }
+
+        const auto wants = [this](Output output) { return outputs_.contains(output); };
+        if (outputs_.intersects(EXERCISE_OUTPUTS)) {
+            for (std::size_t i = 0; i < count; ++i) {
+                exercised[i] = cumulNormalDist(d1[i]);
+                expires[i] = cumulNormalDist(-d1[i]);
+            }
+        }
+        if (outputs_.intersects(RETURNS_OUTPUTS)) {
+            for (std::size_t i = 0; i < count; ++i) {
+                returns[i] = cumulNormalDist(d2[i]);
+                cost[i] = cumulNormalDist(-d2[i]);
+            }
+        }
+        if (outputs_.intersects(DENSITY_OUTPUTS)) {
+            for (std::size_t i = 0; i < count; ++i) {
+                nd1[i] = (1 / std::sqrt(2 * M_PI)) * std::exp(-0.5 * d1[i] * d1[i]);
+            }
+        }
+
+        // Outputs of the same formula for calls and puts are written to both
+        const auto call = [&](Output output) { return results.calls_.column(output).data() + begin; };
+        const auto put = [&](Output output) { return results.puts_.column(output).data() + begin; };
+        const auto forward = spot * dividendDiscount;
+
+        if (wants(Output::Price)) {
+            auto *callOut = call(Output::Price), *putOut = put(Output::Price);
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto callValue = forward * exercised[i] - strike[i] * interestDiscount * returns[i];
+                const auto putValue = strike[i] * interestDiscount * cost[i] - forward * expires[i];
+                callOut[i] = (callValue > 0) ? callValue : 0;
+                putOut[i] = (putValue > 0) ? putValue : 0;
+            }
+        }
+        if (wants(Output::Delta)) {
+            auto *callOut = call(Output::Delta), *putOut = put(Output::Delta);
+            for (std::size_t i = 0; i < count; ++i) {
+                callOut[i] = dividendDiscount * exercised[i];
+                putOut[i] = -dividendDiscount * expires[i];
+            }
+        }
+        if (outputs_.intersects(GAMMA_OUTPUTS)) {
+            // Kept whether selected or not, as speed and zomma derive from gamma, as volga does from vega
+            gamma_.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                gamma_[i] = (dividendDiscount / (spot * vol[i] * sqrtime)) * nd1[i];
+            }
+            if (wants(Output::Gamma)) {
+                copy(gamma_.data(), count, call(Output::Gamma), put(Output::Gamma));
+            }
+        }
+        if (wants(Output::Theta)) {
+            auto *callOut = call(Output::Theta), *putOut = put(Output::Theta);
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto dividend = forward * (vol[i] / (2 * sqrtime)) * nd1[i];
+                const auto interest = strike[i] * interestDiscount * rate;
+                callOut[i] = forward * yield * exercised[i] - interest * returns[i] - dividend;
+                putOut[i] = -(forward * yield * expires[i]) + interest * cost[i] - dividend;
+            }
+        }
+        if (outputs_.intersects(VEGA_OUTPUTS)) {
+            vega_.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                vega_[i] = forward * sqrtime * nd1[i];
+            }
+            if (wants(Output::Vega)) {
+                copy(vega_.data(), count, call(Output::Vega), put(Output::Vega));
+            }
+        }
+        if (wants(Output::Rho)) {
+            auto *callOut = call(Output::Rho), *putOut = put(Output::Rho);
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto interest = strike[i] * time * interestDiscount;
+                callOut[i] = interest * returns[i];
+                putOut[i] = -interest * cost[i];
+            }
+        }
+        if (wants(Output::Vanna)) {
+            auto *callOut = call(Output::Vanna);
+            for (std::size_t i = 0; i < count; ++i) {
+                callOut[i] = -dividendDiscount * nd1[i] * d2[i] / vol[i];
+            }
+            copy(callOut, count, put(Output::Vanna));
+        }
+        if (wants(Output::Volga)) {
+            auto *callOut = call(Output::Volga);
+            for (std::size_t i = 0; i < count; ++i) {
+                callOut[i] = vega_[i] * d1[i] * d2[i] / vol[i];
+            }
+            copy(callOut, count, put(Output::Volga));
+        }
+        if (wants(Output::Charm)) {
+            auto *callOut = call(Output::Charm), *putOut = put(Output::Charm);
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto decay = dividendDiscount * nd1[i] * driftRatio(rate - yield, time, volTime[i], d2[i]);
+                callOut[i] = yield * dividendDiscount * exercised[i] - decay;
+                putOut[i] = -yield * dividendDiscount * expires[i] - decay;
+            }
+        }
+        if (wants(Output::Speed)) {
+            auto *callOut = call(Output::Speed);
+            for (std::size_t i = 0; i < count; ++i) {
+                callOut[i] = -(gamma_[i] / spot) * ((d1[i] / volTime[i]) + 1);
+            }
+            copy(callOut, count, put(Output::Speed));
+        }
+        if (wants(Output::Zomma)) {
+            auto *callOut = call(Output::Zomma);
+            for (std::size_t i = 0; i < count; ++i) {
+                callOut[i] = gamma_[i] * ((d1[i] * d2[i]) - 1) / vol[i];
+            }
+            copy(callOut, count, put(Output::Zomma));
+        }
+        if (wants(Output::Colour)) {
+            auto *callOut = call(Output::Colour);
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto ratio = driftRatio(rate - yield, time, volTime[i], d2[i]);
+                const auto decay = dividendDiscount * nd1[i] / (2 * spot * time * volTime[i]);
+                callOut[i] = decay * ((2 * yield * time) + 1 + (2 * ratio * time * d1[i]));
+            }
+            copy(callOut, count, put(Output::Colour));
+        }
+    }
+
+    auto outputs() const -> OutputMask { return outputs_; }
+
+private:
+    // Outputs which depend upon each term, of either the call or the put
+    static constexpr const OutputMask EXERCISE_OUTPUTS { Output::Price, Output::Delta, Output::Theta, Output::Charm };
+    static constexpr const OutputMask RETURNS_OUTPUTS  { Output::Price, Output::Theta, Output::Rho };
+    static constexpr const OutputMask DENSITY_OUTPUTS {
+        Output::Gamma, Output::Theta, Output::Vega, Output::Vanna, Output::Volga,
+        Output::Charm, Output::Speed, Output::Zomma, Output::Colour
+    };
+    static constexpr const OutputMask GAMMA_OUTPUTS { Output::Gamma, Output::Speed, Output::Zomma };
+    static constexpr const OutputMask VEGA_OUTPUTS  { Output::Vega, Output::Volga };
+
+    static constexpr auto cumulNormalDist(const value_type coefficient) -> value_type {
+        return static_cast<value_type>(0.5) * std::erfc(-coefficient * (1 / std::sqrt(2)));
+    }
+
+    // As of Greeks, the ratio of the drift of d2 to the variance over time to expiry
+    static constexpr auto driftRatio(value_type carry, value_type time, value_type volTime, value_type d2) -> value_type {
+        return (2 * carry * time - (d2 * volTime)) / (2 * time * volTime);
+    }
+
+    static void copy(const value_type *from, std::size_t count, value_type *to, value_type *other = nullptr) {
+        std::copy(from, from + count, to);
+        if (other != nullptr) {
+            std::copy(from, from + count, other);
+        }
+    }
+
+    OutputMask outputs_ = OutputMask::firstOrder();
+    std::vector<value_type> volatility_;   // of each strike, and the terms below, in strike order
+    std::vector<value_type> volTime_;      // volatility over the square root of time to expiry
+    std::vector<value_type> d1_;
+    std::vector<value_type> d2_;
+    std::vector<value_type> nd1_;          // standard normal density of d1
+    std::vector<value_type> probability_[4];
+    std::vector<value_type> gamma_;
+    std::vector<value_type> vega_;
+};
+
+// Price the calls and puts of a chain, by the chain kernel of the widest instruction
+// set this machine supports, across the pool, if any, a chunk of strikes per thread.
+// Results are resized for the chain. See lib/chain.cpp.
+void priceChain(const Chain<double> &chain, ChainResults<double> &results,
+                OutputMask outputs = OutputMask::firstOrder(), ThreadPool *pool = nullptr);
+void priceChain(const Chain<float> &chain, ChainResults<float> &results,
+                OutputMask outputs = OutputMask::firstOrder(), ThreadPool *pool = nullptr);
+
+// Price the calls and puts of a ladder of strikes, of volatilities by strike, or one
+// volatility for every strike
+template <typename value_type>
+auto priceChain(value_type spot, std::type_identity_t<std::span<const value_type>> strikes, value_type expiry,
+                std::type_identity_t<std::span<const value_type>> volatilities, value_type rate, value_type yield,
+                OutputMask outputs = OutputMask::firstOrder(), ThreadPool *pool = nullptr) -> ChainResults<value_type> {
+    ChainResults<value_type> results;
+    priceChain(Chain<value_type> { spot, strikes, expiry, volatilities, rate, yield }, results, outputs, pool);
+    return results;
+}
+
+#ifdef BSM_EXTERN_TEMPLATES
+// Instantiated by libbsm, see lib/instantiations.cpp
+extern template class ChainPricer<float>;
+extern template class ChainPricer<double>;
+#endif
+
+} // bsm
+
+#endif
@@ -0,0 +1,297 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <fmt/format.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "helpers.h"
+#include "input_reader.h"
+#include "outputs.h"
+
+namespace bsm
+{
+
+// Lines of input per chunk of a checkpointed run, by default
+static constexpr const std::size_t CHUNK_LINES = std::size_t{1} << 20;
+
+// Hash of the lines of a chunk of input, by which a rerun checks that the chunks it
+// resumes are of the same input as when they were priced
+class LineHash
+{
+public:
+    void add(std::string_view line) {
+        auto hash = mix(hash_ ^ line.size());
+        for (; line.size() >= sizeof(std::uint64_t); line.remove_prefix(sizeof(std::uint64_t))) {
+            std::uint64_t word;
+            std::memcpy(&word, line.data(), sizeof(word));
+            hash = mix(hash ^ word);
+        }
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, line.data(), line.size());
+        hash_ = mix(hash ^ tail);
+    }
+
+    auto value() const -> std::uint64_t { return hash_; }
+
+private:
+    static constexpr auto mix(std::uint64_t hash) -> std::uint64_t {
+        hash *= 0x9E3779B97F4A7C15ULL;
+        return hash ^ (hash >> 29);
+    }
+
+    std::uint64_t hash_ = 0xCBF29CE484222325ULL; // non-zero, as zero is fixed by mix()
+};
+
+// Chunk of input lines, and of the results written for them
+struct Chunk
+{
+    std::size_t lines_ = 0;         // of input, including headers and blank lines
+    std::size_t contracts_ = 0;     // priced, and written
+    std::uint64_t hash_ = 0;        // of the input lines
+    std::uintmax_t bytes_ = 0;      // of the result file
+};
+
+// Inputs of a run, other than its contracts, on which its results depend
+struct RunInputs
+{
+    std::string valuationDate_ = valuationDate();    // from which the times to expiry of dates are measured
+    std::optional<std::filesystem::path> surfaces_;  // volatility surface file
+    std::optional<std::filesystem::path> curves_;    // discount curve file
+    std::optional<std::filesystem::path> dividends_; // dividend schedule file
+};
+
+// Results of a run, written to a directory as a file per chunk of input, with a
+// manifest of the chunks committed so far. Each chunk is written to a pending file,
+// synced, then renamed in place, and only then recorded, so that a run killed, or
+// failing on a row, leaves only whole chunks behind. A rerun of the same input and
+// settings finds those chunks complete, and prices only the rest. Settings include
+// the valuation date, and hashes of the surface, curve and dividend files, as results priced
+// from others would differ. The manifest is itself replaced by rename, so is never
+// seen part written.
+class Checkpoint
+{
+public:
+    using File = std::unique_ptr<std::FILE, decltype(&std::fclose)>;
+
+    Checkpoint() = delete;
+    Checkpoint(std::filesystem::path directory, std::size_t chunkLines, Format format, OutputMask outputs,
+               const RunInputs &inputs = {})
+        : directory_(std::move(directory))
+        , chunkLines_(chunkLines)
+        , extension_((format == Format::NDJSON) ? ".ndjson" : ".out")
+    {
+        if (chunkLines_ == 0) {
+            throw std::runtime_error("Checkpoint chunks must be of at least one line");
+        }
+        settings_ = fmt::format("bsm-checkpoint 3\nchunk_lines {}\nformat {}\noutputs ",
+                                chunkLines_, (format == Format::NDJSON) ? "ndjson" : "csv");
+        std::string_view delim = "";
+        for (std::size_t index = 0; index < NUM_OUTPUTS; ++index) {
+            if (outputs.contains(static_cast<Output>(index))) {
+                settings_ += delim;
+                settings_ += outputName(static_cast<Output>(index));
+                delim = ",";
+            }
+        }
+        settings_ += fmt::format("\nvaluation_date {}\nsurfaces {}\ncurves {}\ndividends {}\n", inputs.valuationDate_,
+                                 fileHash(inputs.surfaces_), fileHash(inputs.curves_), fileHash(inputs.dividends_));
+
+        std::error_code error;
+        std::filesystem::create_directories(directory_, error);
+        if (error) {
+            throw std::runtime_error("Cannot create checkpoint directory: " + directory_.string());
+        }
+        load();
+    }
+
+    auto chunkLines() const -> std::size_t { return chunkLines_; }
+
+    auto resultPath(std::size_t index) const -> std::filesystem::path {
+        return directory_ / fmt::format("chunk-{:06}{}", index, extension_);
+    }
+
+    // Chunk committed by an earlier run, whose result file is intact, or null
+    auto completed(std::size_t index) const -> const Chunk* {
+        const auto found = chunks_.find(index);
+        if (found == chunks_.end()) {
+            return nullptr;
+        }
+        std::error_code error;
+        const auto bytes = std::filesystem::file_size(resultPath(index), error);
+        return (!error && bytes == found->second.bytes_) ? &found->second : nullptr;
+    }
+
+    // Chunks in all, once a run has read its input to the end
+    auto chunks() const -> std::optional<std::size_t> { return total_; }
+
+    // Pending result file of a chunk, replacing any left by a failed run
+    auto open(std::size_t index) const -> File {
+        File file(std::fopen(pendingPath(index).c_str(), "wb"), &std::fclose);
+        if (!file) {
+            throw std::runtime_error("Cannot write checkpoint chunk: " + pendingPath(index).string());
+        }
+        return file;
+    }
+
+    // Sync the pending result file of a chunk, rename it in place, and record the chunk
+    void commit(std::size_t index, File file, Chunk chunk) {
+        if (std::fflush(file.get()) != 0 || ::fsync(::fileno(file.get())) != 0) {
+            throw std::runtime_error("Cannot write checkpoint chunk: " + pendingPath(index).string());
+        }
+        file.reset();
+        replace(pendingPath(index), resultPath(index));
+        chunk.bytes_ = std::filesystem::file_size(resultPath(index));
+        chunks_[index] = chunk;
+        save();
+    }
+
+    // Record that the input ended after the given number of chunks
+    void finish(std::size_t chunks) {
+        total_ = chunks;
+        save();
+    }
+
+private:
+    auto pendingPath(std::size_t index) const -> std::filesystem::path {
+        auto path = resultPath(index);
+        path += ".pending";
+        return path;
+    }
+
+    auto manifestPath() const -> std::filesystem::path { return directory_ / "manifest"; }
+
+    // Hash of the lines of an input file, or 'none' without one
+    static auto fileHash(const std::optional<std::filesystem::path> &path) -> std::string {
+        if (!path) {
+            return "none";
+        }
+        std::ifstream file(path.value());
+        if (!file) {
+            throw std::runtime_error("Cannot open checkpointed input: " + path->string());
+        }
+        LineHash hash;
+        for (std::string line; std::getline(file, line);) {
+            hash.add(line);
+        }
+        return fmt::format("{:016x}", hash.value());
+    }
+
+    // Name of the first setting of the manifest that differs from ours
+    auto differing(std::string_view text) const -> std::string {
+        for (std::string_view settings = settings_; !settings.empty();) {
+            const auto line = settings.substr(0, settings.find('\n') + 1);
+            if (!text.starts_with(line)) {
+                auto name = std::string(line.substr(0, line.find(' ')));
+                if (name == "bsm-checkpoint") {
+                    return "checkpoint version";
+                }
+                std::replace(name.begin(), name.end(), '_', ' ');
+                return name;
+            }
+            settings.remove_prefix(line.size());
+            text.remove_prefix(line.size());
+        }
+        return "settings";
+    }
+
+    // Rename a synced file in place, syncing the directory so that the rename is durable
+    void replace(const std::filesystem::path &from, const std::filesystem::path &to) const {
+        std::error_code error;
+        std::filesystem::rename(from, to, error);
+        if (error) {
+            throw std::runtime_error("Cannot commit checkpoint file: " + to.string());
+        }
+        const auto directory = ::open(directory_.c_str(), O_RDONLY | O_DIRECTORY);
+        if (directory >= 0) {
+            ::fsync(directory);
+            ::close(directory);
+        }
+    }
+
+    // Chunks of the manifest, as of the settings of this run, if any. The manifest
+    // of a run of other settings is rejected, rather than its chunks mixed with ours.
+    void load() {
+        std::ifstream file(manifestPath());
+        if (!file) {
+            return;
+        }
+        std::stringstream contents;
+        contents << file.rdbuf();
+        const auto text = contents.str();
+        if (!text.starts_with(settings_)) {
+            throw std::runtime_error("Checkpoint directory " + directory_.string() + " was written with other "
+                                     + differing(text) + ", so cannot be resumed");
+        }
+
+        std::istringstream lines(text.substr(settings_.size()));
+        std::string kind;
+        while (lines >> kind) {
+            if (kind == "chunk") {
+                std::size_t index = 0;
+                Chunk chunk;
+                lines >> index >> chunk.lines_ >> chunk.contracts_ >> std::hex >> chunk.hash_ >> std::dec >> chunk.bytes_;
+                if (lines) {
+                    chunks_[index] = chunk;
+                }
+            }
+            else if (kind == "chunks") {
+                std::size_t chunks = 0;
+                if (lines >> chunks) {
+                    total_ = chunks;
+                }
+            }
+            else {
+                throw std::runtime_error("Invalid checkpoint manifest: " + manifestPath().string());
+            }
+        }
+    }
+
+    void save() const {
+        std::string text = settings_;
+        for (const auto &[index, chunk] : chunks_) {
+            text += fmt::format("chunk {} {} {} {:016x} {}\n", index, chunk.lines_, chunk.contracts_, chunk.hash_, chunk.bytes_);
+        }
+        if (total_) {
+            text += fmt::format("chunks {}\n", total_.value());
+        }
+
+        auto pending = manifestPath();
+        pending += ".pending";
+        {
+            const File file(std::fopen(pending.c_str(), "wb"), &std::fclose);
+            if (!file || std::fwrite(text.data(), sizeof(char), text.size(), file.get()) != text.size()
+                || std::fflush(file.get()) != 0 || ::fsync(::fileno(file.get())) != 0) {
+                throw std::runtime_error("Cannot write checkpoint manifest: " + pending.string());
+            }
+        }
+        replace(pending, manifestPath());
+    }
+
+    std::filesystem::path directory_;
+    std::size_t chunkLines_;
+    std::string_view extension_;
+    std::string settings_;                  // leading lines of the manifest, by which runs must agree
+    std::map<std::size_t, Chunk> chunks_;   // committed, by index
+    std::optional<std::size_t> total_;
+};
+
+} // bsm
+
+#endif
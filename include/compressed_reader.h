@@ -0,0 +1,135 @@
+#ifndef COMPRESSED_READER_H
+#define COMPRESSED_READER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "huge_pages.h"
+
+namespace bsm
+{
+
+enum class Compression
+{
+    None,
+    Gzip,
+    Zstd,
+};
+
+// Compression of a stream, by the first byte of its magic number, which is left
+// unread. Neither is a byte a CSV or NDJSON line would begin with.
+inline auto detectCompression(std::FILE *file) -> Compression {
+    const auto first = std::getc(file);
+    if (first == EOF) {
+        return Compression::None;
+    }
+    std::ungetc(first, file);
+    switch (first) {
+    case 0x1F: return Compression::Gzip;  // 1F 8B
+    case 0x28: return Compression::Zstd;  // 28 B5 2F FD
+    default:   return Compression::None;
+    }
+}
+
+// Whether this build of libbsm can decompress the given compression, as
+// gzip requires zlib, and zstd requires libzstd, when built
+auto compressionSupported(Compression compression) -> bool;
+
+// Lines of a gzip or zstd compressed stream, decompressed ahead of the reader on
+// threads of its own, so that decompression overlaps parsing and pricing.
+// Decompressed blocks are queued in order, at most QUEUED_BLOCKS ahead of the
+// reader, and their buffers reused once read.
+//
+// Concatenated gzip members, and zstd frames, are read in turn by a single
+// thread. Regular zstd files of several frames, each of known size, as written
+// by 'pzstd' or 'zstd -T<n> --block-size', are instead read whole, and their
+// frames decompressed in parallel, a frame at a time per thread.
+class CompressedReader
+{
+public:
+    static constexpr const std::size_t BLOCK_SIZE = std::size_t{1} << 20;
+    static constexpr const std::size_t READ_SIZE = std::size_t{1} << 20;
+    static constexpr const std::size_t QUEUED_BLOCKS = 8;
+    static constexpr const std::size_t MAX_FRAME_SIZE = std::size_t{64} << 20; // largest frame decompressed whole
+
+    CompressedReader() = delete;
+    CompressedReader(std::FILE *file, Compression compression, std::size_t threads = 1);
+    ~CompressedReader();
+
+    CompressedReader(const CompressedReader &) = delete;
+    auto operator=(const CompressedReader &) -> CompressedReader& = delete;
+
+    // Next line, without its newline, valid until the next call. Errors of
+    // decompression are thrown once all lines before them are read.
+    auto next() -> std::optional<std::string_view>;
+
+    // Threads decompressing, more than one only for multiple frame zstd files
+    auto threads() const -> std::size_t { return workers_.size(); }
+
+private:
+    // Reads up to the given number of bytes of compressed input, returning 0 at its end
+    using Source = std::function<std::size_t(void *data, std::size_t size)>;
+
+    struct Slot
+    {
+        std::vector<char> data_;
+        bool ready_ = false;
+    };
+
+    struct Frame
+    {
+        std::size_t offset_;
+        std::size_t size_;      // compressed
+        std::size_t content_;   // decompressed
+    };
+
+    // Buffer of the given block to decompress into, once within the queue, or null when stopping
+    auto acquire(std::size_t sequence) -> std::vector<char>*;
+    void publish(std::size_t sequence);
+    void finish(std::size_t blocks);
+    void fail(std::exception_ptr error, std::size_t sequence);
+    auto take() -> bool;
+
+    // Run a decompression thread, reporting its errors to the reader, as of the
+    // block the thread was decompressing into
+    void run(const std::function<void(std::size_t &sequence)> &decompress);
+
+    void inflateStream(const Source &source, std::size_t &sequence);
+    void zstdStream(const Source &source, std::size_t &sequence);
+    void zstdFrames(std::size_t &sequence);
+    auto indexFrames() -> bool;
+
+    std::vector<Slot> slots_;       // by block, modulo QUEUED_BLOCKS
+    std::vector<char> current_;     // block being read
+    std::size_t position_ = 0;      // of the next line, in the current block
+    std::string line_;              // line spanning blocks
+
+    PageBuffer input_;              // whole compressed input, where read by frame
+    std::vector<Frame> frames_;
+    std::atomic<std::size_t> nextFrame_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable produced_;
+    std::condition_variable consumed_;
+    std::size_t read_ = 0;          // blocks taken by the reader
+    std::size_t blocks_ = SIZE_MAX; // blocks in all, once known
+    std::exception_ptr error_;
+    std::size_t failed_ = SIZE_MAX; // block whose decompression failed, of the earliest error
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+} // bsm
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef DISCOUNT_CURVE_H
+#define DISCOUNT_CURVE_H
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bsm
+{
+
+// Curve id of rows discounted at their own flat rate
+static constexpr const std::uint32_t NO_CURVE = std::numeric_limits<std::uint32_t>::max();
+
+// Curves are indexed densely by id, so ids are bounded
+static constexpr const std::uint32_t MAX_CURVE_ID = 65535;
+
+// Discount factor to an expiry, and the continuously compounded zero rate implying it
+template <typename value_type = double>
+struct Discount
+{
+    value_type factor_;
+    value_type rate_;
+};
+
+// Term structure of risk free interest, interpolated log-linearly on discount factors,
+// i.e. with piecewise flat forward rates between nodes. The curve starts from a discount
+// factor of one today, and the last forward rate is extrapolated beyond its final node.
+template <typename value_type = double>
+class DiscountCurve
+{
+public:
+    DiscountCurve() = default;
+    explicit DiscountCurve(std::vector<value_type> times, const std::vector<value_type> &discounts)
+        : times_(std::move(times))
+    {
+        if (times_.empty() || times_.size() != discounts.size()) {
+            throw std::runtime_error("Discount curve requires a discount factor for every node");
+        }
+        logDiscounts_.reserve(discounts.size());
+        for (std::size_t i = 0; i < times_.size(); ++i) {
+            if (times_[i] <= 0 || (i > 0 && !(times_[i] > times_[i - 1]))) {
+                throw std::runtime_error("Discount curve times must be positive and strictly increasing");
+            }
+            if (discounts[i] <= 0) {
+                throw std::runtime_error("Discount factors must be greater than zero");
+            }
+            logDiscounts_.push_back(std::log(discounts[i]));
+        }
+    }
+
+    static auto fromZeroRates(const std::vector<value_type> &times, const std::vector<value_type> &rates) -> DiscountCurve {
+        if (times.size() != rates.size()) {
+            throw std::runtime_error("Discount curve requires a zero rate for every node");
+        }
+        std::vector<value_type> discounts(times.size());
+        for (std::size_t i = 0; i < times.size(); ++i) {
+            discounts[i] = std::exp(-rates[i] * times[i]);
+        }
+        return DiscountCurve(times, discounts);
+    }
+
+    auto empty() const -> bool { return times_.empty(); }
+
+    auto discount(const value_type time) const -> value_type {
+        return std::exp(logDiscount(time));
+    }
+
+    // Continuously compounded zero rate to the given time, or the
+    // first forward rate at the start of the curve
+    auto zeroRate(const value_type time) const -> value_type {
+        if (time <= 0) {
+            return -logDiscounts_.front() / times_.front();
+        }
+        return -logDiscount(time) / time;
+    }
+
+    // Continuously compounded forward rate between two times
+    auto forwardRate(const value_type start, const value_type end) const -> value_type {
+        if (!(end > start)) {
+            throw std::runtime_error("Forward rate requires an end after its start");
+        }
+        return (logDiscount(start) - logDiscount(end)) / (end - start);
+    }
+
+    auto operator()(const value_type time) const -> Discount<value_type> {
+        const auto log = logDiscount(time);
+        const auto rate = (time > 0) ? -log / time : zeroRate(0);
+        return { std::exp(log), rate };
+    }
+
+private:
+    auto logDiscount(const value_type time) const -> value_type {
+        if (time <= 0) {
+            return 0;
+        }
+        const auto next = static_cast<std::size_t>(std::upper_bound(times_.begin(), times_.end(), time) - times_.begin());
+        // Extrapolate the last segment's forward rate beyond the final node
+        const auto i = std::min(next, times_.size() - 1);
+        const auto t0 = (i == 0) ? value_type{0} : times_[i - 1];
+        const auto l0 = (i == 0) ? value_type{0} : logDiscounts_[i - 1];
+        const auto t1 = times_[i];
+        const auto l1 = logDiscounts_[i];
+        return l0 + ((l1 - l0) * (time - t0) / (t1 - t0));
+    }
+
+    std::vector<value_type> times_;
+    std::vector<value_type> logDiscounts_;
+};
+
+// Discounts of a curve, memoized by expiry, so that contracts sharing an expiry
+// share a single interpolation and exponential. Not thread safe, so held per pricer.
+template <typename value_type = double>
+class DiscountCache
+{
+public:
+    explicit DiscountCache(const DiscountCurve<value_type> &curve)
+        : curve_(&curve)
+    {}
+
+    auto operator()(const value_type expiry) -> const Discount<value_type>& {
+        const auto found = cache_.find(expiry);
+        if (found != cache_.end()) {
+            return found->second;
+        }
+        return cache_.emplace(expiry, (*curve_)(expiry)).first->second;
+    }
+
+    // Discount to an expiry, as cached, else derived without caching it, so that
+    // a cache filled ahead of a parallel loop may be read by all of its threads
+    auto cached(const value_type expiry) const -> Discount<value_type> {
+        const auto found = cache_.find(expiry);
+        return (found != cache_.end()) ? found->second : (*curve_)(expiry);
+    }
+
+    auto size() const -> std::size_t { return cache_.size(); }
+
+private:
+    const DiscountCurve<value_type> *curve_;
+    std::unordered_map<value_type, Discount<value_type>> cache_;
+};
+
+// Read curves from CSV rows of 'curve_id,time,discount_factor', e.g. as given by
+// '--curves'. Curves are returned indexed by id.
+template <typename value_type = double>
+auto readCurves(std::istream &input) -> std::vector<DiscountCurve<value_type>> {
+    std::map<std::uint32_t, std::map<value_type, value_type>> nodes;
+
+    const auto parse = [](std::string_view field, auto &value) {
+        const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (error != std::errc() || end != field.data() + field.size()) {
+            throw std::runtime_error("Cannot parse discount curve field: " + std::string(field));
+        }
+    };
+
+    for (std::string line; std::getline(input, line); ) {
+        if (line.empty() || line.starts_with("curve_id")) {
+            continue;
+        }
+        std::string_view fields[3];
+        std::string_view rest = line;
+        for (auto &field : fields) {
+            const auto pos = rest.find(',');
+            field = rest.substr(0, pos);
+            rest.remove_prefix((pos == std::string_view::npos) ? rest.size() : pos + 1);
+        }
+
+        std::uint32_t id = 0;
+        value_type time = 0, discount = 0;
+        parse(fields[0], id);
+        if (id > MAX_CURVE_ID) {
+            throw std::runtime_error("Discount curve id cannot be greater than " + std::to_string(MAX_CURVE_ID)
+                                     + ": " + std::string(fields[0]));
+        }
+        parse(fields[1], time);
+        parse(fields[2], discount);
+        nodes[id][time] = discount;
+    }
+
+    std::vector<DiscountCurve<value_type>> curves(nodes.empty() ? 0 : std::size_t{nodes.rbegin()->first} + 1);
+    for (const auto &[id, curve] : nodes) {
+        std::vector<value_type> times, discounts;
+        for (const auto &[time, discount] : curve) {
+            times.push_back(time);
+            discounts.push_back(discount);
+        }
+        curves[id] = DiscountCurve<value_type>(std::move(times), discounts);
+    }
+    return curves;
+}
+
+} // bsm
+
+#endif
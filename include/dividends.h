@@ -0,0 +1,147 @@
+#ifndef DIVIDENDS_H
+#define DIVIDENDS_H
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "constants.h"
+
+namespace bsm
+{
+
+static constexpr const std::uint32_t MAX_SCHEDULE_ID = 65535; // underlying id of a dividend schedule
+
+template <typename value_type = double>
+struct CashDividend
+{
+    value_type time_   = 0.0; // time to ex-dividend date, in years
+    value_type amount_ = 0.0; // cash amount paid per unit of underlying
+};
+
+// Schedule of discrete cash dividends paid by a single underlying.
+// Priced under the escrowed dividend model, i.e. the spot price is reduced by
+// the present value of all dividends going ex before expiry.
+// Discounted cumulative sums are precomputed once per underlying at construction,
+// so adjusting each contract across its chain costs a single binary search.
+// Every dividend is thereby discounted at the single rate given at construction,
+// rather than at the rate, or curve, of each contract priced against the schedule.
+template <typename value_type = double>
+class DividendSchedule
+{
+public:
+    DividendSchedule() = default;
+    explicit DividendSchedule(std::vector<CashDividend<value_type>> dividends, value_type rate) {
+        std::sort(dividends.begin(), dividends.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.time_ < rhs.time_;
+        });
+
+        times_.reserve(dividends.size());
+        cumulative_.reserve(dividends.size());
+
+        value_type presentValue = 0.0;
+        for (const auto &dividend : dividends) {
+            validate(dividend);
+            presentValue += dividend.amount_ * std::exp(-rate * dividend.time_);
+            times_.push_back(dividend.time_);
+            cumulative_.push_back(presentValue);
+        }
+    }
+
+    // Present value of all dividends going ex strictly before expiry
+    constexpr auto presentValue(const value_type expiry) const -> value_type {
+        const auto paid = std::lower_bound(times_.begin(), times_.end(), expiry) - times_.begin();
+        return (paid > 0) ? cumulative_[paid - 1] : 0.0;
+    }
+
+    constexpr auto adjustedSpot(const value_type spot, const value_type expiry) const -> value_type {
+        const auto adjusted = spot - presentValue(expiry);
+        if (adjusted <= MIN_PRICE) {
+            throw std::runtime_error("Dividends paid before expiry cannot exceed the underlying price");
+        }
+        return adjusted;
+    }
+
+    auto empty() const -> bool { return times_.empty(); }
+
+private:
+    constexpr void validate(const CashDividend<value_type> &dividend) const {
+        if (dividend.time_ < 0) {
+            throw std::runtime_error("Dividend ex-date cannot be in the past");
+        }
+        if (dividend.amount_ < MIN_PRICE) {
+            throw std::runtime_error("Dividend amount cannot be less than zero");
+        }
+    }
+
+    std::vector<value_type> times_;      // ex-dividend times, ascending
+    std::vector<value_type> cumulative_; // running present value of dividends up to each ex-date
+};
+
+// Read schedules from CSV rows of 'underlying_id,time,amount[,rate]', e.g. as given by
+// '--dividends', discounting each underlying's dividends at its rate, or by default
+// INTEREST. Schedules are returned indexed by underlying id.
+template <typename value_type = double>
+auto readDividends(std::istream &input) -> std::vector<DividendSchedule<value_type>> {
+    std::map<std::uint32_t, std::pair<std::vector<CashDividend<value_type>>, std::optional<value_type>>> schedules;
+
+    const auto parse = [](std::string_view field, auto &value) {
+        const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (error != std::errc() || end != field.data() + field.size()) {
+            throw std::runtime_error("Cannot parse dividend field: " + std::string(field));
+        }
+    };
+
+    for (std::string line; std::getline(input, line); ) {
+        if (line.empty() || line.starts_with("underlying_id")) {
+            continue;
+        }
+        std::string_view fields[4];
+        std::string_view rest = line;
+        for (auto &field : fields) {
+            const auto pos = rest.find(',');
+            field = rest.substr(0, pos);
+            rest.remove_prefix((pos == std::string_view::npos) ? rest.size() : pos + 1);
+        }
+
+        std::uint32_t id = 0;
+        CashDividend<value_type> dividend;
+        parse(fields[0], id);
+        if (id > MAX_SCHEDULE_ID) {
+            throw std::runtime_error("Dividend underlying id cannot be greater than " + std::to_string(MAX_SCHEDULE_ID)
+                                     + ": " + std::string(fields[0]));
+        }
+        parse(fields[1], dividend.time_);
+        parse(fields[2], dividend.amount_);
+
+        auto &[dividends, rate] = schedules[id];
+        dividends.push_back(dividend);
+        if (!fields[3].empty()) {
+            value_type given = 0;
+            parse(fields[3], given);
+            if (rate && rate.value() != given) {
+                throw std::runtime_error("Dividends of underlying " + std::to_string(id) + " must share a single rate");
+            }
+            rate = given;
+        }
+    }
+
+    std::vector<DividendSchedule<value_type>> result(schedules.empty() ? 0 : std::size_t{schedules.rbegin()->first} + 1);
+    for (auto &[id, schedule] : schedules) {
+        auto &[dividends, rate] = schedule;
+        result[id] = DividendSchedule<value_type>(std::move(dividends), rate.value_or(INTEREST));
+    }
+    return result;
+}
+
+} // bsm
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef FINITE_DIFFERENCE_H
+#define FINITE_DIFFERENCE_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "constants.h"
+#include "options.h"
+#include "outputs.h"
+#include "thread_pool.h"
+
+namespace bsm
+{
+
+// Size of the bump applied to each input when repricing
+template <typename value_type = double>
+struct Bumps
+{
+    value_type spot_       = 1E-3; // relative to the underlying price
+    value_type volatility_ = 1E-4; // absolute
+    value_type time_       = 1E-4; // absolute, in years
+    value_type rate_       = 1E-4; // absolute
+};
+
+// Greek of a contract for which analytic and numeric values diverge
+template <typename value_type = double>
+struct Divergence
+{
+    std::size_t row_;
+    Output output_;
+    value_type analytic_;
+    value_type numeric_;
+};
+
+// Derives first order greeks numerically, by central differences of Black Scholes
+// prices over bumped inputs, as an independent check on the analytic greeks.
+// Bumped scenarios for each chunk of contracts are priced together in a single
+// batch pass, and chunks are priced in parallel across the thread pool.
+// Volatilities of rows referencing a surface, and zero rates of rows referencing
+// a curve, are looked up before bumping, as by the batch pricer, and then held, as
+// by the analytic greeks, while the other inputs are bumped. The discount factor of
+// each scenario follows from its rate. Dividend schedules are applied to each
+// scenario's spot.
+template <typename value_type = double>
+class FiniteDifference
+{
+public:
+    FiniteDifference() = delete;
+    explicit FiniteDifference(ThreadPool &pool, const MarketData<value_type> market = {}, const Bumps<value_type> bumps = {})
+        : pool_(pool)
+        , market_(market)
+        , bumps_(bumps)
+    {}
+
+    void operator()(const OptionBatch<value_type> &batch, BatchResults<value_type> &results) const {
+        results.resize(batch.size(), OutputMask::firstOrder());
+
+        pool_.parallelFor(batch.size(), CHUNK_SIZE, [&](std::size_t begin, std::size_t end) {
+            OptionBatch<value_type> scenarios;
+            BatchResults<value_type> priced;
+            BatchPricer<value_type> pricer(OutputMask { Output::Price }, MarketData<value_type> { market_.dividends_ });
+            std::vector<Steps> steps(end - begin);
+
+            scenarios.reserve((end - begin) * NUM_SCENARIOS);
+            for (std::size_t row = begin; row < end; ++row) {
+                steps[row - begin] = bump(batch, row, scenarios);
+            }
+
+            pricer(scenarios, priced);
+
+            for (std::size_t row = begin; row < end; ++row) {
+                differentiate(&priced.price_[(row - begin) * NUM_SCENARIOS], steps[row - begin], row, results);
+            }
+        });
+    }
+
+    // Compare analytic greeks against numeric greeks, returning those which differ by
+    // more than the tolerance, relative to the analytic value (or absolute, below one).
+    static auto compare(const BatchResults<value_type> &analytic,
+                        const BatchResults<value_type> &numeric,
+                        const value_type tolerance) -> std::vector<Divergence<value_type>> {
+        std::vector<Divergence<value_type>> divergences;
+        for (const auto output : { Output::Delta, Output::Gamma, Output::Theta, Output::Vega, Output::Rho }) {
+            const auto &lhs = analytic.column(output);
+            const auto &rhs = numeric.column(output);
+            for (std::size_t row = 0; row < std::min(lhs.size(), rhs.size()); ++row) {
+                const auto scale = std::max<value_type>(1, std::fabs(lhs[row]));
+                if (!(std::fabs(lhs[row] - rhs[row]) <= tolerance * scale)) {
+                    divergences.push_back({ row, output, lhs[row], rhs[row] });
+                }
+            }
+        }
+        std::stable_sort(divergences.begin(), divergences.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.row_ < rhs.row_;
+        });
+        return divergences;
+    }
+
+private:
+    // Order of bumped scenarios priced for each contract
+    enum Scenario : std::size_t { Base, SpotUp, SpotDown, VolUp, VolDown, TimeUp, TimeDown, RateUp, RateDown, NUM_SCENARIOS };
+
+    // Up and down step sizes of each bumped input. Steps are truncated to half the
+    // distance to a bound where they would take an input outside of its valid range,
+    // so that inputs at a bound are differenced one sided, away from it.
+    struct Steps
+    {
+        value_type spotUp_, spotDown_;
+        value_type volUp_, volDown_;
+        value_type timeUp_, timeDown_;
+        value_type rateUp_, rateDown_;
+    };
+
+    // Volatility of the row as priced, looked up at the dividend adjusted spot where of a surface
+    auto volatility(const OptionBatch<value_type> &batch, std::size_t row) const -> value_type {
+        const auto surface = batch.surface_[row];
+        if (surface == NO_SURFACE) {
+            return batch.volatility_[row];
+        }
+        if (surface >= market_.surfaces_.size() || market_.surfaces_[surface].empty()) {
+            throw std::runtime_error("Cannot find volatility surface " + std::to_string(surface));
+        }
+        const auto underlying = batch.underlying_[row];
+        const auto time = batch.timeToExpiry_[row];
+        auto spot = batch.underlyingPrice_[row];
+        if (underlying < market_.dividends_.size() && !market_.dividends_[underlying].empty()) {
+            spot = market_.dividends_[underlying].adjustedSpot(spot, time);
+        }
+        return market_.surfaces_[surface].volatility(spot, batch.strikePrice_[row], time);
+    }
+
+    // Zero rate of the row as priced, to its expiry where of a curve
+    auto rate(const OptionBatch<value_type> &batch, std::size_t row) const -> value_type {
+        const auto curve = batch.curve_[row];
+        if (curve == NO_CURVE) {
+            return batch.riskFreeInterest_[row];
+        }
+        if (curve >= market_.curves_.size() || market_.curves_[curve].empty()) {
+            throw std::runtime_error("Cannot find discount curve " + std::to_string(curve));
+        }
+        return market_.curves_[curve](batch.timeToExpiry_[row]).rate_;
+    }
+
+    auto bump(const OptionBatch<value_type> &batch, std::size_t row, OptionBatch<value_type> &scenarios) const -> Steps {
+        const auto type = batch.type_[row];
+        const auto underlying = batch.underlying_[row];
+        const auto spot = batch.underlyingPrice_[row];
+        const auto strike = batch.strikePrice_[row];
+        const auto time = batch.timeToExpiry_[row];
+        const auto vol = volatility(batch, row);
+        const auto rate = this->rate(batch, row);
+        const auto yield = batch.dividendYield_[row];
+
+        const Steps steps {
+            std::min(spot * bumps_.spot_, (MAX_PRICE - spot) / 2), spot * bumps_.spot_,
+            std::min(bumps_.volatility_, (MAX_PC - vol) / 2), std::min(bumps_.volatility_, vol / 2),
+            std::min(bumps_.time_, (MAX_EXPIRY / DAY_TO_YEAR - time) / 2), std::min(bumps_.time_, time / 2),
+            std::min(bumps_.rate_, (MAX_PC - rate) / 2), std::min(bumps_.rate_, rate - MIN_PC),
+        };
+
+        const auto push = [&](value_type s, value_type t, value_type v, value_type r) {
+            scenarios.push(type, OptionValues<value_type> { s, strike, t, v, r, yield }, underlying);
+        };
+        push(spot,                time,                  vol,                  rate);
+        push(spot + steps.spotUp_, time,                 vol,                  rate);
+        push(spot - steps.spotDown_, time,               vol,                  rate);
+        push(spot,                time,                  vol + steps.volUp_,   rate);
+        push(spot,                time,                  vol - steps.volDown_, rate);
+        push(spot,                time + steps.timeUp_,  vol,                  rate);
+        push(spot,                time - steps.timeDown_, vol,                 rate);
+        push(spot,                time,                  vol,                  rate + steps.rateUp_);
+        push(spot,                time,                  vol,                  rate - steps.rateDown_);
+        return steps;
+    }
+
+    static void differentiate(const value_type *prices, const Steps &steps, std::size_t row, BatchResults<value_type> &results) {
+        const auto difference = [&](Scenario up, Scenario down, value_type upStep, value_type downStep) {
+            return (prices[up] - prices[down]) / (upStep + downStep);
+        };
+
+        results.price_[row] = prices[Base];
+        // Second difference over steps of the spot which may be unequal, near its upper bound
+        const auto up = steps.spotUp_, down = steps.spotDown_;
+        results.delta_[row] = difference(SpotUp, SpotDown, up, down);
+        results.gamma_[row] = 2 * ((prices[SpotUp] * down) - (prices[Base] * (up + down)) + (prices[SpotDown] * up))
+                            / (up * down * (up + down));
+        results.vega_[row]  = difference(VolUp, VolDown, steps.volUp_, steps.volDown_);
+        results.theta_[row] = -difference(TimeUp, TimeDown, steps.timeUp_, steps.timeDown_);
+        results.rho_[row]   = difference(RateUp, RateDown, steps.rateUp_, steps.rateDown_);
+    }
+
+    ThreadPool &pool_;
+    MarketData<value_type> market_;
+    Bumps<value_type> bumps_;
+};
+
+} // bsm
+
+#endif
@@ -3,10 +3,10 @@
 
 #include "black_scholes.h"
 #include "constants.h"
+#include "outputs.h"
 #include <cmath>
 #include <stdexcept>
-
-#include <iostream>
+#include <type_traits>
 
 namespace bsm
 {
@@ -15,12 +15,25 @@ namespace bsm
 struct CallExecutor;
 struct PutExecutor;
 
+// Executor placeholder, for which the terms of both calls and puts are derived
+struct AnyExecutor {};
+
 template <typename value_type>
 class Greeks
 {
 public:
     explicit Greeks(const OptionValues<value_type> &values,
                     const BlackScholes<value_type> &bsm)
+        : Greeks(values, bsm, OutputMask::all(), AnyExecutor{})
+    {}
+
+    // Only the terms required by the selected outputs, for the given executor,
+    // are derived. Greeks outside of the selected outputs must not be called.
+    template <typename Executor>
+    explicit Greeks(const OptionValues<value_type> &values,
+                    const BlackScholes<value_type> &bsm,
+                    const OutputMask outputs,
+                    Executor /*executor*/)
         : values_(values)
         , bsm_(bsm)
         , spot_(values_.underlyingPrice_) // ref. aliased for readability below
@@ -28,12 +41,13 @@ public:
 
         // Memoize common derived terms as members below, for performance and
         // readability in calculations below.
-        , d1_(bsm_.d1(values_))
-        , probabilityExercised_(bsm_.cumulNormalDist(d1_))
-        , probabilityExpires_(bsm_.cumulNormalDist(-d1_))
-        , probabilityReturns_(bsm_.cumulNormalDist(d1_ - (values_.volatility_ * values_.sqrtime_)))
-        , probabilityCost_(bsm_.cumulNormalDist(-d1_ + (values_.volatility_ * values_.sqrtime_)))
-        , nd1_(standardNormalDensity(d1_))
+        , d1_(outputs.intersects(D1_OUTPUTS) ? bsm_.d1(values_) : 0)
+        , d2_(outputs.intersects(D2_OUTPUTS) ? d1_ - (values_.volatility_ * values_.sqrtime_) : 0)
+        , probabilityExercised_(derives<Executor, CallExecutor>(outputs, EXERCISE_OUTPUTS) ? bsm_.cumulNormalDist(d1_) : 0)
+        , probabilityExpires_(derives<Executor, PutExecutor>(outputs, EXERCISE_OUTPUTS) ? bsm_.cumulNormalDist(-d1_) : 0)
+        , probabilityReturns_(derives<Executor, CallExecutor>(outputs, RETURNS_OUTPUTS) ? bsm_.cumulNormalDist(d2_) : 0)
+        , probabilityCost_(derives<Executor, PutExecutor>(outputs, RETURNS_OUTPUTS) ? bsm_.cumulNormalDist(-d2_) : 0)
+        , nd1_(outputs.intersects(DENSITY_OUTPUTS) ? standardNormalDensity(d1_) : 0)
     {}
 
     template <typename Executor>
@@ -52,7 +66,7 @@ public:
     // Gamma declaration - no specialisations as this reduces to
     // the same formula for both call and puts
     constexpr auto gamma() -> value_type {
-        const auto returns = strike_ * values_.volatility_ * values_.sqrtime_;
+        const auto returns = spot_ * values_.volatility_ * values_.sqrtime_;
         return (values_.dividendDiscount_ / returns) * nd1_;
     }
 
@@ -85,11 +99,11 @@ public:
     template <typename Executor>
     constexpr auto rho() {
         if constexpr (std::is_same_v<CallExecutor, Executor>) {
-            const auto cost = strike_ * values_.interestDiscount_;
+            const auto cost = strike_ * values_.timeToExpiry_ * values_.interestDiscount_;
             return cost * probabilityReturns_;
         }
         else if constexpr (std::is_same_v<PutExecutor, Executor>) {
-            const auto cost = (-strike_) * values_.interestDiscount_;
+            const auto cost = (-strike_) * values_.timeToExpiry_ * values_.interestDiscount_;
             return cost * probabilityCost_;
         }
         else {
@@ -97,7 +111,88 @@ public:
         }
     }
 
+    // Higher order greeks
+
+    // Vanna declaration - sensitivity of delta to volatility,
+    // reduces to the same formula for both call and puts
+    constexpr auto vanna() -> value_type {
+        return -values_.dividendDiscount_ * nd1_ * d2_ / values_.volatility_;
+    }
+
+    // Volga (vomma) declaration - sensitivity of vega to volatility,
+    // reduces to the same formula for both call and puts
+    constexpr auto volga() -> value_type {
+        return vega() * d1_ * d2_ / values_.volatility_;
+    }
+
+    // Charm declaration - decay of delta over calendar time
+    template <typename Executor>
+    constexpr auto charm() {
+        const auto decay = values_.dividendDiscount_ * nd1_ * driftRatio();
+
+        if constexpr (std::is_same_v<CallExecutor, Executor>) {
+            return values_.dividendYield_ * values_.dividendDiscount_ * probabilityExercised_ - decay;
+        }
+        else if constexpr (std::is_same_v<PutExecutor, Executor>) {
+            return -values_.dividendYield_ * values_.dividendDiscount_ * probabilityExpires_ - decay;
+        }
+        else {
+            throw std::runtime_error("Cannot derive charm of unknown option type!");
+        }
+    }
+
+    // Speed declaration - sensitivity of gamma to the underlying price,
+    // reduces to the same formula for both call and puts
+    constexpr auto speed() -> value_type {
+        return -(gamma() / spot_) * ((d1_ / (values_.volatility_ * values_.sqrtime_)) + 1);
+    }
+
+    // Zomma declaration - sensitivity of gamma to volatility,
+    // reduces to the same formula for both call and puts
+    constexpr auto zomma() -> value_type {
+        return gamma() * ((d1_ * d2_) - 1) / values_.volatility_;
+    }
+
+    // Colour declaration - decay of gamma over calendar time,
+    // reduces to the same formula for both call and puts
+    constexpr auto colour() -> value_type {
+        const auto volTime = values_.volatility_ * values_.sqrtime_;
+        const auto returns = values_.dividendDiscount_ * nd1_ / (2 * spot_ * values_.timeToExpiry_ * volTime);
+        const auto drift = (2 * values_.dividendYield_ * values_.timeToExpiry_) + 1 + (2 * driftRatio() * values_.timeToExpiry_ * d1_);
+        return returns * drift;
+    }
+
 private:
+    // Outputs which depend upon each memoized term
+    static constexpr const OutputMask D1_OUTPUTS {
+        Output::Delta, Output::Gamma, Output::Theta, Output::Vega, Output::Rho,
+        Output::Vanna, Output::Volga, Output::Charm, Output::Speed, Output::Zomma, Output::Colour
+    };
+    static constexpr const OutputMask D2_OUTPUTS {
+        Output::Theta, Output::Rho, Output::Vanna, Output::Volga, Output::Charm, Output::Zomma, Output::Colour
+    };
+    static constexpr const OutputMask EXERCISE_OUTPUTS { Output::Delta, Output::Theta, Output::Charm };
+    static constexpr const OutputMask RETURNS_OUTPUTS  { Output::Theta, Output::Rho };
+    static constexpr const OutputMask DENSITY_OUTPUTS {
+        Output::Gamma, Output::Theta, Output::Vega, Output::Vanna, Output::Volga,
+        Output::Charm, Output::Speed, Output::Zomma, Output::Colour
+    };
+
+    // Whether a term used by options of type Side is required by the selected outputs
+    template <typename Executor, typename Side>
+    static constexpr auto derives(const OutputMask outputs, const OutputMask dependents) -> bool {
+        constexpr auto side = std::is_same_v<Side, Executor> || std::is_same_v<AnyExecutor, Executor>;
+        return side && outputs.intersects(dependents);
+    }
+
+    // Ratio of the (risk neutral) drift of d2 to the variance over time to expiry,
+    // common to the decay of both delta and gamma
+    constexpr auto driftRatio() -> value_type {
+        const auto carry = 2 * (values_.riskFreeInterest_ - values_.dividendYield_) * values_.timeToExpiry_;
+        const auto volTime = values_.volatility_ * values_.sqrtime_;
+        return (carry - (d2_ * volTime)) / (2 * values_.timeToExpiry_ * volTime);
+    }
+
     // Standard Normal Density
     // i.e. first derivative of Cumulative Normal Distribution
     constexpr auto standardNormalDensity(value_type coefficient) {
@@ -113,6 +208,7 @@ private:
 
     // Memoize common derived terms
     const value_type d1_;                   // current position: ratio of current spot price to strike price
+    const value_type d2_;                   // current position, less the volatility over time to expiry
     const value_type probabilityExercised_; // probably of exercising at current spot price
     const value_type probabilityExpires_;   // probably of not exercising at current spot price
     const value_type probabilityReturns_;   // probably of returns at current position, after accounting for interest and yield
@@ -120,6 +216,12 @@ private:
     const value_type nd1_;                  // standard normal density of d1
 };
 
+#ifdef BSM_EXTERN_TEMPLATES
+// Instantiated by libbsm, see lib/instantiations.cpp
+extern template class Greeks<float>;
+extern template class Greeks<double>;
+#endif
+
 } // bsm
 
 #endif
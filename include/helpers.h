@@ -27,7 +27,7 @@ namespace bsm
     std::tm nowLocal = *std::localtime(&now);
 
     // TODO RJW: Reimplement with 'from_stream' when libc++std 20 updated
-    std::stringstream ss(date.data());
+    std::stringstream ss{std::string(date)};
     ss >> std::get_time(&inTime, DATE_FMT);
     setToMidnight(inTime);
     setToMidnight(nowLocal);
@@ -43,6 +43,14 @@ namespace bsm
     return getDaysDelta(diff) / DAY_TO_YEAR;
 }
 
+    // Local date, as 'YYYY-mm-dd', from which parseDate measures times to expiry
+    inline auto valuationDate() -> std::string {
+        const std::time_t now = std::time(nullptr);
+        std::stringstream ss;
+        ss << std::put_time(std::localtime(&now), DATE_FMT);
+        return ss.str();
+    }
+
 }
 
 #endif
@@ -0,0 +1,185 @@
+#ifndef HUGE_PAGES_H
+#define HUGE_PAGES_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace bsm
+{
+
+static constexpr const std::size_t HUGE_PAGE_SIZE = std::size_t{2} << 20;
+
+// Backing of large buffers, as selected by '--huge-pages'
+enum class PageMode
+{
+    None,           // regular pages
+    Transparent,    // transparent huge pages, advised with madvise(MADV_HUGEPAGE)
+    Explicit,       // reserved huge pages (MAP_HUGETLB), else transparent where none are free
+};
+
+inline auto parsePageMode(std::string_view name) -> PageMode {
+    if (name == "none") {
+        return PageMode::None;
+    }
+    if (name == "transparent") {
+        return PageMode::Transparent;
+    }
+    if (name == "explicit") {
+        return PageMode::Explicit;
+    }
+    throw std::runtime_error("Unknown huge page mode requested: " + std::string(name));
+}
+
+// Page mode of buffers allocated from now on, process wide
+inline std::atomic<PageMode> pageModeSetting { PageMode::None };
+
+inline void setPageMode(PageMode mode) { pageModeSetting.store(mode, std::memory_order_relaxed); }
+inline auto pageMode() -> PageMode { return pageModeSetting.load(std::memory_order_relaxed); }
+
+// Buffers of at least a huge page are mapped directly, in whole huge pages aligned
+// to a huge page, so that each may be backed by huge pages. Smaller buffers would
+// only waste them, so are left to operator new.
+constexpr auto isMapped(std::size_t bytes) -> bool { return bytes >= HUGE_PAGE_SIZE; }
+
+inline auto mappedSize(std::size_t bytes) -> std::size_t {
+    return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+// Map a buffer of the given size, backed as the current page mode allows
+inline auto mapPages(std::size_t bytes) -> void* {
+    bytes = mappedSize(bytes);
+#if defined(__linux__)
+    const auto mode = pageMode();
+#if defined(MAP_HUGETLB)
+    if (mode == PageMode::Explicit) {
+        auto *ptr = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED) {
+            return ptr;
+        }
+    }
+#endif
+    // Over map by a huge page, and trim, to align the buffer to a huge page
+    auto *mapped = static_cast<std::byte*>(::mmap(nullptr, bytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (mapped == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    const auto offset = (HUGE_PAGE_SIZE - (reinterpret_cast<std::uintptr_t>(mapped) & (HUGE_PAGE_SIZE - 1))) & (HUGE_PAGE_SIZE - 1);
+    if (offset > 0) {
+        ::munmap(mapped, offset);
+    }
+    ::munmap(mapped + offset + bytes, HUGE_PAGE_SIZE - offset);
+
+    auto *ptr = mapped + offset;
+#if defined(MADV_HUGEPAGE)
+    if (mode != PageMode::None) {
+        ::madvise(ptr, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    return ptr;
+#else
+    return ::operator new(bytes, std::align_val_t { HUGE_PAGE_SIZE });
+#endif
+}
+
+inline void unmapPages(void *ptr, std::size_t bytes) noexcept {
+#if defined(__linux__)
+    ::munmap(ptr, mappedSize(bytes));
+#else
+    ::operator delete(ptr, std::align_val_t { HUGE_PAGE_SIZE });
+#endif
+}
+
+// Allocator of buffers which may be backed by huge pages, for the columns of
+// whole portfolios, of which TLB misses would otherwise be significant.
+// Buffers are backed according to the page mode when allocated.
+template <typename T>
+struct HugePageAllocator
+{
+    using value_type = T;
+
+    HugePageAllocator() = default;
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U> &) noexcept {}
+
+    auto allocate(std::size_t count) -> T* {
+        const auto bytes = count * sizeof(T);
+        if (isMapped(bytes)) {
+            return static_cast<T*>(mapPages(bytes));
+        }
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T *ptr, std::size_t count) noexcept {
+        const auto bytes = count * sizeof(T);
+        if (isMapped(bytes)) {
+            unmapPages(ptr, bytes);
+        }
+        else {
+            std::allocator<T>().deallocate(ptr, count);
+        }
+    }
+
+    template <typename U>
+    auto operator==(const HugePageAllocator<U> &) const noexcept -> bool { return true; }
+};
+
+// Growable byte buffer, e.g. of a whole input file, which may be backed by huge
+// pages. Unlike a vector, grown bytes are left uninitialised, to be read into.
+class PageBuffer
+{
+public:
+    PageBuffer() = default;
+    ~PageBuffer() { release(); }
+
+    PageBuffer(const PageBuffer &) = delete;
+    auto operator=(const PageBuffer &) -> PageBuffer& = delete;
+
+    void reserve(std::size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+        auto *data = HugePageAllocator<char>().allocate(capacity);
+        if (size_ > 0) {
+            std::memcpy(data, data_, size_);
+        }
+        release();
+        data_ = data;
+        capacity_ = capacity;
+    }
+
+    // Spare capacity, to be read into, and then committed by grow()
+    auto spare() -> char* { return data_ + size_; }
+    auto spareSize() const -> std::size_t { return capacity_ - size_; }
+    void grow(std::size_t bytes) { size_ += bytes; }
+
+    auto data() const -> const char* { return data_; }
+    auto size() const -> std::size_t { return size_; }
+    auto capacity() const -> std::size_t { return capacity_; }
+
+private:
+    void release() noexcept {
+        if (data_ != nullptr) {
+            HugePageAllocator<char>().deallocate(data_, capacity_);
+        }
+    }
+
+    char *data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+} // bsm
+
+#endif
@@ -1,98 +1,620 @@
 #ifndef INPUT_READER_H
 #define INPUT_READER_H
 
+#include "constants.h"
+#include "discount_curve.h"
 #include "helpers.h"
+#include "huge_pages.h"
 #include "options.h"
+#include "vol_surface.h"
 
+#include <algorithm>
 #include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include <sys/stat.h>
+
 namespace bsm
 {
 
-constexpr const auto CSV_COLUMNS = 7;
-constexpr const auto CSV_TIME_COLUMN = 3;
+constexpr const std::size_t CSV_COLUMNS = 7; // columns of positional rows, optionally followed by quantity, underlying id and book id
+constexpr const auto SURFACE_PREFIX = '@'; // volatility given by surface id, e.g. '@2', or rate by curve id
 
 enum class Format
 {
     CSV,
+    NDJSON,     // one JSON object per line, of the fields named by the CSV header
+    None,
+};
+
+inline auto parseFormat(std::string_view name) -> Format {
+    if (name == "csv") {
+        return Format::CSV;
+    }
+    if (name == "ndjson") {
+        return Format::NDJSON;
+    }
+    throw std::runtime_error("Unknown format requested: " + std::string(name));
+}
+
+// Fields of a contract, named as by CSV headers and NDJSON keys. Columns and
+// keys of no field are skipped, unparsed.
+enum class ContractField
+{
+    OptionType,
+    Underlying,
+    Strike,
+    Expiry,         // date, as 'YYYY-mm-dd'
+    TimeToExpiry,   // in years, in place of a date
+    Volatility,     // number, or surface id as '@<id>'
+    Interest,       // number, or curve id as '@<id>'
+    Dividend,
+    Quantity,
+    UnderlyingId,
+    Book,
     None,
 };
 
+static constexpr const std::pair<std::string_view, ContractField> CONTRACT_FIELDS[] {
+    { "option_type",        ContractField::OptionType },
+    { "underlying_price",   ContractField::Underlying },
+    { "strike_price",       ContractField::Strike },
+    { "expiry_time",        ContractField::Expiry },
+    { "time_to_expiry",     ContractField::TimeToExpiry },
+    { "implied_volatility", ContractField::Volatility },
+    { "interest_rate",      ContractField::Interest },
+    { "dividend_yield",     ContractField::Dividend },
+    { "quantity",           ContractField::Quantity },
+    { "underlying_id",      ContractField::UnderlyingId },
+    { "book_id",            ContractField::Book },
+};
+
+constexpr auto contractField(std::string_view name) -> ContractField {
+    for (const auto &[fieldName, field] : CONTRACT_FIELDS) {
+        if (name == fieldName) {
+            return field;
+        }
+    }
+    return ContractField::None;
+}
+
+constexpr auto fieldName(ContractField field) -> std::string_view {
+    for (const auto &[name, named] : CONTRACT_FIELDS) {
+        if (field == named) {
+            return name;
+        }
+    }
+    return {};
+}
+
+// Columns of a CSV without a header, by position. Position columns are optional.
+static constexpr const ContractField CSV_DEFAULT_COLUMNS[] {
+    ContractField::OptionType, ContractField::Underlying, ContractField::Strike, ContractField::Expiry,
+    ContractField::Volatility, ContractField::Interest, ContractField::Dividend,
+    ContractField::Quantity, ContractField::UnderlyingId, ContractField::Book,
+};
+
+// Header of the bsm.csv of earlier versions, which read every column by position. Its
+// volatility and rate columns are labelled the wrong way round, so files copied from
+// it hold the volatility first whatever their labels, and are still read by position.
+static constexpr const ContractField CSV_LEGACY_HEADER[] {
+    ContractField::OptionType, ContractField::Underlying, ContractField::Strike, ContractField::Expiry,
+    ContractField::Interest, ContractField::Volatility, ContractField::Dividend,
+};
+
+// Scans the members of a single JSON object in place, without allocating.
+// Strings are returned raw, with any escapes left in place, as no field
+// read here needs them.
+class JsonScanner
+{
+public:
+    explicit constexpr JsonScanner(std::string_view text) : text_(text) {}
+
+    // Enter the object, returning false where the text is not one
+    constexpr auto open() -> bool {
+        skipSpace();
+        return consume('{');
+    }
+
+    // Read the key of the next member, leaving its value next. Returns false at
+    // the end of the object, or where malformed, as then reported by failed().
+    constexpr auto key(std::string_view &name) -> bool {
+        skipSpace();
+        if (consume('}')) {
+            skipSpace();
+            failed_ = !text_.empty();
+            return false;
+        }
+        if ((!first_ && !consume(',')) || !(skipSpace(), string(name)) || !(skipSpace(), consume(':'))) {
+            failed_ = true;
+            return false;
+        }
+        first_ = false;
+        skipSpace();
+        return true;
+    }
+
+    constexpr auto isString() const -> bool { return !text_.empty() && text_.front() == '"'; }
+
+    constexpr auto string(std::string_view &value) -> bool {
+        if (!consume('"')) {
+            return false;
+        }
+        for (std::size_t i = 0; i < text_.size(); ++i) {
+            if (text_[i] == '\\') {
+                ++i;
+            }
+            else if (text_[i] == '"') {
+                value = text_.substr(0, i);
+                text_.remove_prefix(i + 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename Number>
+    constexpr auto number(Number &value) -> bool {
+        const auto [end, error] = std::from_chars(text_.data(), text_.data() + text_.size(), value);
+        if (error != std::errc()) {
+            return false;
+        }
+        text_.remove_prefix(static_cast<std::size_t>(end - text_.data()));
+        return true;
+    }
+
+    // Skip the next value, of any type, including nested objects and arrays
+    constexpr auto skip() -> bool {
+        std::size_t depth = 0;
+        do {
+            if (text_.empty()) {
+                return false;
+            }
+            std::string_view ignored;
+            const auto next = text_.front();
+            if (next == '"') {
+                if (!string(ignored)) {
+                    return false;
+                }
+            }
+            else if (next == '{' || next == '[') {
+                ++depth;
+                text_.remove_prefix(1);
+            }
+            else if (next == '}' || next == ']') {
+                if (depth == 0) {
+                    return false;
+                }
+                --depth;
+                text_.remove_prefix(1);
+            }
+            else {
+                // Scalars, and separators within nested values
+                const auto end = text_.find_first_of(depth ? "\"{}[]" : ",}");
+                text_.remove_prefix(std::min(end, text_.size()));
+            }
+        } while (depth > 0);
+        return true;
+    }
+
+    // Skip the next value, as skip(), leaving its text, without any trailing space, in raw
+    constexpr auto value(std::string_view &raw) -> bool {
+        const auto start = text_;
+        if (!skip()) {
+            return false;
+        }
+        raw = start.substr(0, start.size() - text_.size());
+        raw = raw.substr(0, raw.find_last_not_of(" \t\r") + 1);
+        return true;
+    }
+
+    constexpr auto failed() const -> bool { return failed_; }
+
+private:
+    constexpr void skipSpace() {
+        while (!text_.empty() && (text_.front() == ' ' || text_.front() == '\t' || text_.front() == '\r')) {
+            text_.remove_prefix(1);
+        }
+    }
+
+    constexpr auto consume(char expected) -> bool {
+        if (text_.empty() || text_.front() != expected) {
+            return false;
+        }
+        text_.remove_prefix(1);
+        return true;
+    }
+
+    std::string_view text_;
+    bool first_ = true;
+    bool failed_ = false;
+};
+
 template <typename value_type = double>
 class InputReader
 {
 public:
-    using OptionInput = std::pair<OptionType, std::optional<OptionValues<value_type>>>;
+    // Type and values of a contract, the id of the volatility surface given in place
+    // of its volatility, or NO_SURFACE, the id of the discount curve given in place
+    // of its rate, or NO_CURVE, and the position held, of one contract by default
+    using OptionInput = std::tuple<OptionType, std::optional<OptionValues<value_type>>,
+                                   std::uint32_t, std::uint32_t, Position<value_type>>;
 
+    // Strict readers raise an error for each line that is neither a contract nor a header,
+    // rather than skipping it, as where a skipped position would go missing from totals
     InputReader() = delete;
-    explicit InputReader(Format fmt) : fmt_(fmt), skipHeader_(true) {}
+    explicit InputReader(Format fmt, bool strict = false)
+        : fmt_(fmt)
+        , strict_(strict)
+        , columns_(std::begin(CSV_DEFAULT_COLUMNS), std::end(CSV_DEFAULT_COLUMNS))
+    {}
 
+    // The first CSV line read may be a header, naming the fields of its columns, which
+    // then map the columns of all following lines. Without one, or with the legacy
+    // header, columns are positional.
     constexpr auto getOptionValues(std::string_view line) -> OptionInput {
-        OptionType type = OptionType::None;
-        if(!validate(line)) {
-            return { type, std::nullopt };
-        }
         switch (fmt_) {
-        case Format::CSV:
-            return getValuesFromCsv(line);
+        case Format::CSV: {
+            if (!planned_ && planColumns(line)) {
+                return { OptionType::None, std::nullopt, NO_SURFACE, NO_CURVE, {} };
+            }
+            auto input = getValuesFromCsv(line);
+            if (strict_ && !std::get<1>(input) && !isHeader(line)) {
+                throw std::runtime_error("Cannot read contract: " + std::string(line));
+            }
+            return input;
+        }
+        case Format::NDJSON: {
+            auto input = getValuesFromJson(line);
+            if (strict_ && !std::get<1>(input)) {
+                throw std::runtime_error("Cannot read contract: " + std::string(line));
+            }
+            return input;
+        }
         default:
-            return { type, std::nullopt };
+            return { OptionType::None, std::nullopt, NO_SURFACE, NO_CURVE, {} };
         }
     }
 
+    // Field of each CSV column, or ContractField::None where skipped
+    auto columns() const -> const std::vector<ContractField>& { return columns_; }
+
+    // Raw JSON "id" value of the NDJSON line last read, where given, even of a line which is
+    // not a contract, valid while that line is
+    auto requestId() const -> std::string_view { return requestId_; }
+
 private:
-    constexpr auto validate(std::string_view line) -> bool {
-        switch (fmt_) {
-        case Format::CSV:
-            return validateCsv(line);
-        default:
-            return false;
+    // Fields of a contract as read, defaulted as for the CLI where omitted
+    struct Contract
+    {
+        OptionType type_ = OptionType::None;
+        value_type underlying_ = 0, strike_ = 0, time_ = 0;
+        value_type volatility_ = IMPLIED_VOL, interest_ = INTEREST, yield_ = YIELD;
+        std::uint32_t surface_ = NO_SURFACE, curve_ = NO_CURVE;
+        Position<value_type> position_;
+        bool hasUnderlying_ = false, hasStrike_ = false, hasExpiry_ = false;
+    };
+
+    static constexpr auto toInput(const Contract &contract) -> OptionInput {
+        if (contract.type_ == OptionType::None || !contract.hasUnderlying_ || !contract.hasStrike_ || !contract.hasExpiry_) {
+            return { OptionType::None, std::nullopt, NO_SURFACE, NO_CURVE, {} };
+        }
+        OptionValues values { contract.underlying_, contract.strike_, contract.time_,
+                              contract.volatility_, contract.interest_, contract.yield_ };
+        return { contract.type_, values, contract.surface_, contract.curve_, contract.position_ };
+    }
+
+    // Call the visitor with each comma terminated, or final, field, until it returns false
+    template <typename Visitor>
+    static constexpr void forEachField(std::string_view line, Visitor &&visit) {
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
         }
+        while (!line.empty()) {
+            const auto pos = line.find(',');
+            if (!visit(line.substr(0, pos))) {
+                return;
+            }
+            line.remove_prefix((pos == std::string_view::npos) ? line.size() : pos + 1);
+        }
+    }
+
+    // Name of a header column, without surrounding spaces or quotes
+    static constexpr auto columnName(std::string_view name) -> std::string_view {
+        const auto first = name.find_first_not_of(" \t\"");
+        const auto last = name.find_last_not_of(" \t\"");
+        return (first == std::string_view::npos) ? std::string_view() : name.substr(first, last - first + 1);
     }
 
-    constexpr auto validateCsv(std::string_view line) -> bool {
-        if (line.find("option_type") != std::string::npos) {
+    // Whether the line is a header, i.e. names the option type column, as of a header
+    // repeated by concatenated files
+    static constexpr auto isHeader(std::string_view line) -> bool {
+        bool header = false;
+        forEachField(line, [&](std::string_view name) {
+            header = contractField(columnName(name)) == ContractField::OptionType;
+            return !header;
+        });
+        return header;
+    }
+
+    // Map columns by name where the line is a header, i.e. names the option type column.
+    // Returns false, leaving columns positional, where the line is not a header, and
+    // true, also leaving columns positional, where it is the legacy header.
+    auto planColumns(std::string_view line) -> bool {
+        planned_ = true;
+        std::vector<ContractField> columns;
+        bool trailing = false; // of an empty final name, as of a trailing comma
+        forEachField(line, [&](std::string_view name) {
+            name = columnName(name);
+            columns.push_back(contractField(name));
+            trailing = name.empty();
+            return true;
+        });
+
+        if (std::equal(columns.begin(), columns.end() - trailing, std::begin(CSV_LEGACY_HEADER), std::end(CSV_LEGACY_HEADER))) {
+            return true;
+        }
+
+        const auto has = [&](ContractField field) { return std::find(columns.begin(), columns.end(), field) != columns.end(); };
+        if (!has(ContractField::OptionType)) {
             return false;
         }
+        for (const auto field : { ContractField::Underlying, ContractField::Strike }) {
+            if (!has(field)) {
+                throw std::runtime_error("CSV header has no " + std::string(fieldName(field)) + " column");
+            }
+        }
+        if (!has(ContractField::Expiry) && !has(ContractField::TimeToExpiry)) {
+            throw std::runtime_error("CSV header has no expiry_time or time_to_expiry column");
+        }
+        columns_ = std::move(columns);
+        minColumns_ = columns_.size();
         return true;
     }
 
+    // Rows give either all columns, or positionally, any of the trailing position columns,
+    // of which those omitted default to a single contract of underlying and book 0
     constexpr auto getValuesFromCsv(std::string_view line) -> OptionInput {
-        size_t pos = 0, count = 0;
-        OptionType type = OptionType::Call;
-        std::vector<value_type> parsed;
-        while ((pos = line.find_first_of(',')) != std::string::npos) {
-            std::string_view field = line.substr(0, std::min(pos, std::string::npos));
-            if (!count) {
-                type = (field.starts_with("p")) ? OptionType::Put : OptionType::Call;
+        Contract contract;
+        std::size_t column = 0;
+        bool parsed = true;
+        forEachField(line, [&](std::string_view field) {
+            parsed = column < columns_.size() && parseCsvField(columns_[column], field, contract);
+            ++column;
+            return parsed;
+        });
+
+        if (!parsed || column < minColumns_ || column > columns_.size()) {
+            return { OptionType::None, std::nullopt, NO_SURFACE, NO_CURVE, {} };
+        }
+        return toInput(contract);
+    }
+
+    // Types are read by their first letter, of either case. Contract values are read leniently, as zero where malformed, while ids and positions
+    // must be well formed. Empty volatility, rate and yield fields take their defaults.
+    static constexpr auto parseCsvField(ContractField column, std::string_view field, Contract &contract) -> bool {
+        const auto number = [&](value_type &value) {
+            std::from_chars(field.data(), field.data() + field.size(), value);
+            return true;
+        };
+        const auto exact = [&](auto &value) {
+            const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+            return error == std::errc() && end == field.data() + field.size();
+        };
+        // Placeholder volatility or rate, to be looked up from the surface or curve when priced
+        const auto numberOrId = [&](value_type &value, std::uint32_t &id) {
+            if (field.starts_with(SURFACE_PREFIX)) {
+                field.remove_prefix(1);
+                value = 0;
+                return exact(id);
             }
+            return field.empty() || number(value);
+        };
 
-            value_type value = 0;
-            if (count != CSV_TIME_COLUMN) {
-                std::from_chars(field.data(), field.data() + field.size(), value);
-                parsed.push_back(value);
+        switch (column) {
+        case ContractField::OptionType: {
+            // Other types, e.g. of header lines repeated by concatenated files, are rejected
+            const auto letter = field.empty() ? '\0' : static_cast<char>(field.front() | 0x20);
+            contract.type_ = (letter == 'c') ? OptionType::Call : (letter == 'p') ? OptionType::Put : OptionType::None;
+            return contract.type_ != OptionType::None;
+        }
+        case ContractField::Underlying:   contract.hasUnderlying_ = true; return number(contract.underlying_);
+        case ContractField::Strike:       contract.hasStrike_ = true; return number(contract.strike_);
+        case ContractField::TimeToExpiry: contract.hasExpiry_ = true; return number(contract.time_);
+        case ContractField::Expiry:
+            contract.hasExpiry_ = true;
+            contract.time_ = parseDate(field);
+            return true;
+        case ContractField::Volatility:   return numberOrId(contract.volatility_, contract.surface_);
+        case ContractField::Interest:     return numberOrId(contract.interest_, contract.curve_);
+        case ContractField::Dividend:     return field.empty() || number(contract.yield_);
+        case ContractField::Quantity:     return exact(contract.position_.quantity_);
+        case ContractField::UnderlyingId: return exact(contract.position_.underlying_);
+        case ContractField::Book:         return exact(contract.position_.book_);
+        default:                          return true; // unused, so left unconverted
+        }
+    }
+
+    // Fields may be given in any order. The type, prices and expiry are required, while
+    // volatility, rate and yield default as for the CLI, and the position to one contract.
+    constexpr auto getValuesFromJson(std::string_view line) -> OptionInput {
+        // Number, or where a string, the id of a surface or curve prefixed by '@'
+        const auto numberOrId = [](JsonScanner &json, value_type &value, std::uint32_t &id) {
+            std::string_view text;
+            if (!json.isString()) {
+                return json.number(value);
             }
-            else {
-                parsed.push_back(parseDate(field));
+            if (!json.string(text) || !text.starts_with(SURFACE_PREFIX)) {
+                return false;
             }
+            const auto [end, error] = std::from_chars(text.data() + 1, text.data() + text.size(), id);
+            value = 0;
+            return error == std::errc() && end == text.data() + text.size();
+        };
 
-            line.remove_prefix(std::min(pos + 1, std::string::npos));
-            ++count;
+        Contract contract;
+        JsonScanner json(line);
+        requestId_ = {};
+        if (!json.open()) {
+            return { OptionType::None, std::nullopt, NO_SURFACE, NO_CURVE, {} };
+        }
+        std::string_view key, text;
+        while (json.key(key)) {
+            bool parsed = true;
+            switch (contractField(key)) {
+            case ContractField::OptionType:
+                parsed = json.string(text) && (text == "call" || text == "put");
+                contract.type_ = !parsed ? OptionType::None : (text == "put") ? OptionType::Put : OptionType::Call;
+                break;
+            case ContractField::Underlying:   parsed = contract.hasUnderlying_ = json.number(contract.underlying_); break;
+            case ContractField::Strike:       parsed = contract.hasStrike_ = json.number(contract.strike_); break;
+            case ContractField::TimeToExpiry: parsed = contract.hasExpiry_ = json.number(contract.time_); break;
+            case ContractField::Expiry:
+                parsed = contract.hasExpiry_ = json.string(text);
+                if (parsed) {
+                    contract.time_ = parseDate(text);
+                }
+                break;
+            case ContractField::Volatility:   parsed = numberOrId(json, contract.volatility_, contract.surface_); break;
+            case ContractField::Interest:     parsed = numberOrId(json, contract.interest_, contract.curve_); break;
+            case ContractField::Dividend:     parsed = json.number(contract.yield_); break;
+            case ContractField::Quantity:     parsed = json.number(contract.position_.quantity_); break;
+            case ContractField::UnderlyingId: parsed = json.number(contract.position_.underlying_); break;
+            case ContractField::Book:         parsed = json.number(contract.position_.book_); break;
+            default:                          parsed = (key == "id") ? json.value(requestId_) : json.skip(); break;
+            }
+            if (!parsed) {
+                findRequestId(line);
+                return { OptionType::None, std::nullopt, NO_SURFACE, NO_CURVE, {} };
+            }
         }
 
-        if (count != CSV_COLUMNS) {
-            return { type, std::nullopt };
+        if (json.failed()) {
+            findRequestId(line);
+            return { OptionType::None, std::nullopt, NO_SURFACE, NO_CURVE, {} };
         }
+        return toInput(contract);
+    }
 
-        // TODO RJW: Find a neater way to forward these args
-        OptionValues values { parsed[1], parsed[2], parsed[3], parsed[4], parsed[5], parsed[6] };
-        return { type, values };
+    // Rescan a line which is not a contract for the id its reading stopped short of, skipping
+    // each field in turn, as far as the line is well formed
+    constexpr void findRequestId(std::string_view line) {
+        JsonScanner json(line);
+        std::string_view key;
+        if (!requestId_.empty() || !json.open()) {
+            return;
+        }
+        while (json.key(key)) {
+            if (key == "id") {
+                json.value(requestId_);
+                return;
+            }
+            if (!json.skip()) {
+                return;
+            }
+        }
     }
 
     Format fmt_;
-    bool skipHeader_;
+    bool strict_;
+    std::vector<ContractField> columns_;       // field of each CSV column
+    std::size_t minColumns_ = CSV_COLUMNS;     // columns of rows without their optional columns
+    bool planned_ = false;                     // the first CSV line has been checked for a header
+    std::string_view requestId_;               // of the last NDJSON line, into that line
+};
+
+// Reads the lines of a C stream, e.g. stdin, so that iostreams, and their static
+// initialisation, are not needed by the CLI
+class LineReader
+{
+public:
+    LineReader() = delete;
+    explicit LineReader(std::FILE *file) : file_(file) {}
+    ~LineReader() { std::free(buffer_); }
+
+    LineReader(const LineReader &) = delete;
+    auto operator=(const LineReader &) -> LineReader& = delete;
+
+    // Next line, without its newline, valid until the following call
+    auto next() -> std::optional<std::string_view> {
+        const auto length = ::getline(&buffer_, &capacity_, file_);
+        if (length < 0) {
+            return std::nullopt;
+        }
+        std::string_view line(buffer_, static_cast<std::size_t>(length));
+        if (line.ends_with('\n')) {
+            line.remove_suffix(1);
+        }
+        return line;
+    }
+
+private:
+    std::FILE *file_;
+    char *buffer_ = nullptr;
+    std::size_t capacity_ = 0;
+};
+
+// Read the remainder of a stream into the buffer, sized up front where a regular file
+inline void readFile(std::FILE *file, PageBuffer &buffer, std::size_t readSize) {
+    struct stat status {};
+    const auto known = ::fstat(::fileno(file), &status) == 0 && S_ISREG(status.st_mode);
+    buffer.reserve(known ? static_cast<std::size_t>(status.st_size) + 1 : readSize);
+
+    while (true) {
+        if (buffer.spareSize() == 0) {
+            buffer.reserve(buffer.capacity() * 2);
+        }
+        const auto read = std::fread(buffer.spare(), 1, buffer.spareSize(), file);
+        if (read == 0) {
+            break;
+        }
+        buffer.grow(read);
+    }
+    if (std::ferror(file)) {
+        throw std::runtime_error("Cannot read input");
+    }
+}
+
+// Reads the whole of a C stream, e.g. a portfolio file, into a single buffer, which
+// may be backed by huge pages, whose lines are then read in place
+class BufferReader
+{
+public:
+    static constexpr const std::size_t READ_SIZE = std::size_t{1} << 20;
+
+    BufferReader() = delete;
+    explicit BufferReader(std::FILE *file) {
+        readFile(file, buffer_, READ_SIZE);
+    }
+
+    // Next line, without its newline, valid for the life of the reader
+    auto next() -> std::optional<std::string_view> {
+        if (position_ >= buffer_.size()) {
+            return std::nullopt;
+        }
+        const auto *begin = buffer_.data() + position_;
+        const auto remaining = buffer_.size() - position_;
+        const auto *end = static_cast<const char*>(std::memchr(begin, '\n', remaining));
+        const auto length = (end != nullptr) ? static_cast<std::size_t>(end - begin) : remaining;
+        position_ += length + 1;
+        return std::string_view(begin, length);
+    }
+
+    auto size() const -> std::size_t { return buffer_.size(); }
+
+private:
+    PageBuffer buffer_;
+    std::size_t position_ = 0;
 };
 
 }
@@ -0,0 +1,223 @@
+#ifndef LATTICE_H
+#define LATTICE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "black_scholes.h"
+#include "constants.h"
+
+namespace bsm
+{
+
+// fwd declare executor types
+struct CallExecutor;
+struct PutExecutor;
+
+static constexpr const std::size_t LATTICE_STEPS = 500;
+
+enum class Exercise
+{
+    European,
+    American,
+};
+
+enum class LatticeMethod
+{
+    Binomial,  // Cox-Ross-Rubinstein
+    Trinomial, // Boyle
+};
+
+enum class Smoothing
+{
+    None,
+    Richardson,            // two point extrapolation over N and N/2 steps
+    BlackScholes,          // closed form European values at the final step (BBS)
+    BlackScholesRichardson // both of the above (BBSR)
+};
+
+// Prices European or American options by backward induction over a recombining lattice.
+// Only a single rolling buffer of node values, reused per thread, is held rather than a
+// full tree. Exposes the same call and put valuations as BlackScholes, so may be used as
+// the pricing model of an Option or BatchPricer.
+template <typename value_type = double>
+class Lattice
+{
+public:
+    explicit Lattice(std::size_t steps = LATTICE_STEPS,
+                     Exercise exercise = Exercise::American,
+                     LatticeMethod method = LatticeMethod::Binomial,
+                     Smoothing smoothing = Smoothing::None)
+        : steps_(steps)
+        , exercise_(exercise)
+        , method_(method)
+        , smoothing_(smoothing)
+    {
+        if (steps_ < 2) {
+            throw std::runtime_error("Lattice requires at least two time steps");
+        }
+    }
+
+    auto operator==(const Lattice &) const -> bool = default;
+
+    auto callOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        return price<CallExecutor>(values);
+    }
+
+    auto putOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        return price<PutExecutor>(values);
+    }
+
+    template <typename Executor>
+    auto price(const OptionValues<value_type> &values) const -> value_type {
+        const auto smoothed = (smoothing_ == Smoothing::BlackScholes || smoothing_ == Smoothing::BlackScholesRichardson);
+        const auto extrapolated = (smoothing_ == Smoothing::Richardson || smoothing_ == Smoothing::BlackScholesRichardson);
+
+        const auto value = induct<Executor>(values, steps_, smoothed);
+        if (!extrapolated) {
+            return value;
+        }
+        return (2 * value) - induct<Executor>(values, steps_ / 2, smoothed);
+    }
+
+private:
+    template <typename Executor>
+    constexpr auto payoff(const value_type spot, const value_type strike) const -> value_type {
+        if constexpr (std::is_same_v<CallExecutor, Executor>) {
+            return std::max<value_type>(spot - strike, 0);
+        }
+        else if constexpr (std::is_same_v<PutExecutor, Executor>) {
+            return std::max<value_type>(strike - spot, 0);
+        }
+        else {
+            throw std::runtime_error("Cannot derive payoff of unknown option type!");
+        }
+    }
+
+    // Closed form European value of a node over the final time step, for BBS smoothing.
+    // Derived directly, as node prices may lie outside the bounds validated by OptionValues.
+    template <typename Executor>
+    auto europeanValue(const value_type spot, const OptionValues<value_type> &values,
+                       const value_type dt) const -> value_type {
+        const auto volTime = values.volatility_ * std::sqrt(dt);
+        const auto drift = (values.riskFreeInterest_ - values.dividendYield_ + (values.volatility_ * values.volatility_ / 2)) * dt;
+        const auto dOne = (std::log(spot / values.strikePrice_) + drift) / volTime;
+        const auto dTwo = dOne - volTime;
+        const auto returns = spot * std::exp(-values.dividendYield_ * dt);
+        const auto cost = values.strikePrice_ * std::exp(-values.riskFreeInterest_ * dt);
+
+        if constexpr (std::is_same_v<CallExecutor, Executor>) {
+            return (returns * bsm_.cumulNormalDist(dOne)) - (cost * bsm_.cumulNormalDist(dTwo));
+        }
+        else {
+            return (cost * bsm_.cumulNormalDist(-dTwo)) - (returns * bsm_.cumulNormalDist(-dOne));
+        }
+    }
+
+    template <typename Executor>
+    auto induct(const OptionValues<value_type> &values, const std::size_t steps, const bool smoothed) const -> value_type {
+        if (method_ == LatticeMethod::Binomial) {
+            return binomial<Executor>(values, steps, smoothed);
+        }
+        return trinomial<Executor>(values, steps, smoothed);
+    }
+
+    template <typename Executor>
+    auto binomial(const OptionValues<value_type> &values, const std::size_t steps, const bool smoothed) const -> value_type {
+        const auto spot = values.underlyingPrice_;
+        const auto strike = values.strikePrice_;
+        const auto dt = values.timeToExpiry_ / static_cast<value_type>(steps);
+        const auto up = std::exp(values.volatility_ * std::sqrt(dt));
+        const auto down = 1 / up;
+        const auto upSquared = up * up;
+        const auto growth = std::exp((values.riskFreeInterest_ - values.dividendYield_) * dt);
+        const auto discount = std::exp(-values.riskFreeInterest_ * dt);
+        const auto probUp = discount * (growth - down) / (up - down);
+        const auto probDown = discount - probUp;
+        const auto american = (exercise_ == Exercise::American);
+
+        // Node values at the final step to be inducted, either terminal
+        // payoffs, or smoothed European values one step before expiry
+        const auto last = smoothed ? steps - 1 : steps;
+        auto &nodes = buffer();
+        nodes.resize(last + 1);
+        auto nodeSpot = spot * std::pow(down, static_cast<value_type>(last));
+        for (std::size_t j = 0; j <= last; ++j, nodeSpot *= upSquared) {
+            nodes[j] = smoothed ? europeanValue<Executor>(nodeSpot, values, dt) : payoff<Executor>(nodeSpot, strike);
+            if (smoothed && american) {
+                nodes[j] = std::max(nodes[j], payoff<Executor>(nodeSpot, strike));
+            }
+        }
+
+        for (std::size_t step = last; step-- > 0; ) {
+            nodeSpot = spot * std::pow(down, static_cast<value_type>(step));
+            for (std::size_t j = 0; j <= step; ++j, nodeSpot *= upSquared) {
+                nodes[j] = (probUp * nodes[j + 1]) + (probDown * nodes[j]);
+                if (american) {
+                    nodes[j] = std::max(nodes[j], payoff<Executor>(nodeSpot, strike));
+                }
+            }
+        }
+        return nodes[0];
+    }
+
+    template <typename Executor>
+    auto trinomial(const OptionValues<value_type> &values, const std::size_t steps, const bool smoothed) const -> value_type {
+        const auto spot = values.underlyingPrice_;
+        const auto strike = values.strikePrice_;
+        const auto dt = values.timeToExpiry_ / static_cast<value_type>(steps);
+        const auto variance = values.volatility_ * values.volatility_;
+        const auto dx = values.volatility_ * std::sqrt(3 * dt);
+        const auto up = std::exp(dx);
+        const auto drift = values.riskFreeInterest_ - values.dividendYield_ - (variance / 2);
+        const auto discount = std::exp(-values.riskFreeInterest_ * dt);
+        const auto spread = ((variance * dt) + (drift * drift * dt * dt)) / (dx * dx);
+        const auto skew = drift * dt / dx;
+        const auto probUp = discount * (spread + skew) / 2;
+        const auto probDown = discount * (spread - skew) / 2;
+        const auto probMid = discount - probUp - probDown;
+        const auto american = (exercise_ == Exercise::American);
+
+        const auto last = smoothed ? steps - 1 : steps;
+        auto &nodes = buffer();
+        nodes.resize((2 * last) + 1);
+        auto nodeSpot = spot * std::exp(-dx * static_cast<value_type>(last));
+        for (std::size_t j = 0; j <= 2 * last; ++j, nodeSpot *= up) {
+            nodes[j] = smoothed ? europeanValue<Executor>(nodeSpot, values, dt) : payoff<Executor>(nodeSpot, strike);
+            if (smoothed && american) {
+                nodes[j] = std::max(nodes[j], payoff<Executor>(nodeSpot, strike));
+            }
+        }
+
+        for (std::size_t step = last; step-- > 0; ) {
+            nodeSpot = spot * std::exp(-dx * static_cast<value_type>(step));
+            for (std::size_t j = 0; j <= 2 * step; ++j, nodeSpot *= up) {
+                nodes[j] = (probDown * nodes[j]) + (probMid * nodes[j + 1]) + (probUp * nodes[j + 2]);
+                if (american) {
+                    nodes[j] = std::max(nodes[j], payoff<Executor>(nodeSpot, strike));
+                }
+            }
+        }
+        return nodes[0];
+    }
+
+    // Rolling buffer of node values, reused across all contracts priced on each thread
+    static auto buffer() -> std::vector<value_type>& {
+        thread_local std::vector<value_type> nodes;
+        return nodes;
+    }
+
+    std::size_t steps_;
+    Exercise exercise_;
+    LatticeMethod method_;
+    Smoothing smoothing_;
+    BlackScholes<value_type> bsm_;
+};
+
+} // bsm
+
+#endif
@@ -0,0 +1,421 @@
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "black_scholes.h"
+#include "brownian_bridge.h"
+#include "constants.h"
+#include "philox.h"
+#include "sobol.h"
+#include "thread_pool.h"
+
+namespace bsm
+{
+
+// fwd declare option value and executor types
+template<typename value_type>
+struct OptionValues;
+struct CallExecutor;
+struct PutExecutor;
+
+static constexpr const std::size_t MC_PATHS = 1 << 16;
+static constexpr const std::size_t MC_BLOCK_PATHS = 4096; // paths simulated per random stream
+static constexpr const std::uint64_t MC_SEED = 0x5EED;
+static constexpr const std::size_t MC_REPLICATIONS = 16;  // randomly shifted replications of quasi-random runs
+
+// Source of the normals driving each path
+enum class Sequence
+{
+    PseudoRandom, // Philox streams, with normals by Box-Muller
+    Sobol,        // randomly shifted Sobol points, with paths constructed by Brownian bridge
+};
+
+// Settings of a Monte Carlo simulation
+struct Simulation
+{
+    std::size_t paths_ = MC_PATHS;  // rounded up to whole antithetic pairs
+    std::size_t steps_ = 1;         // time steps per path, only required by path dependent payoffs
+    std::uint64_t seed_ = MC_SEED;
+    bool antithetic_ = true;        // pair each path with its reflection
+    bool controlVariate_ = true;    // adjust by the error of the closed form European value
+    Sequence sequence_ = Sequence::PseudoRandom;
+    std::size_t replications_ = MC_REPLICATIONS; // quasi-random only, across which the standard error is derived
+
+    auto operator==(const Simulation &) const -> bool = default;
+};
+
+// Simulated value of an option, with the standard error of the estimate
+template <typename value_type = double>
+struct Estimate
+{
+    value_type value_;
+    value_type standardError_;
+    std::size_t paths_;
+};
+
+// Prices options by simulation of geometric Brownian motion over the given inputs.
+// Paths are simulated in fixed size blocks, each drawing from its own Philox stream,
+// and block sums are combined in order, so estimates are identical whether blocks are
+// simulated serially or across a thread pool.
+//
+// Payoffs are given the simulated underlying price at the end of each time step.
+// The discounted European payoff of the executor's type serves as the control variate,
+// with the closed form Black Scholes value as its known mean. Exposes the same call and
+// put valuations as BlackScholes, so may be used as the pricing model of an Option or
+// BatchPricer, where each contract is simulated serially.
+//
+// Quasi-random simulations split paths across independently shifted replications of the
+// same Sobol points, one dimension per time step, and the standard error is derived from
+// the spread of the replications' estimates.
+template <typename value_type = double>
+class MonteCarlo
+{
+public:
+    explicit MonteCarlo(const Simulation simulation = {})
+        : simulation_(simulation)
+        , bridge_(std::max<std::size_t>(1, simulation_.steps_))
+    {
+        if (simulation_.paths_ < 2) {
+            throw std::runtime_error("Simulation requires at least two paths");
+        }
+        if (simulation_.steps_ < 1) {
+            throw std::runtime_error("Simulation requires at least one time step");
+        }
+        if (quasiRandom()) {
+            if (simulation_.replications_ < 2) {
+                throw std::runtime_error("Quasi-random simulation requires at least two replications");
+            }
+            sobol_.emplace(simulation_.steps_);
+        }
+    }
+
+    // Simulations of the same settings give the same estimates
+    auto operator==(const MonteCarlo &rhs) const -> bool { return simulation_ == rhs.simulation_; }
+
+    auto callOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        return estimate<CallExecutor>(values).value_;
+    }
+
+    auto putOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        return estimate<PutExecutor>(values).value_;
+    }
+
+    // Estimate of a European option
+    template <typename Executor>
+    auto estimate(const OptionValues<value_type> &values, ThreadPool *pool = nullptr) const -> Estimate<value_type> {
+        return estimate<Executor>(values, [&](std::span<const value_type> path) {
+            return payoff<Executor>(path.back(), values.strikePrice_);
+        }, pool);
+    }
+
+    // Estimate of an option with the given (undiscounted) payoff of the simulated path,
+    // simulating blocks of paths in parallel if a thread pool is given
+    template <typename Executor, typename Payoff>
+    auto estimate(const OptionValues<value_type> &values, Payoff &&payoff, ThreadPool *pool = nullptr) const -> Estimate<value_type> {
+        const auto replications = quasiRandom() ? simulation_.replications_ : 1;
+        const auto pairs = (this->pairs() + replications - 1) / replications;
+        const auto blocks = (pairs + blockPairs() - 1) / blockPairs();
+        std::vector<Sums> sums(replications * blocks);
+
+        const auto simulate = [&](std::size_t begin, std::size_t end) {
+            for (std::size_t index = begin; index < end; ++index) {
+                sums[index] = simulateBlock<Executor>(values, payoff, index / blocks, index % blocks, pairs);
+            }
+        };
+        if (pool) {
+            pool->parallelFor(sums.size(), 1, simulate);
+        }
+        else {
+            simulate(0, sums.size());
+        }
+
+        std::vector<Estimate<value_type>> estimates(replications);
+        for (std::size_t replication = 0; replication < replications; ++replication) {
+            Sums total;
+            for (std::size_t block = 0; block < blocks; ++block) {
+                total += sums[(replication * blocks) + block];
+            }
+            estimates[replication] = combine<Executor>(values, total);
+        }
+        return (replications == 1) ? estimates.front() : average(estimates);
+    }
+
+    auto simulation() const -> const Simulation& { return simulation_; }
+
+private:
+    auto quasiRandom() const -> bool { return simulation_.sequence_ == Sequence::Sobol; }
+
+    // Running sums over samples of the payoff (y) and control (c)
+    struct Sums
+    {
+        std::size_t count_ = 0;
+        double y_ = 0, c_ = 0, yy_ = 0, cc_ = 0, yc_ = 0;
+
+        void add(double y, double c) {
+            ++count_;
+            y_ += y;
+            c_ += c;
+            yy_ += y * y;
+            cc_ += c * c;
+            yc_ += y * c;
+        }
+
+        auto operator+=(const Sums &rhs) -> Sums& {
+            count_ += rhs.count_;
+            y_ += rhs.y_;
+            c_ += rhs.c_;
+            yy_ += rhs.yy_;
+            cc_ += rhs.cc_;
+            yc_ += rhs.yc_;
+            return *this;
+        }
+    };
+
+    // Antithetic pairs are simulated from the same normals, otherwise each path
+    // is simulated from its own normals, and counted as a pair of one
+    auto pairs() const -> std::size_t {
+        return simulation_.antithetic_ ? (simulation_.paths_ + 1) / 2 : simulation_.paths_;
+    }
+
+    auto blockPairs() const -> std::size_t {
+        return simulation_.antithetic_ ? MC_BLOCK_PATHS / 2 : MC_BLOCK_PATHS;
+    }
+
+    template <typename Executor>
+    static constexpr auto payoff(const value_type spot, const value_type strike) -> value_type {
+        if constexpr (std::is_same_v<CallExecutor, Executor>) {
+            return std::max<value_type>(spot - strike, 0);
+        }
+        else if constexpr (std::is_same_v<PutExecutor, Executor>) {
+            return std::max<value_type>(strike - spot, 0);
+        }
+        else {
+            throw std::runtime_error("Cannot derive payoff of unknown option type!");
+        }
+    }
+
+    template <typename Executor, typename Payoff>
+    auto simulateBlock(const OptionValues<value_type> &values, Payoff &payoff,
+                       std::size_t replication, std::size_t block, std::size_t pairs) const -> Sums {
+        const auto steps = simulation_.steps_;
+        const auto first = block * blockPairs();
+        const auto count = std::min(blockPairs(), pairs - first);
+
+        const auto dt = values.timeToExpiry_ / static_cast<value_type>(steps);
+        const auto drift = (values.riskFreeInterest_ - values.dividendYield_ - (values.volatility_ * values.volatility_ / 2)) * dt;
+        const auto diffusion = values.volatility_ * std::sqrt(dt);
+        const auto discount = values.interestDiscount_;
+
+        auto &normals = buffers().normals_;
+        auto &path = buffers().path_;
+        normals.resize(count * steps);
+        path.resize(steps);
+        if (quasiRandom()) {
+            generateQuasiRandom(replication, first, count, normals);
+        }
+        else {
+            generateNormals(block, normals);
+        }
+
+        const auto simulatePath = [&](const value_type *shocks, const value_type sign) {
+            auto logSpot = std::log(values.underlyingPrice_);
+            for (std::size_t step = 0; step < steps; ++step) {
+                logSpot += drift + (sign * diffusion * shocks[step]);
+                path[step] = std::exp(logSpot);
+            }
+            const std::span<const value_type> simulated(path);
+            return std::pair<double, double> {
+                discount * payoff(simulated),
+                discount * this->payoff<Executor>(simulated.back(), values.strikePrice_)
+            };
+        };
+
+        Sums sums;
+        for (std::size_t pair = 0; pair < count; ++pair) {
+            const auto *shocks = &normals[pair * steps];
+            auto [y, c] = simulatePath(shocks, 1);
+            if (simulation_.antithetic_) {
+                const auto [ya, ca] = simulatePath(shocks, -1);
+                y = (y + ya) / 2;
+                c = (c + ca) / 2;
+            }
+            sums.add(y, c);
+        }
+        return sums;
+    }
+
+    // Fill with standard normals of the block's stream, by Box-Muller over pairs of
+    // uniforms. Uniforms are generated in a first pass, and transformed in a second,
+    // so that each loop may be vectorised.
+    void generateNormals(std::size_t block, std::vector<value_type> &normals) const {
+        const Philox4x32 philox(simulation_.seed_);
+        const auto size = normals.size();
+        auto &uniforms = buffers().uniforms_;
+        uniforms.resize(size + 4);
+
+        for (std::size_t draw = 0; draw * 4 < size; ++draw) {
+            const auto bits = philox({ static_cast<std::uint32_t>(draw), static_cast<std::uint32_t>(draw >> 32),
+                                       static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(block >> 32) });
+            for (std::size_t i = 0; i < 4; ++i) {
+                uniforms[(draw * 4) + i] = Philox4x32::uniform<value_type>(bits[i]);
+            }
+        }
+
+        const auto half = (size + 1) / 2;
+        for (std::size_t i = 0; i < half; ++i) {
+            const auto radius = std::sqrt(-2 * std::log(uniforms[2 * i]));
+            const auto angle = static_cast<value_type>(2 * M_PI) * uniforms[(2 * i) + 1];
+            uniforms[2 * i] = radius * std::cos(angle);
+            uniforms[(2 * i) + 1] = radius * std::sin(angle);
+        }
+        std::copy_n(uniforms.begin(), size, normals.begin());
+    }
+
+    // Fill with the path increments of the replication's shifted Sobol points, mapped to
+    // standard normals by the inverse normal distribution, and bridged into time order
+    void generateQuasiRandom(std::size_t replication, std::size_t first, std::size_t count,
+                             std::vector<value_type> &normals) const {
+        const Philox4x32 philox(simulation_.seed_);
+        const auto steps = simulation_.steps_;
+        auto &points = buffers().points_;
+        auto &uniforms = buffers().uniforms_;
+        points.resize(count * steps);
+        uniforms.resize(count * steps);
+        sobol_->generate(first, count, points);
+
+        // Random digital shift of each dimension, drawn from counters beyond those of any block stream
+        std::array<std::uint32_t, SOBOL_DIMENSIONS> shifts {};
+        for (std::size_t dim = 0; dim < steps; dim += 4) {
+            const auto bits = philox({ static_cast<std::uint32_t>(dim / 4), static_cast<std::uint32_t>(replication), 0, 0xFFFFFFFF });
+            std::copy_n(bits.begin(), std::min<std::size_t>(4, steps - dim), shifts.begin() + static_cast<std::ptrdiff_t>(dim));
+        }
+
+        for (std::size_t point = 0; point < count; ++point) {
+            for (std::size_t dim = 0; dim < steps; ++dim) {
+                const auto index = (point * steps) + dim;
+                uniforms[index] = inverseCumulNormalDist(Philox4x32::uniform<value_type>(points[index] ^ shifts[dim]));
+            }
+            bridge_.transform(&uniforms[point * steps], &normals[point * steps]);
+        }
+    }
+
+    // Inverse of the cumulative normal distribution, by the rational approximation of
+    // Acklam, refined by a single step of Halley's method
+    auto inverseCumulNormalDist(const value_type probability) const -> value_type {
+        static constexpr const double a[6] {
+            -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+            1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00
+        };
+        static constexpr const double b[5] {
+            -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+            6.680131188771972e+01, -1.328068155288572e+01
+        };
+        static constexpr const double c[6] {
+            -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+            -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00
+        };
+        static constexpr const double d[4] {
+            7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00
+        };
+        static constexpr const double tail = 0.02425;
+
+        const auto p = static_cast<double>(probability);
+        const auto lower = [&](double q) {
+            return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5])
+                 / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+        };
+
+        double x = 0;
+        if (p < tail) {
+            x = lower(std::sqrt(-2 * std::log(p)));
+        }
+        else if (p > 1 - tail) {
+            x = -lower(std::sqrt(-2 * std::log(1 - p)));
+        }
+        else {
+            const auto q = p - 0.5;
+            const auto r = q * q;
+            x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q
+              / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+        }
+
+        const auto error = (0.5 * std::erfc(-x / std::sqrt(2.0))) - p;
+        const auto step = error * std::sqrt(2 * M_PI) * std::exp(x * x / 2);
+        return static_cast<value_type>(x - (step / (1 + (x * step / 2))));
+    }
+
+    // Mean of independent replications, with the standard error of their spread
+    static auto average(const std::vector<Estimate<value_type>> &estimates) -> Estimate<value_type> {
+        const auto n = static_cast<double>(estimates.size());
+        double mean = 0;
+        std::size_t paths = 0;
+        for (const auto &estimate : estimates) {
+            mean += estimate.value_;
+            paths += estimate.paths_;
+        }
+        mean /= n;
+
+        double variance = 0;
+        for (const auto &estimate : estimates) {
+            variance += (estimate.value_ - mean) * (estimate.value_ - mean);
+        }
+        variance /= (n - 1);
+        return { static_cast<value_type>(mean), static_cast<value_type>(std::sqrt(variance / n)), paths };
+    }
+
+    template <typename Executor>
+    auto combine(const OptionValues<value_type> &values, const Sums &sums) const -> Estimate<value_type> {
+        const auto n = static_cast<double>(sums.count_);
+        const auto meanY = sums.y_ / n;
+        const auto meanC = sums.c_ / n;
+        const auto varY = std::max(0.0, (sums.yy_ / n) - (meanY * meanY));
+        const auto varC = std::max(0.0, (sums.cc_ / n) - (meanC * meanC));
+        const auto covYC = (sums.yc_ / n) - (meanY * meanC);
+
+        auto value = meanY;
+        auto variance = varY;
+        if (simulation_.controlVariate_ && varC > 0) {
+            const auto beta = covYC / varC;
+            const auto control = static_cast<double>(Executor()(bsm_, values));
+            value = meanY - (beta * (meanC - control));
+            variance = std::max(0.0, varY - (beta * covYC));
+        }
+
+        const auto correction = (n > 1) ? n / (n - 1) : 0.0;
+        const auto paths = simulation_.antithetic_ ? sums.count_ * 2 : sums.count_;
+        return { static_cast<value_type>(value), static_cast<value_type>(std::sqrt(variance * correction / n)), paths };
+    }
+
+    // Working buffers, reused across all contracts simulated on each thread
+    struct Buffers
+    {
+        std::vector<std::uint32_t> points_;
+        std::vector<value_type> uniforms_;
+        std::vector<value_type> normals_;
+        std::vector<value_type> path_;
+    };
+
+    static auto buffers() -> Buffers& {
+        thread_local Buffers buffers;
+        return buffers;
+    }
+
+    Simulation simulation_;
+    BrownianBridge<value_type> bridge_;
+    std::optional<Sobol> sobol_;
+    BlackScholes<value_type> bsm_;
+};
+
+} // bsm
+
+#endif
@@ -1,14 +1,16 @@
 #ifndef OPTION_H
 #define OPTION_H
 
+#include <algorithm>
 #include <cstdint>
-#include <iostream>
+#include <limits>
 #include <stdexcept>
-#include <fmt/core.h>
+#include <type_traits>
 
 #include "black_scholes.h"
 #include "constants.h"
 #include "greeks.h"
+#include "outputs.h"
 
 namespace bsm
 {
@@ -20,6 +22,15 @@ enum class OptionType
     None,
 };
 
+// Holding of a contract, and the keys by which holdings are aggregated
+template <typename value_type = double>
+struct Position
+{
+    value_type quantity_ = 1;
+    std::uint32_t underlying_ = 0;
+    std::uint32_t book_ = 0;
+};
+
 template <typename value_type>
 struct OptionValues
 {
@@ -45,6 +56,29 @@ public:
         validate();
     }
 
+    // Values discounted by a precomputed discount factor, e.g. as shared by
+    // all contracts of the same expiry on a discount curve
+    explicit OptionValues(value_type underlying,
+                          value_type strike,
+                          value_type time,
+                          value_type volatility,
+                          value_type rate,
+                          value_type yield,
+                          value_type interestDiscount)
+        : underlyingPrice_(underlying)
+        , strikePrice_(strike)
+        , timeToExpiry_(time)
+        , volatility_(volatility)
+        , riskFreeInterest_(rate)
+        , dividendYield_(yield)
+        , sqrtime_(std::sqrt(timeToExpiry_))
+        , volatilityPotential_(volatility_ / (2 * sqrtime_))
+        , interestDiscount_(interestDiscount)
+        , dividendDiscount_(std::exp(-dividendYield_ * timeToExpiry_))
+    {
+        validate();
+    }
+
     value_type  underlyingPrice_  = 0.0;
     value_type  strikePrice_      = 0.0;
     value_type  timeToExpiry_     = 0.0;
@@ -93,34 +127,51 @@ private:
     }
 };
 
+// Executors dispatch to the call or put valuation of any pricing model,
+// e.g. BlackScholes, or Lattice
 struct CallExecutor
 {
-    template<typename value_type>
-    constexpr auto operator()(const BlackScholes<value_type> &bsm,
-                                     const OptionValues<value_type> &values) const {
-        return bsm.callOptionValue(values);
+    template<typename Pricer, typename value_type>
+    constexpr auto operator()(const Pricer &pricer,
+                              const OptionValues<value_type> &values) const {
+        return pricer.callOptionValue(values);
     }
 };
 
 struct PutExecutor
 {
-    template<typename value_type>
-    constexpr auto operator()(const BlackScholes<value_type> &bsm,
-                                     const OptionValues<value_type> &values) const {
-        return bsm.putOptionValue(values);
+    template<typename Pricer, typename value_type>
+    constexpr auto operator()(const Pricer &pricer,
+                              const OptionValues<value_type> &values) const {
+        return pricer.putOptionValue(values);
     }
 };
 
+// Option priced by the given model, which defaults to closed form Black Scholes.
+// Greeks of Black Scholes are derived in closed form. Those of other models, e.g.
+// of American exercise or simulated, are derived by repricing bumped inputs through
+// the model, so that they are of the contract priced. Only first order greeks are so
+// derived, and higher order greeks of other models are NaN.
 template <typename Executor = CallExecutor,
-          typename value_type = double>
+          typename value_type = double,
+          typename Pricer = BlackScholes<value_type>>
 class Option
 {
 public:
     Option() = delete;
-    explicit Option(OptionValues<value_type> &&values) noexcept
+    explicit Option(OptionValues<value_type> &&values,
+                    const OutputMask outputs = OutputMask::all()) noexcept
+        : Option(std::move(values), Pricer(), outputs)
+    {}
+
+    explicit Option(OptionValues<value_type> &&values,
+                    Pricer pricer,
+                    const OutputMask outputs = OutputMask::all()) noexcept
         : values_(std::move(values))
         , bsm_()
-        , greeks_(values_, bsm_)
+        , pricer_(std::move(pricer))
+        , outputs_(outputs)
+        , greeks_(values_, bsm_, CLOSED_FORM ? outputs_ : OutputMask {}, Executor())
     {}
 
     auto operator=(const Option &rhs) -> Option& {
@@ -137,7 +188,7 @@ public:
     }
 
     constexpr auto operator()() const {
-        return Executor()(bsm_, values_);
+        return Executor()(pricer_, values_);
     }
 
     // Base values
@@ -148,29 +199,125 @@ public:
     constexpr auto riskFreeInterest() const -> value_type { return values_.riskFreeInterest_; }
     constexpr auto dividendYield()    const -> value_type { return values_.dividendYield_; }
 
-    // Greeks
-    constexpr auto delta() -> value_type { return greeks_.template delta<Executor>(); }
-    constexpr auto gamma() -> value_type { return greeks_.gamma(); }
-    constexpr auto theta() -> value_type { return greeks_.template theta<Executor>(); }
-    constexpr auto vega()  -> value_type { return greeks_.vega(); }
-    constexpr auto rho()   -> value_type { return greeks_.template rho<Executor>(); }
-
-    void printGreeks(const bool singleLine = false) {
-        std::string_view endl = "\n";
-        if (singleLine) {
-            endl = ", ";
-        }
-        fmt::print("Δ: {:.3f}{}Γ: {:.3f}{}Θ: {:.3f}{}ν: {:.3f}{}ρ: {:.3f}\n",
-                   delta(), endl, gamma(), endl, theta(), endl, vega(), endl, rho()
-        );
+    // Greeks, of which those outside of the selected outputs are not derived, so are NaN
+    constexpr auto delta() -> value_type { return derive(Output::Delta, [this] { return greeks_.template delta<Executor>(); }); }
+    constexpr auto gamma() -> value_type { return derive(Output::Gamma, [this] { return greeks_.gamma(); }); }
+    constexpr auto theta() -> value_type { return derive(Output::Theta, [this] { return greeks_.template theta<Executor>(); }); }
+    constexpr auto vega()  -> value_type { return derive(Output::Vega, [this] { return greeks_.vega(); }); }
+    constexpr auto rho()   -> value_type { return derive(Output::Rho, [this] { return greeks_.template rho<Executor>(); }); }
+
+    // Higher order greeks
+    constexpr auto vanna()  -> value_type { return derive(Output::Vanna, [this] { return greeks_.vanna(); }); }
+    constexpr auto volga()  -> value_type { return derive(Output::Volga, [this] { return greeks_.volga(); }); }
+    constexpr auto charm()  -> value_type { return derive(Output::Charm, [this] { return greeks_.template charm<Executor>(); }); }
+    constexpr auto speed()  -> value_type { return derive(Output::Speed, [this] { return greeks_.speed(); }); }
+    constexpr auto zomma()  -> value_type { return derive(Output::Zomma, [this] { return greeks_.zomma(); }); }
+    constexpr auto colour() -> value_type { return derive(Output::Colour, [this] { return greeks_.colour(); }); }
+
+    // Greek by output, for use where outputs are selected at runtime
+    constexpr auto greek(const Output output) -> value_type {
+        switch (output) {
+        case Output::Delta:  return delta();
+        case Output::Gamma:  return gamma();
+        case Output::Theta:  return theta();
+        case Output::Vega:   return vega();
+        case Output::Rho:    return rho();
+        case Output::Vanna:  return vanna();
+        case Output::Volga:  return volga();
+        case Output::Charm:  return charm();
+        case Output::Speed:  return speed();
+        case Output::Zomma:  return zomma();
+        case Output::Colour: return colour();
+        default:
+            throw std::runtime_error("Cannot derive greek of unknown output!");
+        }
     }
 
+    constexpr auto outputs() const -> OutputMask { return outputs_; }
+
 private:
+    static constexpr const value_type UNSELECTED = std::numeric_limits<value_type>::quiet_NaN();
+    static constexpr const bool CLOSED_FORM = std::is_same_v<Pricer, BlackScholes<value_type>>;
+
+    // Bumps of the inputs repriced by models without closed form greeks. These are coarser than
+    // those of FiniteDifference, as the prices of lattices and simulations are not smooth at
+    // finer scales than their steps and paths.
+    static constexpr const value_type SPOT_BUMP       = 1E-2; // relative to the underlying price
+    static constexpr const value_type VOLATILITY_BUMP = 1E-3;
+    static constexpr const value_type TIME_BUMP       = 1 / DAY_TO_YEAR;
+    static constexpr const value_type RATE_BUMP       = 1E-4;
+
+    template <typename ClosedForm>
+    constexpr auto derive(const Output output, ClosedForm &&closedForm) const -> value_type {
+        if (!outputs_.contains(output)) {
+            return UNSELECTED;
+        }
+        if constexpr (CLOSED_FORM) {
+            return closedForm();
+        }
+        else {
+            return reprice(output);
+        }
+    }
+
+    // First order greek of the model, by central differences of its prices over bumped inputs.
+    // Steps are truncated to half the distance to a bound of an input, so that inputs at a
+    // bound are differenced one sided. Spot and volatility bumps keep the discount factor of
+    // the contract, which may be of a discount curve.
+    auto reprice(const Output output) const -> value_type {
+        const auto &v = values_;
+        const auto price = [this](const OptionValues<value_type> &values) { return Executor()(pricer_, values); };
+        const auto discounted = [&](value_type spot, value_type vol) {
+            return price(OptionValues<value_type> { spot, v.strikePrice_, v.timeToExpiry_, vol, v.riskFreeInterest_,
+                                                    v.dividendYield_, v.interestDiscount_ });
+        };
+        const auto repriced = [&](value_type time, value_type rate) {
+            return price(OptionValues<value_type> { v.underlyingPrice_, v.strikePrice_, time, v.volatility_, rate, v.dividendYield_ });
+        };
+        const auto up = [](value_type value, value_type bump, value_type upper) { return std::min(bump, (upper - value) / 2); };
+        const auto down = [](value_type value, value_type bump, value_type lower) { return std::min(bump, (value - lower) / 2); };
+
+        switch (output) {
+        case Output::Delta:
+        case Output::Gamma: {
+            const auto spot = v.underlyingPrice_;
+            const auto u = up(spot, spot * SPOT_BUMP, MAX_PRICE), d = down(spot, spot * SPOT_BUMP, MIN_PRICE);
+            const auto upper = discounted(spot + u, v.volatility_), lower = discounted(spot - d, v.volatility_);
+            if (output == Output::Delta) {
+                return (upper - lower) / (u + d);
+            }
+            return 2 * ((upper * d) - (discounted(spot, v.volatility_) * (u + d)) + (lower * u)) / (u * d * (u + d));
+        }
+        case Output::Vega: {
+            const auto u = up(v.volatility_, VOLATILITY_BUMP, MAX_PC), d = down(v.volatility_, VOLATILITY_BUMP, MIN_PC);
+            return (discounted(v.underlyingPrice_, v.volatility_ + u) - discounted(v.underlyingPrice_, v.volatility_ - d)) / (u + d);
+        }
+        case Output::Theta: {
+            const auto u = up(v.timeToExpiry_, TIME_BUMP, MAX_EXPIRY / DAY_TO_YEAR), d = down(v.timeToExpiry_, TIME_BUMP, 0);
+            return -(repriced(v.timeToExpiry_ + u, v.riskFreeInterest_) - repriced(v.timeToExpiry_ - d, v.riskFreeInterest_)) / (u + d);
+        }
+        case Output::Rho: {
+            const auto u = up(v.riskFreeInterest_, RATE_BUMP, MAX_PC), d = down(v.riskFreeInterest_, RATE_BUMP, MIN_PC);
+            return (repriced(v.timeToExpiry_, v.riskFreeInterest_ + u) - repriced(v.timeToExpiry_, v.riskFreeInterest_ - d)) / (u + d);
+        }
+        default:
+            return UNSELECTED;
+        }
+    }
+
     OptionValues<value_type> values_;
     BlackScholes<value_type> bsm_;
+    Pricer pricer_;
+    OutputMask outputs_;
     Greeks<value_type> greeks_;
 };
 
+#ifdef BSM_EXTERN_TEMPLATES
+// Instantiated by libbsm, see lib/instantiations.cpp
+extern template struct OptionValues<float>;
+extern template struct OptionValues<double>;
+#endif
+
 } // bsm
 
 #endif
@@ -0,0 +1,335 @@
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <fmt/format.h>
+
+#include "aggregation.h"
+#include "batch.h"
+#include "chain.h"
+#include "options.h"
+#include "outputs.h"
+
+namespace bsm
+{
+
+// Print only the greeks within the selected outputs of a single option
+template <typename Executor, typename value_type, typename Pricer>
+void printGreeks(Option<Executor, value_type, Pricer> &option, const bool singleLine = false) {
+    const std::string_view endl = singleLine ? ", " : "\n";
+    std::string_view delim = "";
+    for (auto index = static_cast<std::size_t>(Output::Delta); index < NUM_OUTPUTS; ++index) {
+        const auto output = static_cast<Output>(index);
+        if (option.outputs().contains(output)) {
+            const auto precision = isHigherOrder(output) ? 5 : 3;
+            fmt::print("{}{}: {:.{}f}", delim, outputLabel(output), option.greek(output), precision);
+            delim = endl;
+        }
+    }
+    // Ended only where a greek was written, as the price line is ended by its caller
+    if (!delim.empty()) {
+        fmt::print("\n");
+    }
+}
+
+// Writes the selected outputs of each batch row, in input order.
+// Each batch is formatted into a single buffer, then written at once.
+template <typename value_type = double>
+class OutputWriter
+{
+public:
+    OutputWriter() = delete;
+    explicit OutputWriter(const OutputMask outputs, std::FILE *out = stdout)
+        : outputs_(outputs)
+        , out_(out)
+    {}
+
+    void write(const OptionBatch<value_type> &batch, const BatchResults<value_type> &results) {
+        const auto formatted = format(batch, results);
+        std::fwrite(formatted.data(), sizeof(char), formatted.size(), out_);
+    }
+
+    // Format rows as e.g. 'Call Option Value: 12.69 Δ: 0.743, Γ: 0.018'
+    auto format(const OptionBatch<value_type> &batch, const BatchResults<value_type> &results) -> std::string_view {
+        buffer_.clear();
+        for (std::size_t row = 0; row < batch.size(); ++row) {
+            const auto label = (batch.type_[row] == OptionType::Call) ? "Call" : "Put";
+            fmt::format_to(std::back_inserter(buffer_), "{} Option", label);
+            if (outputs_.contains(Output::Price)) {
+                fmt::format_to(std::back_inserter(buffer_), " {}: {:.2f}", outputLabel(Output::Price), results.price_[row]);
+            }
+
+            std::string_view delim = " ";
+            for (auto index = static_cast<std::size_t>(Output::Delta); index < NUM_OUTPUTS; ++index) {
+                const auto output = static_cast<Output>(index);
+                if (outputs_.contains(output)) {
+                    const auto precision = isHigherOrder(output) ? 5 : 3;
+                    fmt::format_to(std::back_inserter(buffer_), "{}{}: {:.{}f}",
+                                   delim, outputLabel(output), results.column(output)[row], precision);
+                    delim = ", ";
+                }
+            }
+            buffer_.push_back('\n');
+        }
+        return { buffer_.data(), buffer_.size() };
+    }
+
+private:
+    OutputMask outputs_;
+    std::FILE *out_;
+    fmt::memory_buffer buffer_;
+};
+
+// An NDJSON request line, echoed by its result as its raw "id" value, where given, else as
+// its line number within the input. Lines which are not contracts have no batch row.
+struct NdjsonRequest
+{
+    std::size_t line_ = 0;
+    std::string id_;
+    bool read_ = true;
+};
+
+// Writes the selected outputs of each batch row as an NDJSON object, in input order,
+// e.g. '{"option_type":"call","price":12.690561,"delta":0.743}'. Values are written
+// at the shortest precision which reads back exactly, and non-finite values as null.
+// Given the requests of the batch, each result is keyed by its request, and each
+// request which is not a contract is answered in turn by an error object, e.g.
+// '{"line":3,"error":"Cannot read contract"}', so results stay one to one with requests.
+template <typename value_type = double>
+class NdjsonWriter
+{
+public:
+    NdjsonWriter() = delete;
+    explicit NdjsonWriter(const OutputMask outputs, std::FILE *out = stdout)
+        : outputs_(outputs)
+        , out_(out)
+    {}
+
+    void write(const OptionBatch<value_type> &batch, const BatchResults<value_type> &results,
+               std::span<const NdjsonRequest> requests = {}) {
+        const auto formatted = format(batch, results, requests);
+        std::fwrite(formatted.data(), sizeof(char), formatted.size(), out_);
+    }
+
+    auto format(const OptionBatch<value_type> &batch, const BatchResults<value_type> &results,
+                std::span<const NdjsonRequest> requests = {}) -> std::string_view {
+        buffer_.clear();
+        if (requests.empty()) {
+            for (std::size_t row = 0; row < batch.size(); ++row) {
+                buffer_.push_back('{');
+                formatRow(batch, results, row);
+            }
+            return { buffer_.data(), buffer_.size() };
+        }
+
+        std::size_t row = 0;
+        for (const auto &request : requests) {
+            if (request.id_.empty()) {
+                fmt::format_to(std::back_inserter(buffer_), "{{\"line\":{},", request.line_);
+            }
+            else {
+                fmt::format_to(std::back_inserter(buffer_), "{{\"id\":{},", request.id_);
+            }
+            if (!request.read_) {
+                fmt::format_to(std::back_inserter(buffer_), "\"error\":\"Cannot read contract\"}}\n");
+            }
+            else if (row < batch.size()) {
+                formatRow(batch, results, row++);
+            }
+            else {
+                throw std::runtime_error(fmt::format("NDJSON request of line {} has no batch row", request.line_));
+            }
+        }
+        return { buffer_.data(), buffer_.size() };
+    }
+
+private:
+    // Members of the row, following those of its request, and the end of its object
+    void formatRow(const OptionBatch<value_type> &batch, const BatchResults<value_type> &results, const std::size_t row) {
+        const auto label = (batch.type_[row] == OptionType::Call) ? "call" : "put";
+        fmt::format_to(std::back_inserter(buffer_), "\"option_type\":\"{}\"", label);
+        for (std::size_t index = 0; index < NUM_OUTPUTS; ++index) {
+            const auto output = static_cast<Output>(index);
+            if (outputs_.contains(output)) {
+                const auto value = results.column(output)[row];
+                if (std::isfinite(value)) {
+                    fmt::format_to(std::back_inserter(buffer_), ",\"{}\":{}", outputName(output), value);
+                }
+                else {
+                    fmt::format_to(std::back_inserter(buffer_), ",\"{}\":null", outputName(output));
+                }
+            }
+        }
+        buffer_.push_back('}');
+        buffer_.push_back('\n');
+    }
+
+    OutputMask outputs_;
+    std::FILE *out_;
+    fmt::memory_buffer buffer_;
+};
+
+// Writes the selected outputs of the call and put at each strike of a chain, in strike order,
+// e.g. 'Strike 95.00 Call Value: 12.69 Δ: 0.743, Γ: 0.018 | Put Value: 2.51 Δ: -0.257, Γ: 0.018'
+template <typename value_type = double>
+class ChainWriter
+{
+public:
+    ChainWriter() = delete;
+    explicit ChainWriter(const OutputMask outputs, std::FILE *out = stdout)
+        : outputs_(outputs)
+        , out_(out)
+    {}
+
+    void write(const Chain<value_type> &chain, const ChainResults<value_type> &results) {
+        const auto formatted = format(chain, results);
+        std::fwrite(formatted.data(), sizeof(char), formatted.size(), out_);
+    }
+
+    auto format(const Chain<value_type> &chain, const ChainResults<value_type> &results) -> std::string_view {
+        buffer_.clear();
+        for (std::size_t strike = 0; strike < chain.size(); ++strike) {
+            fmt::format_to(std::back_inserter(buffer_), "Strike {:.2f} Call", chain.strikes_[strike]);
+            side(results.calls_, strike);
+            fmt::format_to(std::back_inserter(buffer_), " | Put");
+            side(results.puts_, strike);
+            buffer_.push_back('\n');
+        }
+        return { buffer_.data(), buffer_.size() };
+    }
+
+private:
+    void side(const BatchResults<value_type> &results, std::size_t strike) {
+        if (outputs_.contains(Output::Price)) {
+            fmt::format_to(std::back_inserter(buffer_), " {}: {:.2f}", outputLabel(Output::Price), results.price_[strike]);
+        }
+        std::string_view delim = " ";
+        for (auto index = static_cast<std::size_t>(Output::Delta); index < NUM_OUTPUTS; ++index) {
+            const auto output = static_cast<Output>(index);
+            if (outputs_.contains(output)) {
+                const auto precision = isHigherOrder(output) ? 5 : 3;
+                fmt::format_to(std::back_inserter(buffer_), "{}{}: {:.{}f}",
+                               delim, outputLabel(output), results.column(output)[strike], precision);
+                delim = ", ";
+            }
+        }
+    }
+
+    OutputMask outputs_;
+    std::FILE *out_;
+    fmt::memory_buffer buffer_;
+};
+
+// Writes the selected outputs of the call and put at each strike of a chain as an NDJSON
+// object, e.g. '{"strike":95,"call":{"price":12.690561},"put":{"price":2.509913}}', with
+// values written as by NdjsonWriter
+template <typename value_type = double>
+class NdjsonChainWriter
+{
+public:
+    NdjsonChainWriter() = delete;
+    explicit NdjsonChainWriter(const OutputMask outputs, std::FILE *out = stdout)
+        : outputs_(outputs)
+        , out_(out)
+    {}
+
+    void write(const Chain<value_type> &chain, const ChainResults<value_type> &results) {
+        const auto formatted = format(chain, results);
+        std::fwrite(formatted.data(), sizeof(char), formatted.size(), out_);
+    }
+
+    auto format(const Chain<value_type> &chain, const ChainResults<value_type> &results) -> std::string_view {
+        buffer_.clear();
+        for (std::size_t strike = 0; strike < chain.size(); ++strike) {
+            fmt::format_to(std::back_inserter(buffer_), "{{\"strike\":{},\"call\":", chain.strikes_[strike]);
+            side(results.calls_, strike);
+            fmt::format_to(std::back_inserter(buffer_), ",\"put\":");
+            side(results.puts_, strike);
+            buffer_.push_back('}');
+            buffer_.push_back('\n');
+        }
+        return { buffer_.data(), buffer_.size() };
+    }
+
+private:
+    void side(const BatchResults<value_type> &results, std::size_t strike) {
+        buffer_.push_back('{');
+        std::string_view delim = "";
+        for (std::size_t index = 0; index < NUM_OUTPUTS; ++index) {
+            const auto output = static_cast<Output>(index);
+            if (outputs_.contains(output)) {
+                const auto value = results.column(output)[strike];
+                if (std::isfinite(value)) {
+                    fmt::format_to(std::back_inserter(buffer_), "{}\"{}\":{}", delim, outputName(output), value);
+                }
+                else {
+                    fmt::format_to(std::back_inserter(buffer_), "{}\"{}\":null", delim, outputName(output));
+                }
+                delim = ",";
+            }
+        }
+        buffer_.push_back('}');
+    }
+
+    OutputMask outputs_;
+    std::FILE *out_;
+    fmt::memory_buffer buffer_;
+};
+
+// Writes the net risk of each group of positions, in key order, e.g.
+// 'Underlying 0 Expiry 3M Book * Positions: 2, Quantity: 150.00, Value: 1069.50 Δ: 112.403'
+// where collapsed keys are written as '*'
+class AggregateWriter
+{
+public:
+    AggregateWriter() = delete;
+    explicit AggregateWriter(const OutputMask outputs, std::FILE *out = stdout)
+        : outputs_(outputs)
+        , out_(out)
+    {}
+
+    void write(const std::map<RiskKey, Risk> &totals) {
+        const auto formatted = format(totals);
+        std::fwrite(formatted.data(), sizeof(char), formatted.size(), out_);
+    }
+
+    auto format(const std::map<RiskKey, Risk> &totals) -> std::string_view {
+        const auto id = [](std::uint32_t key) { return (key == ALL_KEYS) ? std::string("*") : std::to_string(key); };
+        buffer_.clear();
+        for (const auto &[key, risk] : totals) {
+            const auto expiry = (key.expiry_ == ALL_KEYS) ? std::string_view("*") : EXPIRY_BUCKET_LABELS[key.expiry_];
+            fmt::format_to(std::back_inserter(buffer_), "Underlying {} Expiry {} Book {} Positions: {}, Quantity: {:.2f}",
+                           id(key.underlying_), expiry, id(key.book_), risk.positions(), risk.quantity());
+            if (outputs_.contains(Output::Price)) {
+                fmt::format_to(std::back_inserter(buffer_), ", {}: {:.2f}", outputLabel(Output::Price), risk[Output::Price]);
+            }
+
+            std::string_view delim = " ";
+            for (auto index = static_cast<std::size_t>(Output::Delta); index < NUM_OUTPUTS; ++index) {
+                const auto output = static_cast<Output>(index);
+                if (outputs_.contains(output)) {
+                    const auto precision = isHigherOrder(output) ? 5 : 3;
+                    fmt::format_to(std::back_inserter(buffer_), "{}{}: {:.{}f}", delim, outputLabel(output), risk[output], precision);
+                    delim = ", ";
+                }
+            }
+            buffer_.push_back('\n');
+        }
+        return { buffer_.data(), buffer_.size() };
+    }
+
+private:
+    OutputMask outputs_;
+    std::FILE *out_;
+    fmt::memory_buffer buffer_;
+};
+
+} // bsm
+
+#endif
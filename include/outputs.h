@@ -0,0 +1,132 @@
+#ifndef OUTPUTS_H
+#define OUTPUTS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace bsm
+{
+
+// Values which may be derived for each option contract
+enum class Output : std::uint8_t
+{
+    Price,
+    // First order greeks
+    Delta,
+    Gamma,
+    Theta,
+    Vega,
+    Rho,
+    // Higher order greeks
+    Vanna,
+    Volga,
+    Charm,
+    Speed,
+    Zomma,
+    Colour,
+    Count,
+};
+
+static constexpr const auto NUM_OUTPUTS = static_cast<std::size_t>(Output::Count);
+
+// Selection of outputs to derive, so that only requested values are paid for
+class OutputMask
+{
+public:
+    constexpr OutputMask() = default;
+    constexpr OutputMask(std::initializer_list<Output> outputs) {
+        for (const auto output : outputs) {
+            set(output);
+        }
+    }
+
+    static constexpr auto firstOrder() -> OutputMask {
+        return { Output::Price, Output::Delta, Output::Gamma, Output::Theta, Output::Vega, Output::Rho };
+    }
+
+    static constexpr auto all() -> OutputMask {
+        OutputMask mask;
+        for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+            mask.set(static_cast<Output>(output));
+        }
+        return mask;
+    }
+
+    constexpr auto set(Output output) -> OutputMask& {
+        bits_ |= bit(output);
+        return *this;
+    }
+
+    constexpr auto contains(Output output) const -> bool { return (bits_ & bit(output)) != 0; }
+    constexpr auto intersects(OutputMask rhs) const -> bool { return (bits_ & rhs.bits_) != 0; }
+    constexpr auto empty() const -> bool { return bits_ == 0; }
+
+    constexpr auto operator==(const OutputMask &rhs) const -> bool = default;
+
+private:
+    static constexpr auto bit(Output output) -> std::uint32_t {
+        return std::uint32_t{1} << static_cast<std::uint32_t>(output);
+    }
+
+    std::uint32_t bits_ = 0;
+};
+
+// Price and greeks of a contract, of which only the selected outputs are derived
+template <typename value_type = double>
+struct Quote
+{
+    std::array<value_type, NUM_OUTPUTS> values_ {};
+
+    auto operator[](Output output) const -> value_type { return values_[static_cast<std::size_t>(output)]; }
+};
+
+// Name of each output, as selected by '--outputs'
+static constexpr const std::string_view OUTPUT_NAMES[NUM_OUTPUTS] {
+    "price", "delta", "gamma", "theta", "vega", "rho",
+    "vanna", "volga", "charm", "speed", "zomma", "colour",
+};
+
+// Label of each output, when printed
+static constexpr const std::string_view OUTPUT_LABELS[NUM_OUTPUTS] {
+    "Value", "Δ", "Γ", "Θ", "ν", "ρ",
+    "Vanna", "Volga", "Charm", "Speed", "Zomma", "Colour",
+};
+
+constexpr auto outputName(Output output)  -> std::string_view { return OUTPUT_NAMES[static_cast<std::size_t>(output)]; }
+constexpr auto outputLabel(Output output) -> std::string_view { return OUTPUT_LABELS[static_cast<std::size_t>(output)]; }
+
+// Higher order greeks are small in magnitude, so are printed at a higher precision
+constexpr auto isHigherOrder(Output output) -> bool { return output >= Output::Vanna; }
+
+// Parse a comma separated list of output names, e.g. 'price,delta,vega'
+inline auto parseOutputs(std::string_view list) -> OutputMask {
+    OutputMask mask;
+    while (!list.empty()) {
+        const auto pos = list.find(',');
+        const auto name = list.substr(0, pos);
+        bool found = false;
+        for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+            if (name == OUTPUT_NAMES[output]) {
+                mask.set(static_cast<Output>(output));
+                found = true;
+            }
+        }
+        if (!found) {
+            throw std::runtime_error("Unknown output requested: " + std::string(name));
+        }
+        list.remove_prefix((pos == std::string_view::npos) ? list.size() : pos + 1);
+    }
+    if (mask.empty()) {
+        throw std::runtime_error("At least one output must be requested");
+    }
+    return mask;
+}
+
+} // bsm
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <array>
+#include <cstdint>
+
+namespace bsm
+{
+
+// Philox4x32-10 counter based random number generator, as given by Salmon et al. (2011).
+// Each output block is a pure function of its key and counter, so independent streams
+// are derived from the key, and any draw within a stream may be generated directly,
+// without sequential state. Results are reproducible regardless of how work is split
+// across threads.
+class Philox4x32
+{
+public:
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    constexpr explicit Philox4x32(std::uint64_t seed = 0)
+        : key_ { static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) }
+    {}
+
+    constexpr explicit Philox4x32(Key key)
+        : key_(key)
+    {}
+
+    // Four uniformly distributed 32 bit integers, for the given counter
+    constexpr auto operator()(Counter counter) const -> Counter {
+        auto key = key_;
+        for (std::size_t round = 0; round < ROUNDS; ++round) {
+            counter = mix(counter, key);
+            key[0] += WEYL[0];
+            key[1] += WEYL[1];
+        }
+        return counter;
+    }
+
+    // Map an integer to a uniform value within the open interval (0, 1)
+    template <typename value_type>
+    static constexpr auto uniform(std::uint32_t bits) -> value_type {
+        return (static_cast<value_type>(bits) + static_cast<value_type>(0.5)) * static_cast<value_type>(0x1p-32);
+    }
+
+private:
+    static constexpr const std::size_t ROUNDS = 10;
+    static constexpr const std::uint32_t MULTIPLIERS[2] { 0xD2511F53, 0xCD9E8D57 };
+    static constexpr const std::uint32_t WEYL[2] { 0x9E3779B9, 0xBB67AE85 };
+
+    static constexpr auto mix(const Counter &counter, const Key &key) -> Counter {
+        const auto lhs = std::uint64_t{MULTIPLIERS[0]} * counter[0];
+        const auto rhs = std::uint64_t{MULTIPLIERS[1]} * counter[2];
+        return {
+            static_cast<std::uint32_t>(rhs >> 32) ^ counter[1] ^ key[0],
+            static_cast<std::uint32_t>(rhs),
+            static_cast<std::uint32_t>(lhs >> 32) ^ counter[3] ^ key[1],
+            static_cast<std::uint32_t>(lhs),
+        };
+    }
+
+    Key key_;
+};
+
+} // bsm
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include <cmath>
+
+namespace bsm
+{
+
+// Compensated (Kahan-Babuska-Neumaier) running sum, carrying the rounding error of
+// each addition, so that long reductions of mixed sign terms, such as long and short
+// position greeks, lose no more than a rounding of the final total. Partial sums may
+// be combined, e.g. those of parallel chunks, which should be combined in a fixed
+// order so that totals are reproducible bit for bit.
+class CompensatedSum
+{
+public:
+    constexpr CompensatedSum() = default;
+    constexpr explicit CompensatedSum(double value)
+        : sum_(value)
+    {}
+
+    constexpr auto operator+=(double value) -> CompensatedSum& {
+        const auto sum = sum_ + value;
+        // Recover the low order bits lost from whichever term is smaller in magnitude
+        compensation_ += (std::fabs(sum_) >= std::fabs(value)) ? (sum_ - sum) + value : (value - sum) + sum_;
+        sum_ = sum;
+        return *this;
+    }
+
+    constexpr auto operator+=(const CompensatedSum &rhs) -> CompensatedSum& {
+        *this += rhs.sum_;
+        compensation_ += rhs.compensation_;
+        return *this;
+    }
+
+    constexpr auto value() const -> double { return sum_ + compensation_; }
+
+private:
+    double sum_ = 0;
+    double compensation_ = 0;
+};
+
+} // bsm
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "options.h"
+#include "outputs.h"
+
+namespace bsm
+{
+
+static constexpr const std::size_t CACHE_SHARDS = 16;
+
+// Normalised inputs of a contract, after market data is applied, so that
+// contracts priced from equal inputs share a key. The discount factor is
+// included, as that of a discount curve need not be exactly exp(-rt).
+template <typename value_type = double>
+struct ContractKey
+{
+    ContractKey() = default;
+    ContractKey(OptionType type, const OptionValues<value_type> &values)
+        : ContractKey(type, std::array<value_type, 7> { values.underlyingPrice_, values.strikePrice_, values.timeToExpiry_, values.volatility_,
+                              values.riskFreeInterest_, values.dividendYield_, values.interestDiscount_ })
+    {}
+
+    // Values of underlying price, strike, time, volatility, rate, yield and discount factor
+    ContractKey(OptionType type, const std::array<value_type, 7> &values)
+        : type_(type)
+        , values_(values)
+    {
+        using Bits = std::conditional_t<sizeof(value_type) == 8, std::uint64_t, std::uint32_t>;
+        hash_ = static_cast<std::uint64_t>(type_) + 1;
+        for (auto &value : values_) {
+            value += value_type{0}; // -0 as +0
+            hash_ = (hash_ ^ std::bit_cast<Bits>(value)) * 0x9E3779B97F4A7C15ULL;
+            hash_ ^= hash_ >> 29;
+        }
+    }
+
+    auto operator==(const ContractKey &rhs) const -> bool {
+        return type_ == rhs.type_ && values_ == rhs.values_;
+    }
+
+    OptionType type_ = OptionType::None;
+    std::array<value_type, 7> values_ {};
+    std::uint64_t hash_ = 0;
+};
+
+template <typename value_type = double>
+struct ContractHash
+{
+    auto operator()(const ContractKey<value_type> &key) const -> std::size_t { return key.hash_; }
+};
+
+struct CacheStats
+{
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+    std::uint64_t evictions_ = 0;
+    std::size_t size_ = 0;
+
+    auto hitRate() const -> double {
+        const auto lookups = hits_ + misses_;
+        return (lookups > 0) ? static_cast<double>(hits_) / static_cast<double>(lookups) : 0.0;
+    }
+};
+
+// Bounded cache of the priced outputs of contracts, for repeated valuations of
+// unchanged contracts, as selected by '--cache'. The cache is split into shards
+// by key, each locked independently, so may be shared by concurrent pricers.
+// Each shard evicts by CLOCK, sparing entries hit since the hand last passed.
+// The capacity is split between the shards, of which there are no more than
+// entries. A cache holds the outputs of a single output selection and model,
+// that of the first pricer bound to it, so rejects pricers of any other.
+template <typename value_type = double>
+class ResultCache
+{
+public:
+    ResultCache() = delete;
+    explicit ResultCache(std::size_t capacity, const OutputMask outputs, std::size_t shards = CACHE_SHARDS)
+        : outputs_(outputs)
+        , capacity_(capacity)
+        , shards_(std::clamp<std::size_t>(shards, 1, std::max<std::size_t>(1, capacity)))
+    {
+        if (capacity == 0) {
+            throw std::runtime_error("Result cache capacity must be at least one");
+        }
+        for (std::size_t shard = 0; shard < shards_.size(); ++shard) {
+            shards_[shard].capacity_ = (capacity / shards_.size()) + (shard < capacity % shards_.size());
+        }
+    }
+
+    ResultCache(const ResultCache &) = delete;
+    auto operator=(const ResultCache &) -> ResultCache& = delete;
+
+    // Bind the cache to the model of a pricer, as the first pricer bound to it
+    // sets the model whose outputs it holds. Models are equal if of the same
+    // type and, where comparable, of equal settings.
+    template <typename Pricer>
+    void bind(const Pricer &pricer) {
+        std::lock_guard lock(modelMutex_);
+        if (!model_) {
+            model_ = [pricer](const std::type_info &type, const void *other) {
+                if (type != typeid(Pricer)) {
+                    return false;
+                }
+                if constexpr (std::equality_comparable<Pricer>) {
+                    return pricer == *static_cast<const Pricer*>(other);
+                }
+                return true;
+            };
+        }
+        else if (!model_(typeid(Pricer), &pricer)) {
+            throw std::runtime_error("Cannot share a result cache between different models");
+        }
+    }
+
+    auto find(const ContractKey<value_type> &key, Quote<value_type> &quote) -> bool {
+        auto &shard = shardOf(key);
+        {
+            std::lock_guard lock(shard.mutex_);
+            const auto found = shard.index_.find(key);
+            if (found != shard.index_.end()) {
+                auto &entry = shard.entries_[found->second];
+                entry.referenced_ = true;
+                quote = entry.quote_;
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void insert(const ContractKey<value_type> &key, const Quote<value_type> &quote) {
+        auto &shard = shardOf(key);
+        std::lock_guard lock(shard.mutex_);
+        if (shard.index_.contains(key)) {
+            return;
+        }
+
+        std::size_t slot = shard.entries_.size();
+        if (slot < shard.capacity_) {
+            shard.entries_.push_back({ key, quote, false });
+        }
+        else {
+            // Advance the hand past referenced entries, clearing their reference
+            while (shard.entries_[shard.hand_].referenced_) {
+                shard.entries_[shard.hand_].referenced_ = false;
+                shard.hand_ = (shard.hand_ + 1) % shard.entries_.size();
+            }
+            slot = shard.hand_;
+            shard.hand_ = (shard.hand_ + 1) % shard.entries_.size();
+            shard.index_.erase(shard.entries_[slot].key_);
+            shard.entries_[slot] = { key, quote, false };
+            evictions_.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.index_.emplace(key, slot);
+    }
+
+    auto stats() const -> CacheStats {
+        std::size_t size = 0;
+        for (auto &shard : shards_) {
+            std::lock_guard lock(shard.mutex_);
+            size += shard.entries_.size();
+        }
+        return { hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed),
+                 evictions_.load(std::memory_order_relaxed), size };
+    }
+
+    auto capacity() const -> std::size_t { return capacity_; }
+    auto outputs()  const -> OutputMask  { return outputs_; }
+
+private:
+    struct Entry
+    {
+        ContractKey<value_type> key_;
+        Quote<value_type> quote_;
+        bool referenced_ = false;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex_;
+        std::unordered_map<ContractKey<value_type>, std::size_t, ContractHash<value_type>> index_; // slot of each key
+        std::vector<Entry> entries_;
+        std::size_t hand_ = 0;
+        std::size_t capacity_ = 0;
+    };
+
+    // High bits pick the shard, as the low bits pick the bucket within it
+    auto shardOf(const ContractKey<value_type> &key) -> Shard& {
+        return shards_[(key.hash_ >> 40) % shards_.size()];
+    }
+
+    OutputMask outputs_;
+    std::size_t capacity_;
+    std::vector<Shard> shards_;
+    std::mutex modelMutex_;
+    std::function<bool(const std::type_info&, const void*)> model_; // whether a pricer is of the bound model
+    std::atomic<std::uint64_t> hits_ = 0;
+    std::atomic<std::uint64_t> misses_ = 0;
+    std::atomic<std::uint64_t> evictions_ = 0;
+};
+
+} // bsm
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef SOBOL_H
+#define SOBOL_H
+
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace bsm
+{
+
+static constexpr const std::size_t SOBOL_DIMENSIONS = 32;
+static constexpr const std::size_t SOBOL_BITS = 32;
+
+// Primitive polynomial and initial direction numbers of a Sobol dimension
+struct SobolDirection
+{
+    std::uint32_t degree_;        // s, degree of the primitive polynomial
+    std::uint32_t coefficients_;  // a, inner coefficients of the primitive polynomial
+    std::uint32_t initial_[7];    // m, initial direction numbers, of which the first s are used
+};
+
+// Direction numbers of dimensions 2 to 32, as given by Joe & Kuo (2008), 'new-joe-kuo-6.21201'.
+// The first dimension is the van der Corput sequence, which needs no direction numbers.
+static constexpr const SobolDirection SOBOL_DIRECTIONS[SOBOL_DIMENSIONS - 1] {
+    { 1, 0,  { 1 } },
+    { 2, 1,  { 1, 3 } },
+    { 3, 1,  { 1, 3, 1 } },
+    { 3, 2,  { 1, 1, 1 } },
+    { 4, 1,  { 1, 1, 3, 3 } },
+    { 4, 4,  { 1, 3, 5, 13 } },
+    { 5, 2,  { 1, 1, 5, 5, 17 } },
+    { 5, 4,  { 1, 1, 5, 5, 5 } },
+    { 5, 7,  { 1, 1, 7, 11, 19 } },
+    { 5, 11, { 1, 1, 5, 1, 1 } },
+    { 5, 13, { 1, 1, 1, 3, 11 } },
+    { 5, 14, { 1, 3, 5, 5, 31 } },
+    { 6, 1,  { 1, 3, 3, 9, 7, 49 } },
+    { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+    { 6, 16, { 1, 3, 1, 13, 27, 49 } },
+    { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+    { 6, 22, { 1, 3, 1, 15, 13, 25 } },
+    { 6, 25, { 1, 1, 5, 5, 19, 61 } },
+    { 7, 1,  { 1, 3, 7, 11, 23, 15, 103 } },
+    { 7, 4,  { 1, 3, 7, 13, 13, 15, 69 } },
+    { 7, 7,  { 1, 1, 3, 13, 7, 35, 63 } },
+    { 7, 8,  { 1, 3, 5, 9, 1, 25, 53 } },
+    { 7, 14, { 1, 3, 1, 13, 9, 35, 107 } },
+    { 7, 19, { 1, 3, 1, 5, 27, 61, 31 } },
+    { 7, 21, { 1, 1, 5, 11, 19, 41, 61 } },
+    { 7, 28, { 1, 3, 5, 3, 3, 13, 69 } },
+    { 7, 31, { 1, 1, 7, 13, 1, 19, 1 } },
+    { 7, 32, { 1, 3, 7, 5, 13, 19, 59 } },
+    { 7, 37, { 1, 1, 3, 9, 25, 29, 41 } },
+    { 7, 41, { 1, 3, 5, 13, 23, 1, 55 } },
+    { 7, 42, { 1, 3, 7, 3, 13, 59, 17 } },
+};
+
+// Sobol low discrepancy sequence, of up to 32 dimensions, in Gray code order.
+// Points are returned as 32 bit integers, to be scaled (and scrambled) by the caller.
+// Any point may be generated directly from its index, so blocks of points may be
+// generated independently, and then each following point by a single XOR per dimension.
+class Sobol
+{
+public:
+    explicit Sobol(std::size_t dimensions)
+        : dimensions_(dimensions)
+    {
+        if (dimensions_ < 1 || dimensions_ > SOBOL_DIMENSIONS) {
+            throw std::runtime_error("Sobol sequences support between one and 32 dimensions");
+        }
+        directions_.resize(dimensions_ * SOBOL_BITS);
+
+        for (std::size_t bit = 0; bit < SOBOL_BITS; ++bit) {
+            direction(0, bit) = std::uint32_t{1} << (SOBOL_BITS - 1 - bit);
+        }
+        for (std::size_t dim = 1; dim < dimensions_; ++dim) {
+            const auto &poly = SOBOL_DIRECTIONS[dim - 1];
+            const auto degree = poly.degree_;
+            for (std::size_t bit = 0; bit < SOBOL_BITS; ++bit) {
+                if (bit < degree) {
+                    direction(dim, bit) = poly.initial_[bit] << (SOBOL_BITS - 1 - bit);
+                    continue;
+                }
+                auto value = direction(dim, bit - degree) ^ (direction(dim, bit - degree) >> degree);
+                for (std::size_t term = 1; term < degree; ++term) {
+                    if ((poly.coefficients_ >> (degree - 1 - term)) & 1) {
+                        value ^= direction(dim, bit - term);
+                    }
+                }
+                direction(dim, bit) = value;
+            }
+        }
+    }
+
+    auto dimensions() const -> std::size_t { return dimensions_; }
+
+    // Write count consecutive points, from the given index, as rows of the output
+    void generate(std::uint64_t first, std::size_t count, std::span<std::uint32_t> points) const {
+        if (points.size() < count * dimensions_) {
+            throw std::runtime_error("Insufficient space for Sobol points");
+        }
+        if (first + count > (std::uint64_t{1} << SOBOL_BITS)) {
+            throw std::runtime_error("Sobol sequences support at most 2^32 points");
+        }
+        if (count == 0) {
+            return;
+        }
+
+        const auto gray = first ^ (first >> 1);
+        for (std::size_t dim = 0; dim < dimensions_; ++dim) {
+            std::uint32_t value = 0;
+            for (std::size_t bit = 0; bit < SOBOL_BITS; ++bit) {
+                if ((gray >> bit) & 1) {
+                    value ^= direction(dim, bit);
+                }
+            }
+            points[dim] = value;
+        }
+
+        for (std::size_t point = 1; point < count; ++point) {
+            // Successive Gray codes differ in the lowest zero bit of the previous index
+            const auto bit = static_cast<std::size_t>(std::countr_one(first + point - 1));
+            const auto *previous = &points[(point - 1) * dimensions_];
+            auto *next = &points[point * dimensions_];
+            for (std::size_t dim = 0; dim < dimensions_; ++dim) {
+                next[dim] = previous[dim] ^ direction(dim, bit);
+            }
+        }
+    }
+
+private:
+    auto direction(std::size_t dim, std::size_t bit) -> std::uint32_t& { return directions_[(dim * SOBOL_BITS) + bit]; }
+    auto direction(std::size_t dim, std::size_t bit) const -> std::uint32_t { return directions_[(dim * SOBOL_BITS) + bit]; }
+
+    std::size_t dimensions_;
+    std::vector<std::uint32_t> directions_; // by dimension, then bit
+};
+
+} // bsm
+
+#endif
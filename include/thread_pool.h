@@ -0,0 +1,235 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "topology.h"
+
+namespace bsm
+{
+
+static constexpr const std::size_t CHUNK_SIZE = 256;
+
+// Default to one thread per available core
+inline auto defaultThreads() -> std::size_t {
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Placement of pool threads on the machine, as selected by '--affinity'
+enum class Placement
+{
+    None,   // threads float across all CPUs, and chunks are shared by all threads
+    Nodes,  // each worker is pinned to the CPUs of a NUMA node
+    Cores,  // each worker is pinned to a single CPU
+};
+
+inline auto parsePlacement(std::string_view name) -> Placement {
+    if (name == "none") {
+        return Placement::None;
+    }
+    if (name == "nodes") {
+        return Placement::Nodes;
+    }
+    if (name == "cores") {
+        return Placement::Cores;
+    }
+    throw std::runtime_error("Unknown thread placement requested: " + std::string(name));
+}
+
+// Fixed size pool of worker threads, for data parallel loops.
+// Work is always split into the same fixed size chunks, regardless of the
+// number of threads, so results written per chunk do not depend on scheduling.
+// The calling thread takes part in each loop. Loops must not be nested.
+//
+// Pinned pools spread their threads across NUMA nodes, in proportion to each
+// node's CPUs, and split each loop's chunks into contiguous ranges per node, in
+// proportion to its threads. Threads take chunks from their own node's range
+// before stealing from others, so a chunk is usually processed, and its output
+// first touched, on the same node each loop. The calling thread is not pinned,
+// and takes its chunks from the first node.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t threads = defaultThreads(), Placement placement = Placement::None)
+        : ThreadPool(threads, placement, (placement == Placement::None) ? std::vector<NumaNode> {} : discoverTopology())
+    {}
+
+    explicit ThreadPool(std::size_t threads, Placement placement, const std::vector<NumaNode> &topology) {
+        threads = std::max<std::size_t>(1, threads);
+        nodes_ = (placement == Placement::None || topology.empty()) ? 1 : topology.size();
+        queues_ = std::make_unique<Queue[]>(nodes_);
+        nodeThreads_.assign(nodes_, 0);
+
+        // Thread t takes CPU t * cpus / threads, of all CPUs listed node by node
+        std::vector<std::pair<std::size_t, std::uint32_t>> cpus; // node index, CPU
+        for (std::size_t node = 0; node < nodes_ && placement != Placement::None; ++node) {
+            for (const auto cpu : topology[node].cpus_) {
+                cpus.emplace_back(node, cpu);
+            }
+        }
+        const auto place = [&](std::size_t thread) -> std::pair<std::size_t, std::uint32_t> {
+            return cpus.empty() ? std::pair<std::size_t, std::uint32_t> { 0, 0 } : cpus[(thread * cpus.size()) / threads];
+        };
+
+        ++nodeThreads_[place(0).first];
+        workers_.reserve(threads - 1);
+        for (std::size_t i = 1; i < threads; ++i) {
+            const auto [node, cpu] = place(i);
+            ++nodeThreads_[node];
+            std::vector<std::uint32_t> affinity;
+            if (placement == Placement::Cores) {
+                affinity.push_back(cpu);
+            }
+            else if (placement == Placement::Nodes) {
+                affinity = topology[node].cpus_;
+            }
+            workers_.emplace_back([this, node, affinity = std::move(affinity)]() {
+                if (!affinity.empty()) {
+                    pinThread(affinity);
+                }
+                workerLoop(node);
+            });
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    auto operator=(const ThreadPool &) -> ThreadPool& = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    auto size()  const -> std::size_t { return workers_.size() + 1; }
+    auto nodes() const -> std::size_t { return nodes_; }
+
+    // Call fn(begin, end) over each chunk of [0, count), blocking until all chunks are complete.
+    // The first exception thrown by any chunk is rethrown to the caller.
+    template <typename Fn>
+    void parallelFor(std::size_t count, std::size_t chunk, Fn &&fn) {
+        chunk = std::max<std::size_t>(1, chunk);
+        const auto chunks = (count + chunk - 1) / chunk;
+        const auto run = [&](std::size_t index) {
+            const auto begin = index * chunk;
+            fn(begin, std::min(begin + chunk, count));
+        };
+
+        if (workers_.empty() || chunks <= 1) {
+            for (std::size_t index = 0; index < chunks; ++index) {
+                run(index);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            task_ = run;
+            // Node n takes the chunks in proportion to threads on nodes [0, n]
+            std::size_t threads = 0, begin = 0;
+            for (std::size_t node = 0; node < nodes_; ++node) {
+                threads += nodeThreads_[node];
+                const auto end = (chunks * threads) / size();
+                queues_[node].next_ = begin;
+                queues_[node].end_ = end;
+                begin = end;
+            }
+            pending_ = workers_.size();
+            error_ = nullptr;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        work(0);
+
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this]() { return pending_ == 0; });
+        task_ = nullptr;
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    // Contiguous range of a loop's chunks, preferentially run by one node
+    struct Queue
+    {
+        std::atomic<std::size_t> next_ = 0;  // next chunk index to run
+        std::size_t end_ = 0;
+    };
+
+    // Run the chunks of the given node, then steal those of the following nodes
+    void work(std::size_t node) {
+        for (std::size_t offset = 0; offset < nodes_; ++offset) {
+            auto &queue = queues_[(node + offset) % nodes_];
+            for (auto index = queue.next_.fetch_add(1); index < queue.end_; index = queue.next_.fetch_add(1)) {
+                try {
+                    task_(index);
+                }
+                catch (...) {
+                    std::lock_guard lock(mutex_);
+                    if (!error_) {
+                        error_ = std::current_exception();
+                    }
+                }
+            }
+        }
+    }
+
+    void workerLoop(std::size_t node) {
+        std::uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+            }
+
+            work(node);
+
+            std::lock_guard lock(mutex_);
+            if (--pending_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    std::function<void(std::size_t)> task_; // current loop body, by chunk index
+    std::size_t nodes_ = 1;
+    std::unique_ptr<Queue[]> queues_;       // chunks of current loop, by node
+    std::vector<std::size_t> nodeThreads_;  // threads of the pool, by node
+    std::size_t pending_ = 0;               // workers yet to finish current loop
+    std::uint64_t generation_ = 0;          // incremented for each loop
+    std::exception_ptr error_;
+    bool stop_ = false;
+};
+
+} // bsm
+
+#endif
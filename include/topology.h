@@ -0,0 +1,105 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace bsm
+{
+
+static constexpr const std::string_view NODE_ROOT = "/sys/devices/system/node";
+
+// A NUMA node, and the CPUs local to it
+struct NumaNode
+{
+    std::uint32_t id_ = 0;
+    std::vector<std::uint32_t> cpus_;
+};
+
+// Parse a kernel CPU list, e.g. '0-3,8,10-11'. Malformed lists yield no CPUs.
+inline auto parseCpuList(std::string_view list) -> std::vector<std::uint32_t> {
+    std::vector<std::uint32_t> cpus;
+    while (!list.empty() && (list.back() == '\n' || list.back() == ' ')) {
+        list.remove_suffix(1);
+    }
+    while (!list.empty()) {
+        const auto pos = list.find(',');
+        const auto range = list.substr(0, pos);
+        const auto dash = range.find('-');
+        std::uint32_t first = 0, last = 0;
+        const auto lhs = range.substr(0, dash);
+        const auto rhs = (dash == std::string_view::npos) ? lhs : range.substr(dash + 1);
+        const auto [lhsEnd, lhsError] = std::from_chars(lhs.data(), lhs.data() + lhs.size(), first);
+        const auto [rhsEnd, rhsError] = std::from_chars(rhs.data(), rhs.data() + rhs.size(), last);
+        if (lhsError != std::errc() || rhsError != std::errc()
+            || lhsEnd != lhs.data() + lhs.size() || rhsEnd != rhs.data() + rhs.size() || last < first) {
+            return {};
+        }
+        for (auto cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+        list.remove_prefix((pos == std::string_view::npos) ? list.size() : pos + 1);
+    }
+    return cpus;
+}
+
+// NUMA nodes with CPUs, as listed under sysfs. Where NUMA is unavailable, or the
+// listing is unreadable, all available CPUs are reported as a single node.
+inline auto discoverTopology(const std::string &root = std::string(NODE_ROOT)) -> std::vector<NumaNode> {
+    const auto read = [](const std::string &path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    };
+
+    std::vector<NumaNode> nodes;
+    for (const auto id : parseCpuList(read(root + "/online"))) {
+        auto cpus = parseCpuList(read(root + "/node" + std::to_string(id) + "/cpulist"));
+        if (!cpus.empty()) {
+            nodes.push_back({ id, std::move(cpus) });
+        }
+    }
+
+    if (nodes.empty()) {
+        NumaNode node;
+        const auto cpus = std::max(1U, std::thread::hardware_concurrency());
+        for (std::uint32_t cpu = 0; cpu < cpus; ++cpu) {
+            node.cpus_.push_back(cpu);
+        }
+        nodes.push_back(std::move(node));
+    }
+    return nodes;
+}
+
+// Restrict the calling thread to the given CPUs. Returns false, leaving
+// the thread unpinned, where affinity is unsupported or the CPUs are invalid.
+inline auto pinThread([[maybe_unused]] std::span<const std::uint32_t> cpus) -> bool {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return CPU_COUNT(&set) > 0 && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+} // bsm
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef VOL_SURFACE_H
+#define VOL_SURFACE_H
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "constants.h"
+
+namespace bsm
+{
+
+// Surface id of rows priced at their own volatility
+static constexpr const std::uint32_t NO_SURFACE = std::numeric_limits<std::uint32_t>::max();
+
+// Surfaces are indexed densely by id, so ids are bounded
+static constexpr const std::uint32_t MAX_SURFACE_ID = 65535;
+
+// Strictly increasing grid axis. Regularly spaced axes are bracketed in constant time,
+// irregular axes by binary search. Points beyond either end are clamped to it.
+template <typename value_type = double>
+class GridAxis
+{
+public:
+    GridAxis() = default;
+    explicit GridAxis(std::vector<value_type> nodes)
+        : nodes_(std::move(nodes))
+    {
+        if (nodes_.empty()) {
+            throw std::runtime_error("Volatility surface axis requires at least one node");
+        }
+        for (std::size_t i = 1; i < nodes_.size(); ++i) {
+            if (!(nodes_[i] > nodes_[i - 1])) {
+                throw std::runtime_error("Volatility surface axis must be strictly increasing");
+            }
+        }
+
+        if (nodes_.size() > 1) {
+            const auto step = (nodes_.back() - nodes_.front()) / static_cast<value_type>(nodes_.size() - 1);
+            regular_ = std::all_of(nodes_.begin(), nodes_.end(), [&, i = std::size_t{0}](value_type node) mutable {
+                return std::fabs(node - (nodes_.front() + (step * static_cast<value_type>(i++)))) <= step * REGULAR_TOLERANCE;
+            });
+            inverseStep_ = 1 / step;
+        }
+    }
+
+    auto size()    const -> std::size_t { return nodes_.size(); }
+    auto regular() const -> bool        { return regular_; }
+    auto operator[](std::size_t i) const -> value_type { return nodes_[i]; }
+
+    // Index of the interval [node i, node i + 1] containing x, and the offset of x within it
+    auto bracket(value_type x) const -> std::pair<std::size_t, value_type> {
+        const auto last = nodes_.size() - 1;
+        if (last == 0 || x <= nodes_.front()) {
+            return { 0, 0 };
+        }
+        if (x >= nodes_.back()) {
+            return { last - 1, nodes_[last] - nodes_[last - 1] };
+        }
+
+        std::size_t i = 0;
+        if (regular_) {
+            // Rounding may place x one interval out, about a node
+            i = std::min(static_cast<std::size_t>((x - nodes_.front()) * inverseStep_), last - 1);
+            i -= (i > 0 && x < nodes_[i]);
+            i += (i + 1 < last && x >= nodes_[i + 1]);
+        }
+        else {
+            i = static_cast<std::size_t>(std::upper_bound(nodes_.begin(), nodes_.end(), x) - nodes_.begin()) - 1;
+        }
+        return { i, x - nodes_[i] };
+    }
+
+private:
+    static constexpr const auto REGULAR_TOLERANCE = 1E-9;
+
+    std::vector<value_type> nodes_;
+    value_type inverseStep_ = 0;
+    bool regular_ = false;
+};
+
+// Implied volatility surface over moneyness (strike / spot) and time to expiry.
+// Each expiry's smile is interpolated by natural cubic spline over moneyness, with
+// the coefficients of every interval precomputed and stored contiguously, expiry by
+// expiry, so a lookup evaluates just two cubics, with no search on regular grids.
+// Between expiries, total variance is interpolated linearly. Volatility is
+// extrapolated flat beyond the grid.
+template <typename value_type = double>
+class VolSurface
+{
+public:
+    VolSurface() = default;
+
+    // Volatilities are given by expiry, then moneyness
+    explicit VolSurface(std::vector<value_type> moneyness,
+                        std::vector<value_type> expiries,
+                        const std::vector<value_type> &volatilities)
+        : moneyness_(std::move(moneyness))
+        , expiries_(std::move(expiries))
+    {
+        if (moneyness_.size() < 2) {
+            throw std::runtime_error("Volatility surface requires at least two moneyness nodes");
+        }
+        if (volatilities.size() != moneyness_.size() * expiries_.size()) {
+            throw std::runtime_error("Volatility surface requires a volatility for every grid node");
+        }
+        for (const auto vol : volatilities) {
+            if (vol < MIN_PC || vol >= MAX_PC) {
+                throw std::runtime_error("Volatility surface nodes must be decimal percentages");
+            }
+        }
+        for (std::size_t i = 0; i < expiries_.size(); ++i) {
+            if (expiries_[i] <= 0) {
+                throw std::runtime_error("Volatility surface expiries must be greater than zero");
+            }
+        }
+
+        splines_.reserve(expiries_.size() * (moneyness_.size() - 1));
+        for (std::size_t expiry = 0; expiry < expiries_.size(); ++expiry) {
+            fitSpline(&volatilities[expiry * moneyness_.size()]);
+        }
+    }
+
+    auto empty() const -> bool { return splines_.empty(); }
+
+    auto volatility(const value_type spot, const value_type strike, const value_type expiry) const -> value_type {
+        return volatility(strike / spot, expiry);
+    }
+
+    auto volatility(const value_type moneyness, const value_type expiry) const -> value_type {
+        const auto [strike, offset] = moneyness_.bracket(moneyness);
+        const auto [index, elapsed] = expiries_.bracket(expiry);
+        const auto intervals = moneyness_.size() - 1;
+
+        const auto smile = [&](std::size_t i) {
+            const auto &spline = splines_[(i * intervals) + strike];
+            return std::max<value_type>(0, spline.a_ + (offset * (spline.b_ + (offset * (spline.c_ + (offset * spline.d_))))));
+        };
+
+        const auto near = smile(index);
+        if (expiries_.size() == 1 || expiry <= expiries_[0]) {
+            return near;
+        }
+        const auto far = smile(index + 1);
+        if (expiry >= expiries_[expiries_.size() - 1]) {
+            return far;
+        }
+
+        const auto t0 = expiries_[index];
+        const auto t1 = expiries_[index + 1];
+        const auto weight = elapsed / (t1 - t0);
+        const auto variance = ((1 - weight) * near * near * t0) + (weight * far * far * t1);
+        return std::sqrt(variance / expiry);
+    }
+
+private:
+    // Cubic over an interval, in the offset from its left node
+    struct Spline
+    {
+        value_type a_, b_, c_, d_;
+    };
+
+    // Natural cubic spline through one expiry's volatilities, by the tridiagonal algorithm
+    void fitSpline(const value_type *vols) {
+        const auto n = moneyness_.size();
+        std::vector<value_type> h(n - 1), curvature(n, 0), upper(n, 0), rhs(n, 0);
+        for (std::size_t i = 0; i + 1 < n; ++i) {
+            h[i] = moneyness_[i + 1] - moneyness_[i];
+        }
+
+        for (std::size_t i = 1; i + 1 < n; ++i) {
+            const auto slope = 3 * (((vols[i + 1] - vols[i]) / h[i]) - ((vols[i] - vols[i - 1]) / h[i - 1]));
+            const auto pivot = (2 * (h[i - 1] + h[i])) - (h[i - 1] * upper[i - 1]);
+            upper[i] = h[i] / pivot;
+            rhs[i] = (slope - (h[i - 1] * rhs[i - 1])) / pivot;
+        }
+        for (std::size_t i = n - 1; i-- > 1; ) {
+            curvature[i] = rhs[i] - (upper[i] * curvature[i + 1]);
+        }
+
+        for (std::size_t i = 0; i + 1 < n; ++i) {
+            splines_.push_back({
+                vols[i],
+                ((vols[i + 1] - vols[i]) / h[i]) - (h[i] * (curvature[i + 1] + (2 * curvature[i])) / 3),
+                curvature[i],
+                (curvature[i + 1] - curvature[i]) / (3 * h[i]),
+            });
+        }
+    }
+
+    GridAxis<value_type> moneyness_;
+    GridAxis<value_type> expiries_;
+    std::vector<Spline> splines_; // by expiry, then moneyness interval
+};
+
+// Read surfaces from CSV rows of 'surface_id,expiry,moneyness,volatility', e.g. as given
+// by '--surfaces'. Each surface must define a volatility for every combination of its
+// expiries and moneyness nodes. Surfaces are returned indexed by id.
+template <typename value_type = double>
+auto readSurfaces(std::istream &input) -> std::vector<VolSurface<value_type>> {
+    using Grid = std::map<value_type, std::map<value_type, value_type>>; // expiry, moneyness, volatility
+    std::map<std::uint32_t, Grid> grids;
+
+    const auto parse = [](std::string_view field, auto &value) {
+        const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (error != std::errc() || end != field.data() + field.size()) {
+            throw std::runtime_error("Cannot parse volatility surface field: " + std::string(field));
+        }
+    };
+
+    for (std::string line; std::getline(input, line); ) {
+        if (line.empty() || line.starts_with("surface_id")) {
+            continue;
+        }
+        std::string_view fields[4];
+        std::string_view rest = line;
+        for (auto &field : fields) {
+            const auto pos = rest.find(',');
+            field = rest.substr(0, pos);
+            rest.remove_prefix((pos == std::string_view::npos) ? rest.size() : pos + 1);
+        }
+
+        std::uint32_t id = 0;
+        value_type expiry = 0, moneyness = 0, volatility = 0;
+        parse(fields[0], id);
+        if (id > MAX_SURFACE_ID) {
+            throw std::runtime_error("Volatility surface id cannot be greater than " + std::to_string(MAX_SURFACE_ID)
+                                     + ": " + std::string(fields[0]));
+        }
+        parse(fields[1], expiry);
+        parse(fields[2], moneyness);
+        parse(fields[3], volatility);
+        grids[id][expiry][moneyness] = volatility;
+    }
+
+    std::vector<VolSurface<value_type>> surfaces(grids.empty() ? 0 : std::size_t{grids.rbegin()->first} + 1);
+    for (const auto &[id, grid] : grids) {
+        std::vector<value_type> expiries, moneyness, volatilities;
+        for (const auto &[node, vol] : grid.begin()->second) {
+            moneyness.push_back(node);
+        }
+        for (const auto &[expiry, smile] : grid) {
+            if (smile.size() != moneyness.size()
+                || !std::equal(smile.begin(), smile.end(), moneyness.begin(), [](const auto &lhs, value_type rhs) { return lhs.first == rhs; })) {
+                throw std::runtime_error("Volatility surface " + std::to_string(id) + " must define every moneyness node at every expiry");
+            }
+            expiries.push_back(expiry);
+            for (const auto &[node, vol] : smile) {
+                volatilities.push_back(vol);
+            }
+        }
+        surfaces[id] = VolSurface<value_type>(std::move(moneyness), std::move(expiries), volatilities);
+    }
+    return surfaces;
+}
+
+} // bsm
+
+#endif
@@ -0,0 +1,119 @@
+#include "bsm_c.h"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <string>
+
+#include "batch.h"
+#include "kernel.h"
+#include "options.h"
+#include "outputs.h"
+
+using namespace bsm;
+
+namespace
+{
+
+thread_local std::string lastError;
+
+auto fail(int status, std::string message) -> int {
+    lastError = std::move(message);
+    return status;
+}
+
+// Result column of each output, in output order
+template <typename value_type, typename Results>
+auto columns(Results &results) -> std::array<value_type*, NUM_OUTPUTS> {
+    return {
+        results.price, results.delta, results.gamma, results.theta, results.vega, results.rho,
+        results.vanna, results.volga, results.charm, results.speed, results.zomma, results.colour,
+    };
+}
+
+template <typename value_type, typename Columns, typename Results>
+auto priceBatch(const Columns *in, Results *out, kernel::Kernel<value_type> kernel) -> int {
+    lastError.clear();
+    if (in == nullptr || out == nullptr) {
+        return fail(BSM_INVALID_ARGUMENT, "Columns and results must not be null");
+    }
+    if (in->rows > 0 && (in->type == nullptr || in->underlying_price == nullptr || in->strike_price == nullptr
+                         || in->time_to_expiry == nullptr || in->volatility == nullptr || in->risk_free_interest == nullptr)) {
+        return fail(BSM_INVALID_ARGUMENT, "Contract columns must not be null");
+    }
+
+    const auto outColumns = columns<value_type>(*out);
+    OutputMask outputs;
+    for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+        if (outColumns[output] != nullptr) {
+            outputs.set(static_cast<Output>(output));
+        }
+    }
+    if (outputs.empty()) {
+        return fail(BSM_INVALID_ARGUMENT, "At least one result column must be given");
+    }
+
+    thread_local OptionBatch<value_type> batch;
+    thread_local BatchResults<value_type> results;
+    for (std::size_t begin = 0; begin < in->rows; begin += BATCH_SIZE) {
+        const auto end = std::min(begin + BATCH_SIZE, in->rows);
+        batch.clear();
+        for (auto row = begin; row < end; ++row) {
+            const auto type = in->type[row];
+            if (type != BSM_CALL && type != BSM_PUT) {
+                return fail(BSM_INVALID_ROW, "Row " + std::to_string(row) + ": unknown option type");
+            }
+            try {
+                batch.push((type == BSM_CALL) ? OptionType::Call : OptionType::Put,
+                           OptionValues<value_type> {
+                               in->underlying_price[row], in->strike_price[row], in->time_to_expiry[row],
+                               in->volatility[row], in->risk_free_interest[row],
+                               (in->dividend_yield != nullptr) ? in->dividend_yield[row] : value_type{0} });
+            }
+            catch (const std::exception &e) {
+                return fail(BSM_INVALID_ROW, "Row " + std::to_string(row) + ": " + e.what());
+            }
+        }
+
+        try {
+            kernel(batch, results, outputs);
+        }
+        catch (const std::exception &e) {
+            return fail(BSM_FAILURE, e.what());
+        }
+
+        for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+            if (outColumns[output] != nullptr) {
+                const auto &column = results.column(static_cast<Output>(output));
+                std::copy(column.begin(), column.end(), outColumns[output] + begin);
+            }
+        }
+    }
+    return BSM_OK;
+}
+
+} // anonymous
+
+extern "C" {
+
+int bsm_abi_version(void) {
+    return BSM_ABI_VERSION;
+}
+
+const char *bsm_kernel_isa(void) {
+    return kernel::select().isa_;
+}
+
+int bsm_price_batch_d(const bsm_columns_d *columns, bsm_results_d *results) {
+    return priceBatch<double>(columns, results, kernel::select().double_);
+}
+
+int bsm_price_batch_f(const bsm_columns_f *columns, bsm_results_f *results) {
+    return priceBatch<float>(columns, results, kernel::select().float_);
+}
+
+const char *bsm_last_error(void) {
+    return lastError.c_str();
+}
+
+} // extern "C"
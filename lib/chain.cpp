@@ -0,0 +1,38 @@
+#include "chain.h"
+
+#include "kernel.h"
+
+namespace bsm
+{
+
+namespace
+{
+
+// Chains of more strikes than a chunk are split across the pool, each chunk
+// priced by the kernel into its own rows of the results
+template <typename value_type>
+void price(const Chain<value_type> &chain, ChainResults<value_type> &results, const OutputMask outputs,
+           ThreadPool *pool, kernel::ChainKernel<value_type> kernel) {
+    ChainPricer<value_type>::validate(chain);
+    results.calls_.resize(chain.size(), outputs);
+    results.puts_.resize(chain.size(), outputs);
+    if (pool == nullptr || chain.size() <= CHUNK_SIZE) {
+        kernel(chain, 0, chain.size(), results, outputs);
+        return;
+    }
+    pool->parallelFor(chain.size(), CHUNK_SIZE, [&](std::size_t begin, std::size_t end) {
+        kernel(chain, begin, end, results, outputs);
+    });
+}
+
+} // anonymous
+
+void priceChain(const Chain<double> &chain, ChainResults<double> &results, const OutputMask outputs, ThreadPool *pool) {
+    price(chain, results, outputs, pool, kernel::select().chainDouble_);
+}
+
+void priceChain(const Chain<float> &chain, ChainResults<float> &results, const OutputMask outputs, ThreadPool *pool) {
+    price(chain, results, outputs, pool, kernel::select().chainFloat_);
+}
+
+} // bsm
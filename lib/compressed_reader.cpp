@@ -0,0 +1,334 @@
+#include "compressed_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include "input_reader.h"
+
+#if defined(BSM_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(BSM_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace bsm
+{
+
+auto compressionSupported(Compression compression) -> bool {
+    switch (compression) {
+#if defined(BSM_HAVE_ZLIB)
+    case Compression::Gzip: return true;
+#endif
+#if defined(BSM_HAVE_ZSTD)
+    case Compression::Zstd: return true;
+#endif
+    default: return false;
+    }
+}
+
+CompressedReader::CompressedReader(std::FILE *file, Compression compression, std::size_t threads)
+    : slots_(QUEUED_BLOCKS)
+{
+    if (!compressionSupported(compression)) {
+        throw std::runtime_error((compression == Compression::Gzip) ? "Cannot read gzip input, as built without zlib"
+                                 : (compression == Compression::Zstd) ? "Cannot read zstd input, as built without libzstd"
+                                 : "Cannot read uncompressed input as compressed");
+    }
+
+    const Source stream = [file](void *data, std::size_t size) {
+        const auto read = std::fread(data, 1, size, file);
+        if (read == 0 && std::ferror(file)) {
+            throw std::runtime_error("Cannot read input");
+        }
+        return read;
+    };
+
+    if (compression == Compression::Gzip) {
+        workers_.emplace_back([this, stream] { run([&](std::size_t &sequence) { inflateStream(stream, sequence); }); });
+        return;
+    }
+
+    struct stat status {};
+    const auto regular = ::fstat(::fileno(file), &status) == 0 && S_ISREG(status.st_mode);
+    if (threads < 2 || !regular) {
+        workers_.emplace_back([this, stream] { run([&](std::size_t &sequence) { zstdStream(stream, sequence); }); });
+        return;
+    }
+
+    readFile(file, input_, READ_SIZE);
+    if (indexFrames()) {
+        blocks_ = frames_.size();
+        for (std::size_t thread = 0; thread < std::min(threads, frames_.size()); ++thread) {
+            workers_.emplace_back([this] { run([&](std::size_t &sequence) { zstdFrames(sequence); }); });
+        }
+        return;
+    }
+
+    const Source buffered = [this, offset = std::size_t{0}](void *data, std::size_t size) mutable {
+        const auto read = std::min(size, input_.size() - offset);
+        std::memcpy(data, input_.data() + offset, read);
+        offset += read;
+        return read;
+    };
+    workers_.emplace_back([this, buffered] { run([&](std::size_t &sequence) { zstdStream(buffered, sequence); }); });
+}
+
+CompressedReader::~CompressedReader() {
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    consumed_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+auto CompressedReader::next() -> std::optional<std::string_view> {
+    line_.clear();
+    while (true) {
+        if (position_ < current_.size()) {
+            const auto *begin = current_.data() + position_;
+            const auto remaining = current_.size() - position_;
+            const auto *end = static_cast<const char*>(std::memchr(begin, '\n', remaining));
+            if (end != nullptr) {
+                const auto length = static_cast<std::size_t>(end - begin);
+                position_ += length + 1;
+                if (line_.empty()) {
+                    return std::string_view(begin, length);
+                }
+                line_.append(begin, length);
+                return line_;
+            }
+            // Carry the start of a line spanning blocks
+            line_.append(begin, remaining);
+            position_ = current_.size();
+        }
+        if (!take()) {
+            return line_.empty() ? std::nullopt : std::optional<std::string_view>(line_);
+        }
+    }
+}
+
+auto CompressedReader::acquire(std::size_t sequence) -> std::vector<char>* {
+    std::unique_lock lock(mutex_);
+    consumed_.wait(lock, [&] { return stopping_ || sequence < read_ + QUEUED_BLOCKS; });
+    return stopping_ ? nullptr : &slots_[sequence % QUEUED_BLOCKS].data_;
+}
+
+void CompressedReader::publish(std::size_t sequence) {
+    {
+        std::lock_guard lock(mutex_);
+        slots_[sequence % QUEUED_BLOCKS].ready_ = true;
+    }
+    produced_.notify_all();
+}
+
+void CompressedReader::finish(std::size_t blocks) {
+    {
+        std::lock_guard lock(mutex_);
+        blocks_ = blocks;
+    }
+    produced_.notify_all();
+}
+
+// Record the error of the given block, which is raised once the blocks before it are read.
+// Frames decompressed in parallel may fail out of order, so only the earliest is kept.
+void CompressedReader::fail(std::exception_ptr error, std::size_t sequence) {
+    {
+        std::lock_guard lock(mutex_);
+        if (sequence < failed_) {
+            error_ = error;
+            failed_ = sequence;
+        }
+    }
+    produced_.notify_all();
+}
+
+// Swap the next block in for the reader, returning its buffer to the queue
+auto CompressedReader::take() -> bool {
+    std::unique_lock lock(mutex_);
+    auto &slot = slots_[read_ % QUEUED_BLOCKS];
+    produced_.wait(lock, [&] { return slot.ready_ || read_ >= failed_ || read_ >= blocks_; });
+    if (!slot.ready_) {
+        if (read_ >= failed_) {
+            std::rethrow_exception(error_);
+        }
+        return false;
+    }
+    std::swap(current_, slot.data_);
+    slot.ready_ = false;
+    position_ = 0;
+    ++read_;
+    lock.unlock();
+    consumed_.notify_all();
+    return true;
+}
+
+void CompressedReader::run(const std::function<void(std::size_t &sequence)> &decompress) {
+    std::size_t sequence = 0;
+    try {
+        decompress(sequence);
+    }
+    catch (...) {
+        fail(std::current_exception(), sequence);
+    }
+}
+
+#if defined(BSM_HAVE_ZLIB)
+// Inflate each gzip member in turn, as of concatenated gzip files
+void CompressedReader::inflateStream(const Source &source, std::size_t &sequence) {
+    z_stream stream {};
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        throw std::runtime_error("Cannot initialise gzip decompression");
+    }
+    const std::unique_ptr<z_stream, decltype(&inflateEnd)> guard(&stream, &inflateEnd);
+
+    std::vector<unsigned char> input(READ_SIZE);
+    bool member = false, ended = false; // within a member, and at the end of input
+    while (!ended || member) {
+        auto *block = acquire(sequence);
+        if (block == nullptr) {
+            return;
+        }
+        block->resize(BLOCK_SIZE);
+        stream.next_out = reinterpret_cast<Bytef*>(block->data());
+        stream.avail_out = static_cast<uInt>(block->size());
+        while (stream.avail_out > 0) {
+            if (stream.avail_in == 0 && !ended) {
+                const auto read = source(input.data(), input.size());
+                ended = (read == 0);
+                stream.next_in = input.data();
+                stream.avail_in = static_cast<uInt>(read);
+            }
+            if (ended && !member) {
+                break;
+            }
+            // Output held back by a full block is written before input is next needed
+            const auto status = inflate(&stream, Z_NO_FLUSH);
+            if (status == Z_STREAM_END) {
+                member = false;
+                inflateReset(&stream);
+            }
+            else if (status == Z_OK || (status == Z_BUF_ERROR && !ended)) {
+                member = true;
+            }
+            else {
+                throw std::runtime_error(std::string("Cannot decompress gzip input: ")
+                                         + ((status == Z_BUF_ERROR) ? "truncated"
+                                            : (stream.msg != nullptr) ? stream.msg : "invalid data"));
+            }
+        }
+        block->resize(block->size() - stream.avail_out);
+        if (!block->empty()) {
+            publish(sequence++);
+        }
+    }
+    finish(sequence);
+}
+#else
+void CompressedReader::inflateStream(const Source &, std::size_t &) {}
+#endif
+
+#if defined(BSM_HAVE_ZSTD)
+// Decompress each zstd frame in turn
+void CompressedReader::zstdStream(const Source &source, std::size_t &sequence) {
+    const std::unique_ptr<ZSTD_DStream, decltype(&ZSTD_freeDStream)> stream(ZSTD_createDStream(), &ZSTD_freeDStream);
+    if (!stream || ZSTD_isError(ZSTD_initDStream(stream.get()))) {
+        throw std::runtime_error("Cannot initialise zstd decompression");
+    }
+
+    std::vector<char> input(ZSTD_DStreamInSize());
+    ZSTD_inBuffer in { input.data(), 0, 0 };
+    std::size_t pending = 0; // zero only between frames
+    bool ended = false, flushed = false;
+    while (!flushed) {
+        auto *block = acquire(sequence);
+        if (block == nullptr) {
+            return;
+        }
+        block->resize(BLOCK_SIZE);
+        ZSTD_outBuffer out { block->data(), block->size(), 0 };
+        while (out.pos < out.size && !flushed) {
+            if (in.pos == in.size && !ended) {
+                const auto read = source(input.data(), input.size());
+                ended = (read == 0);
+                in = { input.data(), read, 0 };
+            }
+            // Output held back by a full block is written before input is next needed. Calls
+            // making no progress, once the input has ended, hint at the next frame's header.
+            const auto written = out.pos, consumed = in.pos;
+            const auto hint = ZSTD_decompressStream(stream.get(), &out, &in);
+            if (ZSTD_isError(hint)) {
+                throw std::runtime_error(std::string("Cannot decompress zstd input: ") + ZSTD_getErrorName(hint));
+            }
+            flushed = ended && out.pos == written;
+            if (out.pos != written || in.pos != consumed) {
+                pending = hint;
+            }
+        }
+        block->resize(out.pos);
+        if (!block->empty()) {
+            publish(sequence++);
+        }
+    }
+    if (pending != 0) {
+        throw std::runtime_error("Cannot decompress zstd input: truncated");
+    }
+    finish(sequence);
+}
+
+// Split the whole input into frames, returning false where it cannot be decompressed
+// frame by frame, as of a single frame, or of frames of unknown or excessive size
+auto CompressedReader::indexFrames() -> bool {
+    for (std::size_t offset = 0; offset < input_.size(); ) {
+        const auto *frame = input_.data() + offset;
+        const auto size = ZSTD_findFrameCompressedSize(frame, input_.size() - offset);
+        if (ZSTD_isError(size)) {
+            return false; // reported as the stream is read
+        }
+        const auto content = ZSTD_getFrameContentSize(frame, size);
+        if (content == ZSTD_CONTENTSIZE_UNKNOWN || content == ZSTD_CONTENTSIZE_ERROR || content > MAX_FRAME_SIZE) {
+            return false;
+        }
+        frames_.push_back({ offset, size, static_cast<std::size_t>(content) });
+        offset += size;
+    }
+    return frames_.size() > 1;
+}
+
+// Decompress the next unclaimed frame, as its own block, until none are left
+void CompressedReader::zstdFrames(std::size_t &sequence) {
+    const std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+    if (!context) {
+        throw std::runtime_error("Cannot initialise zstd decompression");
+    }
+    for (auto index = nextFrame_++; index < frames_.size(); index = nextFrame_++) {
+        sequence = index;
+        auto *block = acquire(index);
+        if (block == nullptr) {
+            return;
+        }
+        const auto &frame = frames_[index];
+        block->resize(frame.content_);
+        const auto size = ZSTD_decompressDCtx(context.get(), block->data(), block->size(),
+                                              input_.data() + frame.offset_, frame.size_);
+        if (ZSTD_isError(size)) {
+            throw std::runtime_error(std::string("Cannot decompress zstd input: ") + ZSTD_getErrorName(size));
+        }
+        block->resize(size);
+        publish(index);
+    }
+}
+#else
+void CompressedReader::zstdStream(const Source &, std::size_t &) {}
+auto CompressedReader::indexFrames() -> bool { return false; }
+void CompressedReader::zstdFrames(std::size_t &) {}
+#endif
+
+} // bsm
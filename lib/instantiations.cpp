@@ -0,0 +1,40 @@
+#include "batch.h"
+#include "black_scholes.h"
+#include "chain.h"
+#include "greeks.h"
+#include "options.h"
+
+// Explicit instantiations of the pricing templates, for float and double. Consumers
+// of libbsm are compiled with BSM_EXTERN_TEMPLATES, so link these rather than
+// instantiating them again in every translation unit.
+namespace bsm
+{
+
+template class BlackScholes<float>;
+template class BlackScholes<double>;
+
+template class Greeks<float>;
+template class Greeks<double>;
+
+template struct OptionValues<float>;
+template struct OptionValues<double>;
+
+template struct OptionBatch<float>;
+template struct OptionBatch<double>;
+
+template struct BatchResults<float>;
+template struct BatchResults<double>;
+
+template class BatchPricer<float>;
+template class BatchPricer<double>;
+
+template class ParallelPricer<float>;
+template class ParallelPricer<double>;
+
+template class ColumnPricer<float>;
+template class ColumnPricer<double>;
+
+template class ChainPricer<float>;
+template class ChainPricer<double>;
+
+} // bsm
@@ -0,0 +1,69 @@
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include "batch.h"
+#include "chain.h"
+#include "outputs.h"
+
+namespace bsm::kernel
+{
+
+template <typename value_type>
+using Kernel = void (*)(const OptionBatch<value_type> &, BatchResults<value_type> &, OutputMask);
+
+// Kernel body, inlined into the entry point of each instruction set, so that
+// each is compiled for its own instruction set within its own translation unit
+template <typename value_type>
+inline void price(const OptionBatch<value_type> &batch, BatchResults<value_type> &results, const OutputMask outputs) {
+    BatchPricer<value_type> pricer(outputs);
+    pricer(batch, results);
+}
+
+template <typename value_type>
+using ChainKernel = void (*)(const Chain<value_type> &, std::size_t, std::size_t, ChainResults<value_type> &, OutputMask);
+
+template <typename value_type>
+inline void priceChain(const Chain<value_type> &chain, const std::size_t begin, const std::size_t end,
+                       ChainResults<value_type> &results, const OutputMask outputs) {
+    ChainPricer<value_type> pricer(outputs);
+    pricer.price(chain, begin, end, results);
+}
+
+void priceGeneric(const OptionBatch<double> &batch, BatchResults<double> &results, OutputMask outputs);
+void priceGeneric(const OptionBatch<float> &batch, BatchResults<float> &results, OutputMask outputs);
+
+void priceChainGeneric(const Chain<double> &chain, std::size_t begin, std::size_t end,
+                       ChainResults<double> &results, OutputMask outputs);
+void priceChainGeneric(const Chain<float> &chain, std::size_t begin, std::size_t end,
+                       ChainResults<float> &results, OutputMask outputs);
+
+#if defined(__x86_64__) || defined(__i386__)
+void priceAvx2(const OptionBatch<double> &batch, BatchResults<double> &results, OutputMask outputs);
+void priceAvx2(const OptionBatch<float> &batch, BatchResults<float> &results, OutputMask outputs);
+void priceAvx512(const OptionBatch<double> &batch, BatchResults<double> &results, OutputMask outputs);
+void priceAvx512(const OptionBatch<float> &batch, BatchResults<float> &results, OutputMask outputs);
+void priceChainAvx2(const Chain<double> &chain, std::size_t begin, std::size_t end,
+                    ChainResults<double> &results, OutputMask outputs);
+void priceChainAvx2(const Chain<float> &chain, std::size_t begin, std::size_t end,
+                    ChainResults<float> &results, OutputMask outputs);
+void priceChainAvx512(const Chain<double> &chain, std::size_t begin, std::size_t end,
+                      ChainResults<double> &results, OutputMask outputs);
+void priceChainAvx512(const Chain<float> &chain, std::size_t begin, std::size_t end,
+                      ChainResults<float> &results, OutputMask outputs);
+#endif
+
+// Entry points of the widest instruction set supported by this machine
+struct Kernels
+{
+    const char *isa_;
+    Kernel<double> double_;
+    Kernel<float> float_;
+    ChainKernel<double> chainDouble_;
+    ChainKernel<float> chainFloat_;
+};
+
+auto select() -> const Kernels&;
+
+} // bsm::kernel
+
+#endif
@@ -0,0 +1,32 @@
+#include "kernel.h"
+
+// Only the entry points below are compiled for AVX2, with the kernel flattened into
+// them, so no out of line template instance requiring it is emitted to be merged by the linker
+namespace bsm::kernel
+{
+
+#if defined(__x86_64__) || defined(__i386__)
+[[gnu::target("avx2,fma"), gnu::flatten]]
+void priceAvx2(const OptionBatch<double> &batch, BatchResults<double> &results, const OutputMask outputs) {
+    price(batch, results, outputs);
+}
+
+[[gnu::target("avx2,fma"), gnu::flatten]]
+void priceAvx2(const OptionBatch<float> &batch, BatchResults<float> &results, const OutputMask outputs) {
+    price(batch, results, outputs);
+}
+
+[[gnu::target("avx2,fma"), gnu::flatten]]
+void priceChainAvx2(const Chain<double> &chain, const std::size_t begin, const std::size_t end,
+                    ChainResults<double> &results, const OutputMask outputs) {
+    priceChain(chain, begin, end, results, outputs);
+}
+
+[[gnu::target("avx2,fma"), gnu::flatten]]
+void priceChainAvx2(const Chain<float> &chain, const std::size_t begin, const std::size_t end,
+                    ChainResults<float> &results, const OutputMask outputs) {
+    priceChain(chain, begin, end, results, outputs);
+}
+#endif
+
+} // bsm::kernel
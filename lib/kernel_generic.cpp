@@ -0,0 +1,40 @@
+#include "kernel.h"
+
+namespace bsm::kernel
+{
+
+void priceGeneric(const OptionBatch<double> &batch, BatchResults<double> &results, const OutputMask outputs) {
+    price(batch, results, outputs);
+}
+
+void priceGeneric(const OptionBatch<float> &batch, BatchResults<float> &results, const OutputMask outputs) {
+    price(batch, results, outputs);
+}
+
+void priceChainGeneric(const Chain<double> &chain, const std::size_t begin, const std::size_t end,
+                       ChainResults<double> &results, const OutputMask outputs) {
+    priceChain(chain, begin, end, results, outputs);
+}
+
+void priceChainGeneric(const Chain<float> &chain, const std::size_t begin, const std::size_t end,
+                       ChainResults<float> &results, const OutputMask outputs) {
+    priceChain(chain, begin, end, results, outputs);
+}
+
+auto select() -> const Kernels& {
+    static const Kernels kernels = []() -> Kernels {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+            return { "avx512", priceAvx512, priceAvx512, priceChainAvx512, priceChainAvx512 };
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return { "avx2", priceAvx2, priceAvx2, priceChainAvx2, priceChainAvx2 };
+        }
+#endif
+        return { "generic", priceGeneric, priceGeneric, priceChainGeneric, priceChainGeneric };
+    }();
+    return kernels;
+}
+
+} // bsm::kernel
@@ -0,0 +1,250 @@
+"""Python bindings of libbsm, over its stable C API (include/bsm_c.h), by ctypes.
+
+Options are priced one at a time by Option, and column arrays of contracts in
+place by BatchPricer. Columns are taken without copying, as NumPy arrays or any
+other buffer, e.g. array.array, of the C API's element type, and a column which
+would first need converting or copying is rejected rather than silently copied.
+The GIL is released while pricing, as by every ctypes call of a CDLL, so that
+batches are priced in chunks across threads.
+
+The shared library is loaded from the BSM_LIBRARY environment variable, as built
+at e.g. build/lib/libbsm_c.so, else found by name.
+"""
+
+import array
+import collections
+import concurrent.futures
+import ctypes
+import ctypes.util
+import enum
+import os
+import re
+
+__all__ = ["OUTPUTS", "OptionType", "Greeks", "Option", "BatchPricer", "abi_version", "kernel_isa"]
+
+ABI_VERSION = 1
+
+# Outputs, in the order of the C API's result columns
+OUTPUTS = ("price", "delta", "gamma", "theta", "vega", "rho",
+           "vanna", "volga", "charm", "speed", "zomma", "colour")
+
+# Defaults of omitted contract values, as of the CLI (include/constants.h)
+IMPLIED_VOL = 0.18
+INTEREST = 0.02
+YIELD = 0.00
+
+# Rows priced per call of the C API, at the least, where a batch is split across threads
+MIN_CHUNK_ROWS = 4096
+
+CONTRACT_COLUMNS = ("underlying_price", "strike_price", "time_to_expiry", "volatility",
+                    "risk_free_interest", "dividend_yield")
+
+
+class OptionType(enum.IntEnum):
+    Call = 0
+    Put = 1
+
+
+Greeks = collections.namedtuple("Greeks", OUTPUTS)
+
+
+def _columns_struct(value_type):
+    class Columns(ctypes.Structure):
+        _fields_ = [("rows", ctypes.c_size_t), ("type", ctypes.POINTER(ctypes.c_int32))] + \
+                   [(name, ctypes.POINTER(value_type)) for name in CONTRACT_COLUMNS]
+    return Columns
+
+
+def _results_struct(value_type):
+    class Results(ctypes.Structure):
+        _fields_ = [(name, ctypes.POINTER(value_type)) for name in OUTPUTS]
+    return Results
+
+
+# Element type, by C API suffix, with its column structures and NumPy type string
+_TYPES = {
+    "d": (ctypes.c_double, _columns_struct(ctypes.c_double), _results_struct(ctypes.c_double), "<f8", "d"),
+    "f": (ctypes.c_float, _columns_struct(ctypes.c_float), _results_struct(ctypes.c_float), "<f4", "f"),
+}
+
+
+def _load():
+    path = os.environ.get("BSM_LIBRARY") or ctypes.util.find_library("bsm_c")
+    if not path:
+        raise ImportError("Cannot find libbsm_c, so set BSM_LIBRARY to its path")
+    library = ctypes.CDLL(path)
+    library.bsm_abi_version.restype = ctypes.c_int
+    library.bsm_kernel_isa.restype = ctypes.c_char_p
+    library.bsm_last_error.restype = ctypes.c_char_p
+    for suffix, (_, columns, results, _, _) in _TYPES.items():
+        price = getattr(library, "bsm_price_batch_" + suffix)
+        price.argtypes = [ctypes.POINTER(columns), ctypes.POINTER(results)]
+        price.restype = ctypes.c_int
+    if library.bsm_abi_version() != ABI_VERSION:
+        raise ImportError(f"{path} is of ABI version {library.bsm_abi_version()}, not {ABI_VERSION}")
+    return library
+
+
+_lib = _load()
+
+
+def abi_version():
+    return _lib.bsm_abi_version()
+
+
+def kernel_isa():
+    """Instruction set of the kernel selected for this machine, e.g. "avx2\""""
+    return _lib.bsm_kernel_isa().decode()
+
+
+def _address(column, typestr, fmt, rows, name):
+    """Address of the elements of a one dimensional, contiguous column of the given element type.
+    Columns of another type, layout or length are rejected, as they could only be priced copied."""
+    interface = getattr(column, "__array_interface__", None)
+    if interface is not None:
+        if interface["typestr"] != typestr:
+            raise TypeError(f"{name} must be of dtype {typestr}, not {interface['typestr']}")
+        if len(interface["shape"]) != 1 or interface.get("strides") not in (None, (int(typestr[2:]),)):
+            raise TypeError(f"{name} must be a one dimensional, contiguous array")
+        if interface["shape"][0] != rows:
+            raise ValueError(f"{name} must be of {rows} rows, not {interface['shape'][0]}")
+        return interface["data"][0]
+
+    try:
+        view = memoryview(column)
+    except TypeError:
+        raise TypeError(f"{name} must be an array, or other buffer, of {fmt} elements") from None
+    with view:
+        if view.format != fmt or view.ndim != 1 or not view.c_contiguous:
+            raise TypeError(f"{name} must be a one dimensional, contiguous buffer of {fmt} elements")
+        if len(view) != rows:
+            raise ValueError(f"{name} must be of {rows} rows, not {len(view)}")
+        if rows == 0:
+            return None
+        if view.readonly:
+            raise TypeError(f"{name} must be a writable buffer, or a NumPy array")
+        return ctypes.addressof(ctypes.c_char.from_buffer(column))
+
+
+def _rows(column):
+    interface = getattr(column, "__array_interface__", None)
+    if interface is not None:
+        return interface["shape"][0] if interface["shape"] else 0
+    return len(column)
+
+
+def _suffix(column):
+    """C API element type of a column, by its own element type"""
+    interface = getattr(column, "__array_interface__", None)
+    code = interface["typestr"] if interface is not None else memoryview(column).format
+    return "f" if code in ("<f4", "f") else "d"
+
+
+def _empty(rows, suffix, like):
+    """Result column of the element type, a NumPy array where the contracts are"""
+    if hasattr(like, "__array_interface__"):
+        import numpy
+        return numpy.empty(rows, dtype=_TYPES[suffix][3])
+    return array.array(_TYPES[suffix][4], bytes(ctypes.sizeof(_TYPES[suffix][0]) * rows))
+
+
+def _price(suffix, types, values, results):
+    """Price rows from the given addresses, raising the C API's error, if any, with its row offset"""
+    value_type, columns_type, results_type, _, _ = _TYPES[suffix]
+    size = ctypes.sizeof(value_type)
+
+    def chunk(begin, end):
+        def at(address):
+            return ctypes.cast(None if address is None else address + (begin * size), ctypes.POINTER(value_type))
+        columns = columns_type(end - begin, ctypes.cast(types + (begin * 4), ctypes.POINTER(ctypes.c_int32)),
+                               *(at(address) for address in values))
+        out = results_type(*(at(address) for address in results))
+        status = getattr(_lib, "bsm_price_batch_" + suffix)(ctypes.byref(columns), ctypes.byref(out))
+        if status != 0:
+            # Read on the thread which failed, as errors are held per thread
+            error = _lib.bsm_last_error().decode()
+            raise RuntimeError(re.sub(r"^Row (\d+)", lambda row: f"Row {int(row.group(1)) + begin}", error))
+
+    return chunk
+
+
+class Option:
+    """A single European option, priced on construction, so that invalid contracts raise RuntimeError"""
+
+    def __init__(self, type_, underlying_price, strike_price, time_to_expiry,
+                 volatility=IMPLIED_VOL, risk_free_interest=INTEREST, dividend_yield=YIELD):
+        types = array.array("i", [int(OptionType(type_))])
+        values = [array.array("d", [float(value)]) for value in (underlying_price, strike_price, time_to_expiry,
+                                                                volatility, risk_free_interest, dividend_yield)]
+        results = [array.array("d", [0.0]) for _ in OUTPUTS]
+
+        def address(column):
+            return ctypes.addressof(ctypes.c_char.from_buffer(column))
+
+        _price("d", address(types), [address(value) for value in values],
+               [address(result) for result in results])(0, 1)
+        self.type = OptionType(type_)
+        self._greeks = Greeks(*(result[0] for result in results))
+
+    def price(self):
+        return self._greeks.price
+
+    def __call__(self):
+        return self.price()
+
+    def greeks(self):
+        return self._greeks
+
+
+class BatchPricer:
+    """Prices columns of contracts in place, into new result columns of the selected outputs,
+    in chunks across threads. Columns are of float64, or all of float32, with int32 option types
+    of OptionType values. Dividend yields may be omitted, for none."""
+
+    def __init__(self, outputs="price", threads=None):
+        self.outputs = tuple(output.strip() for output in outputs.split(",")) if isinstance(outputs, str) \
+            else tuple(outputs)
+        for output in self.outputs:
+            if output not in OUTPUTS:
+                raise ValueError(f"Unknown output {output}, of: {', '.join(OUTPUTS)}")
+        if not self.outputs:
+            raise ValueError("At least one output must be selected")
+        self.threads = threads or os.cpu_count() or 1
+        self._executor = concurrent.futures.ThreadPoolExecutor(self.threads) if self.threads > 1 else None
+
+    def __call__(self, type_, underlying_price, strike_price, time_to_expiry, volatility, risk_free_interest,
+                 dividend_yield=None):
+        rows = _rows(type_)
+        suffix = _suffix(underlying_price)
+        _, _, _, typestr, fmt = _TYPES[suffix]
+        types = _address(type_, "<i4", "i", rows, "type")
+        given = (underlying_price, strike_price, time_to_expiry, volatility, risk_free_interest, dividend_yield)
+        values = [None if column is None else _address(column, typestr, fmt, rows, name)
+                  for name, column in zip(CONTRACT_COLUMNS, given)]
+        columns = {output: _empty(rows, suffix, underlying_price) for output in self.outputs}
+        results = [_address(columns[output], typestr, fmt, rows, output) if output in columns else None
+                   for output in OUTPUTS]
+        if rows == 0:
+            return columns
+
+        price = _price(suffix, types, values, results)
+        chunk = max(MIN_CHUNK_ROWS, -(-rows // self.threads))
+        if self._executor is None or chunk >= rows:
+            price(0, rows)
+        else:
+            # Each failed chunk raises its own error, of which the first in row order is raised
+            futures = [self._executor.submit(price, begin, min(begin + chunk, rows)) for begin in range(0, rows, chunk)]
+            for future in futures:
+                future.result()
+        return columns
+
+    def close(self):
+        if self._executor is not None:
+            self._executor.shutdown()
+            self._executor = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
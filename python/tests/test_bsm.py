@@ -0,0 +1,148 @@
+"""Python bindings, checked against the reference cases of tst/tst_black_scholes.cpp"""
+
+import array
+
+import pytest
+
+import bsm
+
+# (type, underlying, strike, time, volatility, rate, yield, price to 2dp)
+REFERENCE = [
+    # In the money calls, out of the money puts
+    (bsm.OptionType.Call, 100.00, 95.00, 1.00, 0.18, 0.05, 0.00, 12.69),
+    (bsm.OptionType.Put,  100.00, 95.00, 1.00, 0.18, 0.05, 0.00, 3.06),
+    (bsm.OptionType.Call, 100.00, 95.00, 0.50, 0.18, 0.05, 0.00, 9.41),
+    (bsm.OptionType.Put,  100.00, 95.00, 0.50, 0.18, 0.05, 0.00, 2.07),
+    (bsm.OptionType.Call, 100.00, 95.00, 0.25, 0.18, 0.05, 0.00, 7.41),
+    (bsm.OptionType.Put,  100.00, 95.00, 0.25, 0.18, 0.05, 0.00, 1.23),
+    (bsm.OptionType.Call, 100.00, 95.00, 1.00, 0.60, 0.05, 0.00, 27.57),
+    (bsm.OptionType.Put,  100.00, 95.00, 1.00, 0.60, 0.05, 0.00, 17.94),
+    (bsm.OptionType.Call, 100.00, 95.00, 1.00, 0.18, 0.01, 0.00, 10.33),
+    (bsm.OptionType.Put,  100.00, 95.00, 1.00, 0.18, 0.01, 0.00, 4.38),
+    # Out of the money calls, in the money puts
+    (bsm.OptionType.Call, 20.15, 35.20, 1.00, 0.25, 0.03, 0.00, 0.04),
+    (bsm.OptionType.Put,  20.15, 35.20, 1.00, 0.25, 0.03, 0.00, 14.05),
+    (bsm.OptionType.Call, 20.15, 35.20, 0.50, 0.25, 0.03, 0.00, 0.00),
+    (bsm.OptionType.Put,  20.15, 35.20, 0.50, 0.25, 0.03, 0.00, 14.53),
+    (bsm.OptionType.Call, 20.15, 35.20, 0.25, 0.25, 0.03, 0.00, 0.00),
+    (bsm.OptionType.Put,  20.15, 35.20, 0.25, 0.25, 0.03, 0.00, 14.79),
+    (bsm.OptionType.Call, 20.15, 35.20, 1.00, 0.60, 0.03, 0.00, 1.60),
+    (bsm.OptionType.Put,  20.15, 35.20, 1.00, 0.60, 0.03, 0.00, 15.60),
+    (bsm.OptionType.Call, 20.15, 35.20, 1.00, 0.25, 0.01, 0.00, 0.03),
+    (bsm.OptionType.Put,  20.15, 35.20, 1.00, 0.25, 0.01, 0.00, 14.73),
+    # At the money
+    (bsm.OptionType.Call, 40.50, 40.50, 1.50, 0.30, 0.01, 0.00, 6.17),
+    (bsm.OptionType.Put,  40.50, 40.50, 1.50, 0.30, 0.01, 0.00, 5.56),
+    # Continuous dividend yield
+    (bsm.OptionType.Call, 100.00, 95.00, 1.00, 0.18, 0.05, 0.03, 10.58),
+    (bsm.OptionType.Put,  100.00, 95.00, 1.00, 0.18, 0.05, 0.03, 3.90),
+]
+
+DP2 = 0.01
+
+
+@pytest.mark.parametrize("type_, underlying, strike, time, volatility, rate, yield_, expected", REFERENCE)
+def test_option_price(type_, underlying, strike, time, volatility, rate, yield_, expected):
+    option = bsm.Option(type_, underlying, strike, time, volatility, rate, yield_)
+    assert option.price() == pytest.approx(expected, abs=DP2)
+    assert option() == option.price()
+    assert option.greeks().price == option.price()
+
+
+def test_greeks():
+    call = bsm.Option(bsm.OptionType.Call, 100.00, 95.00, 1.00, 0.18, 0.05).greeks()
+    put = bsm.Option(bsm.OptionType.Put, 100.00, 95.00, 1.00, 0.18, 0.05).greeks()
+    assert call._fields == bsm.OUTPUTS
+    assert 0.0 < call.delta < 1.0
+    assert -1.0 < put.delta < 0.0
+    assert call.delta - put.delta == pytest.approx(1.0)
+    assert call.gamma == pytest.approx(put.gamma, abs=1E-12)
+    assert call.vega == pytest.approx(put.vega, abs=1E-12)
+
+
+def test_invalid_option():
+    with pytest.raises(RuntimeError, match="Row 0"):
+        bsm.Option(bsm.OptionType.Call, 100.00, -95.00, 1.00, 0.18, 0.05)
+    with pytest.raises(ValueError):
+        bsm.Option(2, 100.00, 95.00, 1.00)
+
+
+def columns(rows=REFERENCE, typecode="d"):
+    types, underlying, strike, time, volatility, rate, yield_, expected = zip(*rows)
+    return (array.array("i", [int(type_) for type_ in types]),
+            *(array.array(typecode, column) for column in (underlying, strike, time, volatility, rate, yield_)),
+            expected)
+
+
+@pytest.mark.parametrize("threads", [1, 4])
+def test_batch_pricer_matches_reference(threads):
+    *contract, expected = columns()
+    with bsm.BatchPricer("price,delta,colour", threads=threads) as pricer:
+        results = pricer(*contract)
+    assert sorted(results) == ["colour", "delta", "price"]
+    for row, (type_, *values, _) in enumerate(REFERENCE):
+        greeks = bsm.Option(type_, *values).greeks()
+        assert results["price"][row] == pytest.approx(expected[row], abs=DP2)
+        assert results["delta"][row] == pytest.approx(greeks.delta, abs=1E-12)
+        assert results["colour"][row] == pytest.approx(greeks.colour, abs=1E-12)
+
+
+def test_batch_pricer_float():
+    *contract, expected = columns(typecode="f")
+    results = bsm.BatchPricer("price")(*contract)
+    assert results["price"].typecode == "f"
+    for row, price in enumerate(results["price"]):
+        assert price == pytest.approx(expected[row], abs=DP2)
+
+
+def test_batch_pricer_chunks_across_threads():
+    rows = 3 * bsm.MIN_CHUNK_ROWS + 17
+    contract = (array.array("i", [row % 2 for row in range(rows)]),
+                array.array("d", [100.0] * rows),
+                array.array("d", [50.0 + (row % 100) for row in range(rows)]),
+                array.array("d", [0.1 + (row % 49) * 0.1 for row in range(rows)]),
+                array.array("d", [0.1 + (row % 5) * 0.1 for row in range(rows)]),
+                array.array("d", [0.03] * rows))
+    serial = bsm.BatchPricer("price,vega", threads=1)(*contract)
+    with bsm.BatchPricer("price,vega", threads=4) as pricer:
+        parallel = pricer(*contract)
+        assert parallel == serial
+
+        # Errors give the row within the whole batch, rather than within its chunk
+        contract[4][2 * bsm.MIN_CHUNK_ROWS + 5] = -0.2
+        with pytest.raises(RuntimeError, match=f"Row {2 * bsm.MIN_CHUNK_ROWS + 5}:"):
+            pricer(*contract)
+
+
+def test_batch_pricer_rejects_copies_and_invalid_rows():
+    type_, underlying, strike, time, volatility, rate, yield_, _ = columns()
+    pricer = bsm.BatchPricer("price")
+    # Columns which would need converting, so copying, are rejected
+    with pytest.raises(TypeError):
+        pricer(type_, array.array("f", underlying), strike, time, volatility, rate)
+    with pytest.raises(TypeError):
+        pricer(type_, list(underlying), strike, time, volatility, rate)
+    with pytest.raises(TypeError):
+        pricer(type_, memoryview(underlying)[::2], strike, time, volatility, rate)
+    with pytest.raises(ValueError):
+        pricer(type_, underlying[:-1], strike, time, volatility, rate)
+    with pytest.raises(ValueError):
+        bsm.BatchPricer("price,beta")
+
+    volatility[3] = -0.2
+    with pytest.raises(RuntimeError, match="Row 3"):
+        pricer(type_, underlying, strike, time, volatility, rate, yield_)
+
+
+def test_numpy_columns_are_priced_in_place():
+    np = pytest.importorskip("numpy")
+    type_, *values, expected = columns()
+    contract = [np.frombuffer(type_, dtype=np.int32)] + [np.frombuffer(column, dtype=np.float64) for column in values]
+    results = bsm.BatchPricer("price,delta", threads=2)(*contract)
+    assert isinstance(results["price"], np.ndarray)
+    np.testing.assert_allclose(results["price"], expected, atol=DP2)
+
+    with pytest.raises(TypeError):
+        bsm.BatchPricer("price")(contract[0], contract[1].astype(np.float32), *contract[2:])
+    with pytest.raises(TypeError):
+        bsm.BatchPricer("price")(contract[0][::2], *(column[::2] for column in contract[1:]))
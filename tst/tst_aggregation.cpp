@@ -0,0 +1,172 @@
+#include "aggregation.h"
+#include "batch.h"
+#include "constants.h"
+#include "input_reader.h"
+#include "options.h"
+#include "output_writer.h"
+#include "thread_pool.h"
+#include "tst_helpers.h"
+
+#include <cstring>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+using Catch::Matchers::Contains;
+
+namespace
+{
+
+// Positions across three underlyings, four books and a range of expiries
+auto makePortfolio(std::size_t rows) -> OptionBatch<value_type> {
+    OptionBatch<value_type> batch;
+    for (std::size_t row = 0; row < rows; ++row) {
+        const auto type = (row % 3 == 0) ? OptionType::Put : OptionType::Call;
+        const auto strike = 80.0 + static_cast<value_type>(row % 41);
+        const auto time = 0.02 + static_cast<value_type>(row % 97) * 0.05;
+        const auto quantity = static_cast<value_type>(static_cast<int>(row % 11) - 5) * 12.5;
+        batch.push(type, OptionValues<value_type> { 100.00, strike, time, 0.2, 0.03 },
+                   static_cast<std::uint32_t>(row % 3), NO_SURFACE, NO_CURVE, quantity, static_cast<std::uint32_t>(row % 4));
+    }
+    return batch;
+}
+
+}
+
+TEST_CASE("Expiry buckets and grouping keys", "[aggregation]")
+{
+    SECTION("Expiries fall into the first bucket bounding them")
+    {
+        REQUIRE(expiryBucket(0.01) == 0);
+        REQUIRE(expiryBucket(0.25) == 1);
+        REQUIRE(expiryBucket(0.26) == 2);
+        REQUIRE(expiryBucket(1.5) == 4);
+        REQUIRE(expiryBucket(10.0) == NUM_EXPIRY_BUCKETS - 1);
+    }
+
+    SECTION("Grouping keys are parsed from a list")
+    {
+        const auto grouping = parseGrouping("underlying,book");
+        REQUIRE(grouping.underlying_);
+        REQUIRE_FALSE(grouping.expiry_);
+        REQUIRE(grouping.book_);
+
+        const auto all = parseGrouping("all");
+        REQUIRE_FALSE((all.underlying_ || all.expiry_ || all.book_));
+        REQUIRE_THROWS_WITH(parseGrouping("underlying,desk"), Contains("Unknown aggregation key"));
+    }
+}
+
+TEST_CASE("Aggregation of position weighted outputs", "[aggregation]")
+{
+    const auto outputs = OutputMask { Output::Price, Output::Delta, Output::Gamma, Output::Vega };
+    const auto batch = makePortfolio(1000);
+    BatchPricer<value_type> pricer(outputs);
+    BatchResults<value_type> results;
+    pricer(batch, results);
+
+    SECTION("Group totals match a serial sum over their positions")
+    {
+        ThreadPool pool(4);
+        Aggregator<value_type> aggregator(pool, outputs, Grouping { true, false, true });
+        aggregator(batch, results);
+
+        std::map<RiskKey, Risk> expected;
+        for (std::size_t row = 0; row < batch.size(); ++row) {
+            auto &risk = expected[RiskKey { batch.underlying_[row], ALL_KEYS, batch.book_[row] }];
+            risk.addPosition(batch.quantity_[row]);
+            risk.add(batch.quantity_[row], Output::Price, results.price_[row]);
+            risk.add(batch.quantity_[row], Output::Delta, results.delta_[row]);
+        }
+
+        const auto &totals = aggregator.totals();
+        REQUIRE(totals.size() == 12);
+        for (const auto &[key, risk] : expected) {
+            const auto &total = totals.at(key);
+            REQUIRE(total.positions() == risk.positions());
+            REQUIRE(compareFloat(total.quantity(), risk.quantity(), 1E-9));
+            REQUIRE(compareFloat(total[Output::Price], risk[Output::Price], 1E-9));
+            REQUIRE(compareFloat(total[Output::Delta], risk[Output::Delta], 1E-9));
+            REQUIRE(total[Output::Theta] == 0);
+        }
+    }
+
+    SECTION("Totals are identical regardless of thread count")
+    {
+        const auto aggregate = [&](std::size_t threads) {
+            ThreadPool pool(threads);
+            Aggregator<value_type> aggregator(pool, outputs);
+            aggregator(batch, results);
+            aggregator(batch, results);
+            return aggregator.totals();
+        };
+
+        const auto serial = aggregate(1);
+        for (const auto threads : { 2, 3, 8 }) {
+            const auto parallel = aggregate(threads);
+            REQUIRE(parallel.size() == serial.size());
+            for (const auto &[key, risk] : serial) {
+                const auto &other = parallel.at(key);
+                REQUIRE(other.positions() == risk.positions());
+                for (const auto output : { Output::Price, Output::Delta, Output::Gamma, Output::Vega }) {
+                    const auto lhs = other[output], rhs = risk[output];
+                    REQUIRE(std::memcmp(&lhs, &rhs, sizeof(lhs)) == 0);
+                }
+            }
+        }
+    }
+
+    SECTION("Collapsed keys aggregate every position")
+    {
+        ThreadPool pool(2);
+        Aggregator<value_type> aggregator(pool, outputs, parseGrouping("all"));
+        aggregator(batch, results);
+        REQUIRE(aggregator.totals().size() == 1);
+        REQUIRE(aggregator.totals().begin()->second.positions() == batch.size());
+
+        AggregateWriter writer(outputs);
+        const auto formatted = writer.format(aggregator.totals());
+        REQUIRE_THAT(std::string(formatted), Contains("Underlying * Expiry * Book * Positions: 1000"));
+    }
+}
+
+TEST_CASE("Positions read from CSV", "[aggregation]")
+{
+    InputReader<value_type> reader(Format::CSV);
+    const auto expiry = getDateOffset(30);
+
+    const auto [type, values, surface, curve, position] = reader.getOptionValues("call,100.00,105.00," + expiry + ",0.2,0.05,0.01,-250,3,7,");
+    REQUIRE(values.has_value());
+    REQUIRE(position.quantity_ == -250);
+    REQUIRE(position.underlying_ == 3);
+    REQUIRE(position.book_ == 7);
+
+    const auto [plainType, plainValues, plainSurface, plainCurve, plainPosition] = reader.getOptionValues("call,100.00,105.00," + expiry + ",0.2,0.05,0.01,");
+    REQUIRE(plainValues.has_value());
+    REQUIRE(plainPosition.quantity_ == 1);
+
+    const auto [quantityType, quantityValues, quantitySurface, quantityCurve, quantityPosition] = reader.getOptionValues("call,100.00,105.00," + expiry + ",0.2,0.05,0.01,10,");
+    REQUIRE(quantityValues.has_value());
+    REQUIRE(quantityPosition.quantity_ == 10);
+    REQUIRE(quantityPosition.underlying_ == 0);
+    REQUIRE(quantityPosition.book_ == 0);
+
+    REQUIRE_FALSE(std::get<1>(reader.getOptionValues("call,100.00,105.00," + expiry + ",0.2,0.05,0.01,10,x,0,")).has_value());
+    REQUIRE_FALSE(std::get<1>(reader.getOptionValues("call,100.00,105.00," + expiry + ",0.2,0.05,0.01,10,3,7,0,")).has_value());
+}
+
+TEST_CASE("Positions read strictly", "[aggregation]")
+{
+    InputReader<value_type> reader(Format::CSV, true);
+    const auto expiry = getDateOffset(30);
+
+    REQUIRE(std::get<1>(reader.getOptionValues("call,100.00,105.00," + expiry + ",0.2,0.05,0.01,10,")).has_value());
+    // Headers repeated by concatenated files are skipped
+    REQUIRE_FALSE(std::get<1>(reader.getOptionValues("option_type,underlying_price,strike_price,expiry_time,implied_volatility,interest_rate,dividend_yield")).has_value());
+    REQUIRE_THROWS_WITH(reader.getOptionValues("call,100.00,105.00," + expiry + ",0.2,0.05,0.01,10,x,0,"),
+                        Catch::Matchers::StartsWith("Cannot read contract"));
+    REQUIRE_THROWS(reader.getOptionValues("call,100.00"));
+
+    InputReader<value_type> json(Format::NDJSON, true);
+    REQUIRE_THROWS_WITH(json.getOptionValues("{\"option_type\":"), Catch::Matchers::StartsWith("Cannot read contract"));
+}
@@ -0,0 +1,128 @@
+#include "american.h"
+#include "batch.h"
+#include "constants.h"
+#include "lattice.h"
+#include "options.h"
+#include "thread_pool.h"
+#include "tst_helpers.h"
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+
+TEST_CASE("Cumulative bivariate normal distribution", "[american]")
+{
+    const BjerksundStensland<value_type> bjs;
+
+    SECTION("Independent variables factorise")
+    {
+        const BlackScholes<value_type> bsm;
+        REQUIRE(compareFloat(bjs.cumulBivariateNormalDist(0.3, -0.5, 0), bsm.cumulNormalDist(0.3) * bsm.cumulNormalDist(-0.5), 1E-12));
+    }
+
+    SECTION("Correlated variables, over each quadrature order")
+    {
+        // Reference values by numerical integration of the conditional distribution
+        REQUIRE(compareFloat(bjs.cumulBivariateNormalDist(0.3, -0.5, 0.2), 0.21721324905149, 1E-12));
+        REQUIRE(compareFloat(bjs.cumulBivariateNormalDist(1.0, 0.5, 0.6), 0.64182899006387, 1E-12));
+        REQUIRE(compareFloat(bjs.cumulBivariateNormalDist(-0.2, 0.4, -0.8), 0.14037504493888, 1E-12));
+        REQUIRE(compareFloat(bjs.cumulBivariateNormalDist(0.5, 0.7, 0.95), 0.67453389573467, 1E-12));
+        REQUIRE(compareFloat(bjs.cumulBivariateNormalDist(-1.0, 0.3, -0.97), 0.00004971368929, 1E-12));
+    }
+}
+
+TEST_CASE("American approximations agree with a high step lattice", "[american]")
+{
+    const Lattice<value_type> lattice(2000);
+    const BaroneAdesiWhaley<value_type> baw;
+    const BjerksundStensland<value_type> bjs;
+
+    const OptionValues<value_type> inputs[] {
+        OptionValues<value_type> { 36.00, 40.00, 1.0, 0.20, 0.06, 0.00 },
+        OptionValues<value_type> { 100.00, 100.00, 0.5, 0.30, 0.05, 0.02 },
+        OptionValues<value_type> { 100.00, 100.00, 0.5, 0.30, 0.05, 0.08 },
+        OptionValues<value_type> { 100.00, 90.00, 1.0, 0.25, 0.03, 0.05 },
+        OptionValues<value_type> { 100.00, 110.00, 1.0, 0.35, 0.08, 0.00 },
+    };
+
+    for (const auto &input : inputs) {
+        const auto call = lattice.callOptionValue(input);
+        const auto put = lattice.putOptionValue(input);
+
+        REQUIRE(compareFloat(baw.callOptionValue(input), call, 0.05));
+        REQUIRE(compareFloat(baw.putOptionValue(input), put, 0.05));
+        REQUIRE(compareFloat(bjs.callOptionValue(input), call, 0.11));
+        REQUIRE(compareFloat(bjs.putOptionValue(input), put, 0.11));
+
+        // Both approximations are bounded by the European value, and the exercise value
+        REQUIRE(baw.putOptionValue(input) >= BlackScholes<value_type>().putOptionValue(input));
+        REQUIRE(bjs.putOptionValue(input) >= BlackScholes<value_type>().putOptionValue(input));
+        REQUIRE(bjs.putOptionValue(input) >= input.strikePrice_ - input.underlyingPrice_);
+    }
+}
+
+TEST_CASE("American approximations", "[american]")
+{
+    const BaroneAdesiWhaley<value_type> baw;
+    const BjerksundStensland<value_type> bjs;
+
+    SECTION("Reference values, as given by Haug (2007)")
+    {
+        // T = 0.1, S = 90, 100, 110 with K = 100, r = 0.1, q = 0.1, σ = 0.15
+        REQUIRE(compareFloat(baw.callOptionValue(OptionValues<value_type> { 90.00, 100.00, 0.1, 0.15, 0.10, 0.10 }), 0.0206, DP2));
+        REQUIRE(compareFloat(baw.callOptionValue(OptionValues<value_type> { 100.00, 100.00, 0.1, 0.15, 0.10, 0.10 }), 1.8771, DP2));
+        REQUIRE(compareFloat(baw.callOptionValue(OptionValues<value_type> { 110.00, 100.00, 0.1, 0.15, 0.10, 0.10 }), 10.0089, DP2));
+    }
+
+    SECTION("CALL without dividends, and PUT without interest, are never exercised early")
+    {
+        const BlackScholes<value_type> bsm;
+        const OptionValues<value_type> call { 100.00, 95.00, 1, 0.18, 0.05, 0.00 };
+        const OptionValues<value_type> put { 100.00, 105.00, 1, 0.18, 0.00, 0.02 };
+
+        REQUIRE(compareFloat(baw.callOptionValue(call), bsm.callOptionValue(call), 1E-12));
+        REQUIRE(compareFloat(bjs.callOptionValue(call), bsm.callOptionValue(call), 1E-12));
+        REQUIRE(compareFloat(baw.putOptionValue(put), bsm.putOptionValue(put), 1E-12));
+        REQUIRE(compareFloat(bjs.putOptionValue(put), bsm.putOptionValue(put), 1E-12));
+    }
+
+    SECTION("Deep in the money contracts beyond the critical price are exercised")
+    {
+        const OptionValues<value_type> input { 10.00, 40.00, 1, 0.20, 0.06 };
+        REQUIRE(compareFloat(baw.putOptionValue(input), 30.00, 1E-12));
+        REQUIRE(compareFloat(bjs.putOptionValue(input), 30.00, 1E-12));
+    }
+
+    SECTION("Approximations through the option interface")
+    {
+        Option<PutExecutor, value_type, BaroneAdesiWhaley<value_type>> option(OptionValues<value_type> { 36.00, 40.00, 1, 0.20, 0.06 });
+        REQUIRE(compareFloat(option(), baw.putOptionValue(OptionValues<value_type> { 36.00, 40.00, 1, 0.20, 0.06 }), 0));
+        REQUIRE(compareFloat(option(), 4.478, 0.05));
+
+        // Greeks are of the approximation, so agree with those of the American lattice
+        Option<PutExecutor, value_type, Lattice<value_type>> lattice(OptionValues<value_type> { 36.00, 40.00, 1, 0.20, 0.06 },
+                                                                     Lattice<value_type>(2000));
+        REQUIRE(compareFloat(option.delta(), lattice.delta(), 0.02));
+        REQUIRE(compareFloat(option.vega(), lattice.vega(), 0.2));
+    }
+
+    SECTION("Approximation batches priced in parallel match scalar pricing")
+    {
+        OptionBatch<value_type> batch;
+        for (std::size_t row = 0; row < 600; ++row) {
+            const auto type = (row % 3) ? OptionType::Put : OptionType::Call;
+            batch.push(type, OptionValues<value_type> { 30.00 + static_cast<value_type>(row % 20), 40.00, 1, 0.20, 0.06, 0.03 });
+        }
+
+        ThreadPool pool(4);
+        ParallelPricer<value_type, BjerksundStensland<value_type>> parallel(pool, OutputMask { Output::Price, Output::Delta });
+        BatchResults<value_type> results;
+        parallel(batch, results);
+
+        for (const std::size_t row : { 0, 4, 599 }) {
+            const auto values = batch.values(row);
+            const auto expected = (batch.type_[row] == OptionType::Call) ? bjs.callOptionValue(values) : bjs.putOptionValue(values);
+            REQUIRE(compareFloat(results.price_[row], expected, 0));
+        }
+    }
+}
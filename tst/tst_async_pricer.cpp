@@ -0,0 +1,146 @@
+#include "async_pricer.h"
+#include "batch.h"
+#include "constants.h"
+#include "options.h"
+#include "tst_helpers.h"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+
+namespace
+{
+
+// Quote of a request, or the message of its error
+template <typename Pricer>
+auto quoteOrError(AsyncPricer<value_type, Pricer> &pricer, OptionType type, OptionValues<value_type> values,
+                  std::optional<Quote<value_type>> &result, std::string &error) -> Detached {
+    try {
+        result = co_await pricer.price(type, values);
+    }
+    catch (const std::exception &e) {
+        error = e.what();
+    }
+}
+
+// Model which fails to price contracts of a strike of 13
+struct FailingPricer
+{
+    auto callOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        if (values.strikePrice_ == 13.00) {
+            throw std::runtime_error("Cannot price strike 13");
+        }
+        return BlackScholes<value_type>().callOptionValue(values);
+    }
+
+    auto putOptionValue(const OptionValues<value_type> &values) const -> value_type {
+        return BlackScholes<value_type>().putOptionValue(values);
+    }
+};
+
+// Requests a second quote once the first is returned
+auto chain(AsyncPricer<value_type> &pricer, OptionValues<value_type> values,
+           std::optional<Quote<value_type>> &first, std::optional<Quote<value_type>> &second) -> Detached {
+    first = co_await pricer.price(OptionType::Call, values);
+    second = co_await pricer.price(OptionType::Put, values);
+}
+
+}
+
+TEST_CASE("Awaited quotes are coalesced into batches", "[async]")
+{
+    const auto outputs = OutputMask { Output::Price, Output::Delta, Output::Vega };
+    AsyncPricer<value_type> pricer(outputs);
+
+    SECTION("Callers are suspended until flushed, then resumed with their quotes")
+    {
+        std::vector<OptionValues<value_type>> values;
+        for (std::size_t i = 0; i < BATCH_SIZE + 10; ++i) {
+            values.emplace_back(100.00, 80.00 + static_cast<value_type>(i % 40), 0.5, 0.2, 0.03);
+        }
+        std::vector<std::optional<Quote<value_type>>> results(values.size());
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            quote(pricer, (i % 2) ? OptionType::Put : OptionType::Call, values[i], results[i]);
+        }
+        REQUIRE(pricer.pending() == values.size());
+        REQUIRE(std::none_of(results.begin(), results.end(), [](const auto &result) { return result.has_value(); }));
+
+        REQUIRE(pricer.flush() == values.size());
+        REQUIRE(pricer.pending() == 0);
+
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            REQUIRE(results[i].has_value());
+            if (i % 2) {
+                Option<PutExecutor> option(OptionValues<value_type>(values[i]), outputs);
+                REQUIRE(results[i].value()[Output::Price] == option());
+                REQUIRE(results[i].value()[Output::Delta] == option.delta());
+            }
+            else {
+                Option<CallExecutor> option(OptionValues<value_type>(values[i]), outputs);
+                REQUIRE(results[i].value()[Output::Price] == option());
+                REQUIRE(results[i].value()[Output::Vega] == option.vega());
+            }
+            REQUIRE(results[i].value()[Output::Gamma] == 0);
+        }
+    }
+
+    SECTION("Requests made by resumed callers are priced by the same flush")
+    {
+        const OptionValues<value_type> values { 100.00, 95.00, 1, 0.18, 0.05 };
+        std::optional<Quote<value_type>> first, second;
+        chain(pricer, values, first, second);
+
+        REQUIRE(pricer.flush() == 2);
+        REQUIRE(first.has_value());
+        REQUIRE(second.has_value());
+        REQUIRE(second.value()[Output::Price] == Option<PutExecutor>(OptionValues<value_type>(values), outputs)());
+        REQUIRE(pricer.flush() == 0);
+    }
+
+    SECTION("Requests of invalid values fail alone")
+    {
+        OptionValues<value_type> invalid { 100.00, 95.00, 1, 0.18, 0.05 };
+        invalid.volatility_ = 1.5;
+        std::vector<std::optional<Quote<value_type>>> results(3);
+        std::vector<std::string> errors(3);
+        quoteOrError(pricer, OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 }, results[0], errors[0]);
+        quoteOrError(pricer, OptionType::Call, invalid, results[1], errors[1]);
+        quoteOrError(pricer, OptionType::Put, OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 }, results[2], errors[2]);
+
+        REQUIRE(pricer.flush() == 3);
+        REQUIRE(results[0].has_value());
+        REQUIRE_FALSE(results[1].has_value());
+        REQUIRE(errors[1] == "Decimal percentage value cannot be greater than one");
+        REQUIRE(results[2].has_value());
+        REQUIRE(results[2].value()[Output::Price] == Option<PutExecutor>(OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 })());
+    }
+
+    SECTION("Requests failing to price fail alone")
+    {
+        AsyncPricer<value_type, FailingPricer> failing(OutputMask { Output::Price });
+        std::vector<std::optional<Quote<value_type>>> results(3);
+        std::vector<std::string> errors(3);
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto strike = (i == 1) ? 13.00 : 95.00;
+            quoteOrError(failing, OptionType::Call, OptionValues<value_type> { 100.00, strike, 1, 0.18, 0.05 }, results[i], errors[i]);
+        }
+
+        REQUIRE(failing.flush() == 3);
+        REQUIRE(results[0].has_value());
+        REQUIRE(errors[1] == "Cannot price strike 13");
+        REQUIRE(results[2].has_value());
+        REQUIRE(results[2].value()[Output::Price] == results[0].value()[Output::Price]);
+    }
+
+    SECTION("Contracts of unknown type are rejected on request")
+    {
+        REQUIRE_THROWS(pricer.price(OptionType::None, OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 }));
+    }
+}
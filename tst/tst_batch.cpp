@@ -0,0 +1,213 @@
+#include "batch.h"
+#include "constants.h"
+#include "options.h"
+#include "output_writer.h"
+#include "tst_helpers.h"
+
+#include <cmath>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+
+TEST_CASE("Batch pricing of interleaved calls and puts", "[batch]")
+{
+    const std::vector<std::pair<OptionType, OptionValues<value_type>>> rows {
+        { OptionType::Put,  OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 } },
+        { OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 } },
+        { OptionType::Call, OptionValues<value_type> { 40.00, 56.00, 1, 0.10, 0.08 } },
+        { OptionType::Put,  OptionValues<value_type> { 40.00, 56.00, 1, 0.10, 0.08 } },
+        { OptionType::Put,  OptionValues<value_type> { 20.15, 35.20, 0.5, 0.25, 0.03 } },
+        { OptionType::Call, OptionValues<value_type> { 20.15, 35.20, 0.25, 0.25, 0.03, 0.01 } },
+    };
+
+    OptionBatch<value_type> batch;
+    for (const auto &[type, values] : rows) {
+        batch.push(type, values);
+    }
+
+    BatchPricer<value_type> pricer;
+    BatchResults<value_type> results;
+    pricer(batch, results);
+
+    REQUIRE(results.size() == rows.size());
+
+    SECTION("Results are returned in input order and match scalar pricing")
+    {
+        const auto check = [&]<typename Executor>(std::size_t row) {
+            Option<Executor> option(batch.values(row));
+            REQUIRE(results.price_[row] == option());
+            REQUIRE(results.delta_[row] == option.delta());
+            REQUIRE(results.gamma_[row] == option.gamma());
+            REQUIRE(results.theta_[row] == option.theta());
+            REQUIRE(results.vega_[row]  == option.vega());
+            REQUIRE(results.rho_[row]   == option.rho());
+        };
+
+        for (std::size_t row = 0; row < rows.size(); ++row) {
+            if (rows[row].first == OptionType::Call) {
+                check.template operator()<CallExecutor>(row);
+            }
+            else {
+                check.template operator()<PutExecutor>(row);
+            }
+        }
+    }
+
+    SECTION("Known call and put values are scattered back to their rows")
+    {
+        REQUIRE(compareFloat(results.price_[0], 3.06));
+        REQUIRE(compareFloat(results.price_[1], 12.69));
+        REQUIRE(compareFloat(results.delta_[0], -0.257, DP3));
+        REQUIRE(compareFloat(results.delta_[1], 0.743, DP3));
+    }
+
+    SECTION("Batches of unknown option types are rejected")
+    {
+        REQUIRE_THROWS(batch.push(OptionType::None, rows[0].second));
+    }
+}
+
+TEST_CASE("Batch output selection and writing", "[batch]")
+{
+    OptionBatch<value_type> batch;
+    batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 });
+    batch.push(OptionType::Put,  OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 });
+
+    SECTION("Only selected outputs are derived and written")
+    {
+        const OutputMask outputs { Output::Price, Output::Delta };
+        BatchPricer<value_type> pricer(outputs);
+        BatchResults<value_type> results;
+        pricer(batch, results);
+
+        REQUIRE(results.size() == 2);
+        REQUIRE(results.theta_.empty());
+
+        OutputWriter<value_type> writer(outputs);
+        REQUIRE(writer.format(batch, results) ==
+                "Call Option Value: 12.69 Δ: 0.743\n"
+                "Put Option Value: 3.06 Δ: -0.257\n");
+    }
+
+    SECTION("Greeks alone may be derived and written without pricing")
+    {
+        const OutputMask outputs { Output::Gamma, Output::Vega };
+        BatchPricer<value_type> pricer(outputs);
+        BatchResults<value_type> results;
+        pricer(batch, results);
+
+        REQUIRE(results.price_.empty());
+
+        OutputWriter<value_type> writer(outputs);
+        REQUIRE(writer.format(batch, results) ==
+                "Call Option Γ: 0.018, ν: 32.240\n"
+                "Put Option Γ: 0.018, ν: 32.240\n");
+    }
+
+    SECTION("Masked scalar greeks match those derived from all terms")
+    {
+        Option<PutExecutor> masked(batch.values(1), OutputMask { Output::Delta });
+        Option<PutExecutor> full(batch.values(1));
+        REQUIRE(masked.delta() == full.delta());
+    }
+
+    SECTION("Greeks outside of the selected outputs are NaN")
+    {
+        Option<CallExecutor> masked(batch.values(0), OutputMask { Output::Price, Output::Gamma });
+        REQUIRE(std::isnan(masked.delta()));
+        REQUIRE(std::isnan(masked.greek(Output::Vega)));
+        REQUIRE(std::isnan(masked.colour()));
+        REQUIRE_FALSE(std::isnan(masked.gamma()));
+    }
+}
+
+TEST_CASE("Pricing of caller owned columns", "[batch]")
+{
+    const std::size_t rows = (3 * CHUNK_SIZE) + 5;
+    std::vector<std::int32_t> type(rows);
+    std::vector<value_type> underlying(rows, 100.00), strike(rows), time(rows), volatility(rows, 0.2), interest(rows, 0.04);
+    OptionBatch<value_type> batch;
+    for (std::size_t row = 0; row < rows; ++row) {
+        type[row] = (row % 2) ? 1 : 0;
+        strike[row] = 85.0 + static_cast<value_type>(row % 31);
+        time[row] = 0.25 + static_cast<value_type>(row % 9) * 0.5;
+        batch.push(static_cast<OptionType>(type[row]),
+                   OptionValues<value_type> { underlying[row], strike[row], time[row], volatility[row], interest[row] });
+    }
+
+    const ColumnView<value_type> columns { rows, type.data(), underlying.data(), strike.data(), time.data(),
+                                           volatility.data(), interest.data(), nullptr };
+    const OutputMask outputs { Output::Price, Output::Vega };
+    ThreadPool pool(4);
+    ColumnPricer<value_type> pricer(pool, outputs);
+
+    SECTION("Results are written in place and match batch pricing")
+    {
+        std::vector<value_type> price(rows), vega(rows);
+        OutputColumns<value_type> results {};
+        results[static_cast<std::size_t>(Output::Price)] = price.data();
+        results[static_cast<std::size_t>(Output::Vega)] = vega.data();
+        pricer(columns, results);
+
+        BatchResults<value_type> expected;
+        BatchPricer<value_type> batchPricer(outputs);
+        batchPricer(batch, expected);
+        for (std::size_t row = 0; row < rows; ++row) {
+            REQUIRE(price[row] == expected.price_[row]);
+            REQUIRE(vega[row] == expected.vega_[row]);
+        }
+    }
+
+    SECTION("Missing result columns and invalid rows are rejected")
+    {
+        std::vector<value_type> price(rows);
+        OutputColumns<value_type> results {};
+        results[static_cast<std::size_t>(Output::Price)] = price.data();
+        REQUIRE_THROWS(pricer(columns, results));
+
+        std::vector<value_type> vega(rows);
+        results[static_cast<std::size_t>(Output::Vega)] = vega.data();
+        auto invalid = strike;
+        invalid[CHUNK_SIZE + 1] = -1.0;
+        auto invalidColumns = columns;
+        invalidColumns.strikePrice_ = invalid.data();
+        REQUIRE_THROWS_WITH(pricer(invalidColumns, results), Catch::StartsWith("Row " + std::to_string(CHUNK_SIZE + 1)));
+    }
+}
+
+TEST_CASE("Huge page backed batch columns", "[batch]")
+{
+    for (const auto mode : { PageMode::None, PageMode::Transparent, PageMode::Explicit }) {
+        setPageMode(mode);
+
+        // Small columns are left to operator new, and large columns mapped in whole huge pages
+        OptionBatch<value_type> batch;
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 });
+        REQUIRE_FALSE(isMapped(batch.strikePrice_.capacity() * sizeof(value_type)));
+
+        const std::size_t rows = (HUGE_PAGE_SIZE / sizeof(value_type)) + 1000;
+        batch.reserve(rows);
+        for (std::size_t row = 1; row < rows; ++row) {
+            batch.push(OptionType::Put, OptionValues<value_type> { 100.00, 50.0 + static_cast<value_type>(row % 100), 1, 0.18, 0.05 });
+        }
+        REQUIRE(reinterpret_cast<std::uintptr_t>(batch.strikePrice_.data()) % HUGE_PAGE_SIZE == 0);
+        REQUIRE(batch.strikePrice_[0] == 95.00);
+        REQUIRE(batch.strikePrice_[rows - 1] == 50.0 + static_cast<value_type>((rows - 1) % 100));
+
+        BatchPricer<value_type> pricer(OutputMask { Output::Price });
+        BatchResults<value_type> results;
+        pricer(batch, results);
+        REQUIRE(results.price_.size() == rows);
+        REQUIRE(compareFloat(results.price_[0], 12.69));
+    }
+    setPageMode(PageMode::None);
+
+    // Columns of values, and of results, of batches of the huge page size fill a huge page
+    static_assert(!isMapped(BATCH_SIZE * sizeof(value_type)));
+    static_assert(isMapped(HUGE_PAGE_BATCH_SIZE<value_type> * sizeof(value_type)));
+    static_assert(!isMapped((HUGE_PAGE_BATCH_SIZE<value_type> - 1) * sizeof(value_type)));
+
+    REQUIRE(parsePageMode("transparent") == PageMode::Transparent);
+    REQUIRE_THROWS(parsePageMode("giant"));
+}
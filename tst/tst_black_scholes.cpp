@@ -1,8 +1,12 @@
+#include "batch.h"
 #include "black_scholes.h"
 #include "constants.h"
+#include "dividends.h"
 #include "options.h"
 #include "tst_helpers.h"
 
+#include <sstream>
+
 #include "catch2/catch.hpp"
 
 using namespace bsm;
@@ -25,57 +29,49 @@ TEST_CASE("In the money calls, out of the money puts", "[itm]")
 
     SECTION("ITM half year expiry CALL")
     {
-        input.timeToExpiry_ = 0.5;
-        Option<CallExecutor> option(std::move(input));
-        REQUIRE(compareFloat(option(), 9.32));
+        Option<CallExecutor> option(OptionValues<value_type> { 100.00, 95.00, 0.5, 0.18, 0.05 });
+        REQUIRE(compareFloat(option(), 9.41));
     }
 
     SECTION("OTM half year expiry PUT")
     {
-        input.timeToExpiry_ = 0.5;
-        Option<PutExecutor> option(std::move(input));
-        REQUIRE(compareFloat(option(), 1.98));
+        Option<PutExecutor> option(OptionValues<value_type> { 100.00, 95.00, 0.5, 0.18, 0.05 });
+        REQUIRE(compareFloat(option(), 2.07));
     }
 
     SECTION("ITM quarter year expiry CALL")
     {
-        input.timeToExpiry_ = 0.25;
-        Option<CallExecutor> option(std::move(input));
-        REQUIRE(compareFloat(option(), 7.12));
+        Option<CallExecutor> option(OptionValues<value_type> { 100.00, 95.00, 0.25, 0.18, 0.05 });
+        REQUIRE(compareFloat(option(), 7.41));
     }
 
     SECTION("OTM quarter year expiry PUT")
     {
-        input.timeToExpiry_ = 0.25;
-        Option<PutExecutor> option(std::move(input));
-        REQUIRE(compareFloat(option(), 0.934));
+        Option<PutExecutor> option(OptionValues<value_type> { 100.00, 95.00, 0.25, 0.18, 0.05 });
+        REQUIRE(compareFloat(option(), 1.23));
     }
 
     SECTION("ITM one year expiry high volatility CALL")
     {
-        input.volatility_ = 0.6;
-        Option<CallExecutor> option(std::move(input));
+        Option<CallExecutor> option(OptionValues<value_type> { 100.00, 95.00, 1, 0.6, 0.05 });
         REQUIRE(compareFloat(option(), 27.57));
     }
 
     SECTION("OTM one year expiry high volatility PUT")
     {
-        input.volatility_ = 0.6;
-        Option<PutExecutor> option(std::move(input));
+        Option<PutExecutor> option(OptionValues<value_type> { 100.00, 95.00, 1, 0.6, 0.05 });
         REQUIRE(compareFloat(option(), 17.94));
     }
 
     SECTION("ITM one year expiry low interest CALL")
     {
-        input.riskFreeInterest_ = 0.01;
-        Option<CallExecutor> option(std::move(input));
+        Option<CallExecutor> option(OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.01 });
         REQUIRE(compareFloat(option(), 10.33));
     }
 
     SECTION("OTM one year expiry low interest PUT")
     {
-        input.riskFreeInterest_ = 0.01;
-        Option<PutExecutor> option(std::move(input));
+        Option<PutExecutor> option(OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.01 });
         REQUIRE(compareFloat(option(), 4.38));
     }
 }
@@ -98,57 +94,49 @@ TEST_CASE("Out of the money calls, in the money puts", "[otm]")
 
     SECTION("OTM half year expiry CALL")
     {
-        input.timeToExpiry_ = 0.5;
-        Option<CallExecutor> option(std::move(input));
+        Option<CallExecutor> option(OptionValues<value_type> { 20.15, 35.20, 0.5, 0.25, 0.03 });
         REQUIRE(compareFloat(option(), 0.00));
     }
 
     SECTION("ITM half year expiry PUT")
     {
-        input.timeToExpiry_ = 0.5;
-        Option<PutExecutor> option(std::move(input));
-        REQUIRE(compareFloat(option(), 14.16));
+        Option<PutExecutor> option(OptionValues<value_type> { 20.15, 35.20, 0.5, 0.25, 0.03 });
+        REQUIRE(compareFloat(option(), 14.53));
     }
 
     SECTION("OTM quarter year expiry CALL")
     {
-        input.timeToExpiry_ = 0.25;
-        Option<CallExecutor> option(std::move(input));
+        Option<CallExecutor> option(OptionValues<value_type> { 20.15, 35.20, 0.25, 0.25, 0.03 });
         REQUIRE(compareFloat(option(), 0.00));
     }
 
     SECTION("ITM quarter year expiry PUT")
     {
-        input.timeToExpiry_ = 0.25;
-        Option<PutExecutor> option(std::move(input));
-        REQUIRE(compareFloat(option(), 13.41));
+        Option<PutExecutor> option(OptionValues<value_type> { 20.15, 35.20, 0.25, 0.25, 0.03 });
+        REQUIRE(compareFloat(option(), 14.79));
     }
 
     SECTION("OTM one year expiry high volatility CALL")
     {
-        input.volatility_ = 0.6;
-        Option<CallExecutor> option(std::move(input));
+        Option<CallExecutor> option(OptionValues<value_type> { 20.15, 35.20, 1, 0.6, 0.03 });
         REQUIRE(compareFloat(option(), 1.60));
     }
 
     SECTION("ITM one year expiry high volatility PUT")
     {
-        input.volatility_ = 0.6;
-        Option<PutExecutor> option(std::move(input));
+        Option<PutExecutor> option(OptionValues<value_type> { 20.15, 35.20, 1, 0.6, 0.03 });
         REQUIRE(compareFloat(option(), 15.60));
     }
 
     SECTION("OTM one year expiry low interest CALL")
     {
-        input.riskFreeInterest_ = 0.01;
-        Option<CallExecutor> option(std::move(input));
+        Option<CallExecutor> option(OptionValues<value_type> { 20.15, 35.20, 1, 0.25, 0.01 });
         REQUIRE(compareFloat(option(), 0.03));
     }
 
     SECTION("ITM one year expiry low interest PUT")
     {
-        input.riskFreeInterest_ = 0.01;
-        Option<PutExecutor> option(std::move(input));
+        Option<PutExecutor> option(OptionValues<value_type> { 20.15, 35.20, 1, 0.25, 0.01 });
         REQUIRE(compareFloat(option(), 14.73));
     }
 }
@@ -197,3 +185,73 @@ TEST_CASE("At the money CALL and PUT options", "[atm]")
         REQUIRE(compareFloat(option(), 5.56));
     }
 }
+
+TEST_CASE("Continuous dividend yield CALL and PUT options", "[dividend]")
+{
+    OptionValues<value_type> input { 100.00, 95.00, 1, 0.18, 0.05, 0.03 };
+
+    SECTION("ITM one year expiry dividend paying CALL")
+    {
+        Option<CallExecutor> option(std::move(input));
+        REQUIRE(compareFloat(option(), 10.58));
+    }
+
+    SECTION("OTM one year expiry dividend paying PUT")
+    {
+        Option<PutExecutor> option(std::move(input));
+        REQUIRE(compareFloat(option(), 3.90));
+    }
+}
+
+TEST_CASE("Discrete cash dividend schedules", "[dividend]")
+{
+    const DividendSchedule<value_type> schedule { { { 0.75, 1.50 }, { 0.25, 1.50 } }, 0.05 };
+
+    SECTION("Only dividends going ex before expiry are discounted from spot")
+    {
+        REQUIRE(compareFloat(schedule.presentValue(0.1), 0.00, DP3));
+        REQUIRE(compareFloat(schedule.presentValue(0.5), 1.481, DP3));
+        REQUIRE(compareFloat(schedule.presentValue(1.0), 2.926, DP3));
+    }
+
+    SECTION("Dividend schedule shared across a batch chain")
+    {
+        const std::vector<DividendSchedule<value_type>> dividends { DividendSchedule<value_type>{}, schedule };
+
+        OptionBatch<value_type> batch;
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 }, 1);
+        batch.push(OptionType::Put,  OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 }, 1);
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 0.5, 0.18, 0.05 }, 1);
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 }, 0);
+
+        BatchPricer<value_type> pricer(OutputMask::firstOrder(), MarketData<value_type> { dividends });
+        BatchResults<value_type> results;
+        pricer(batch, results);
+
+        REQUIRE(compareFloat(results.price_[0], 10.60));
+        REQUIRE(compareFloat(results.price_[1], 3.89));
+        REQUIRE(compareFloat(results.price_[2], 8.34));
+        REQUIRE(compareFloat(results.price_[3], 12.69));
+    }
+
+    SECTION("Dividends cannot exceed the underlying price")
+    {
+        const DividendSchedule<value_type> excessive { { { 0.5, 150.00 } }, 0.05 };
+        REQUIRE_THROWS(excessive.adjustedSpot(100.00, 1));
+    }
+
+    SECTION("Schedules are read by underlying id, each at its own rate")
+    {
+        std::istringstream input("underlying_id,time,amount,rate\n2,0.75,1.50,0.05\n\n2,0.25,1.50\n0,0.5,2.00\n");
+        const auto dividends = readDividends<value_type>(input);
+        REQUIRE(dividends.size() == 3);
+        REQUIRE(dividends[1].empty());
+        REQUIRE(compareFloat(dividends[2].presentValue(1.0), schedule.presentValue(1.0), 1E-12));
+        REQUIRE(compareFloat(dividends[0].presentValue(1.0), 2.00 * std::exp(-INTEREST * 0.5), 1E-12));
+
+        for (const auto *invalid : { "0,0.5,x\n", "70000,0.5,1\n", "0,0.5,1,0.05\n0,0.75,1,0.04\n", "0,-0.5,1\n" }) {
+            std::istringstream rows(invalid);
+            REQUIRE_THROWS_AS(readDividends<value_type>(rows), std::runtime_error);
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#include "batch.h"
+#include "bsm_c.h"
+#include "constants.h"
+#include "options.h"
+#include "tst_helpers.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+
+TEST_CASE("C API prices batches of caller owned columns", "[c_api]")
+{
+    REQUIRE(bsm_abi_version() == BSM_ABI_VERSION);
+    REQUIRE_FALSE(std::string(bsm_kernel_isa()).empty());
+
+    // More rows than a batch, so are priced across several
+    const std::size_t rows = BATCH_SIZE + 17;
+    std::vector<std::int32_t> type(rows);
+    std::vector<double> underlying(rows), strike(rows), time(rows), volatility(rows), interest(rows), yield(rows);
+    OptionBatch<double> batch;
+    for (std::size_t row = 0; row < rows; ++row) {
+        type[row] = (row % 3 == 0) ? BSM_PUT : BSM_CALL;
+        underlying[row] = 100.00;
+        strike[row] = 80.0 + static_cast<double>(row % 41);
+        time[row] = 0.1 + static_cast<double>(row % 19) * 0.25;
+        volatility[row] = 0.15 + static_cast<double>(row % 7) * 0.02;
+        interest[row] = 0.03;
+        yield[row] = (row % 2) ? 0.01 : 0.0;
+        batch.push((type[row] == BSM_CALL) ? OptionType::Call : OptionType::Put,
+                   OptionValues<double> { underlying[row], strike[row], time[row], volatility[row], interest[row], yield[row] });
+    }
+
+    BatchPricer<double> pricer(OutputMask::all());
+    BatchResults<double> expected;
+    pricer(batch, expected);
+
+    const bsm_columns_d columns { rows, type.data(), underlying.data(), strike.data(), time.data(),
+                                  volatility.data(), interest.data(), yield.data() };
+
+    SECTION("Double precision results match the batch pricer")
+    {
+        std::vector<double> price(rows), delta(rows), colour(rows);
+        bsm_results_d results {};
+        results.price = price.data();
+        results.delta = delta.data();
+        results.colour = colour.data();
+        REQUIRE(bsm_price_batch_d(&columns, &results) == BSM_OK);
+        REQUIRE(std::string(bsm_last_error()).empty());
+
+        for (std::size_t row = 0; row < rows; ++row) {
+            REQUIRE(compareFloat(price[row], expected.price_[row], 1E-9));
+            REQUIRE(compareFloat(delta[row], expected.delta_[row], 1E-9));
+            REQUIRE(compareFloat(colour[row], expected.colour_[row], 1E-9));
+        }
+    }
+
+    SECTION("Single precision results match the batch pricer")
+    {
+        const auto narrow = [](const std::vector<double> &column) {
+            return std::vector<float>(column.begin(), column.end());
+        };
+        const auto underlyingF = narrow(underlying), strikeF = narrow(strike), timeF = narrow(time);
+        const auto volatilityF = narrow(volatility), interestF = narrow(interest);
+        const bsm_columns_f columnsF { rows, type.data(), underlyingF.data(), strikeF.data(), timeF.data(),
+                                       volatilityF.data(), interestF.data(), nullptr };
+
+        std::vector<float> price(rows);
+        bsm_results_f results {};
+        results.price = price.data();
+        REQUIRE(bsm_price_batch_f(&columnsF, &results) == BSM_OK);
+
+        for (std::size_t row = 0; row < rows; ++row) {
+            if (yield[row] == 0.0) {
+                REQUIRE(compareFloat(price[row], expected.price_[row], DP2));
+            }
+        }
+    }
+
+    SECTION("Invalid rows are reported with their index")
+    {
+        auto invalid = volatility;
+        invalid[BATCH_SIZE + 3] = -0.2;
+        auto invalidColumns = columns;
+        invalidColumns.volatility = invalid.data();
+
+        std::vector<double> price(rows);
+        bsm_results_d results {};
+        results.price = price.data();
+        REQUIRE(bsm_price_batch_d(&invalidColumns, &results) == BSM_INVALID_ROW);
+        REQUIRE(std::string(bsm_last_error()).starts_with("Row " + std::to_string(BATCH_SIZE + 3)));
+
+        auto types = type;
+        types[5] = 7;
+        invalidColumns = columns;
+        invalidColumns.type = types.data();
+        REQUIRE(bsm_price_batch_d(&invalidColumns, &results) == BSM_INVALID_ROW);
+    }
+
+    SECTION("Missing arguments are rejected")
+    {
+        bsm_results_d results {};
+        REQUIRE(bsm_price_batch_d(&columns, &results) == BSM_INVALID_ARGUMENT);
+        REQUIRE(bsm_price_batch_d(nullptr, &results) == BSM_INVALID_ARGUMENT);
+        REQUIRE(bsm_price_batch_d(&columns, nullptr) == BSM_INVALID_ARGUMENT);
+
+        std::vector<double> price(rows);
+        results.price = price.data();
+        auto missing = columns;
+        missing.strike_price = nullptr;
+        REQUIRE(bsm_price_batch_d(&missing, &results) == BSM_INVALID_ARGUMENT);
+        REQUIRE_FALSE(std::string(bsm_last_error()).empty());
+    }
+}
@@ -0,0 +1,166 @@
+#include "arg_parser.h"
+#include "batch.h"
+#include "chain.h"
+#include "options.h"
+#include "thread_pool.h"
+#include "tst_helpers.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+using Catch::Matchers::Contains;
+
+namespace
+{
+
+auto ladder(value_type from, value_type step, std::size_t strikes) -> std::vector<value_type> {
+    std::vector<value_type> ladder(strikes);
+    for (std::size_t strike = 0; strike < strikes; ++strike) {
+        ladder[strike] = from + static_cast<value_type>(strike) * step;
+    }
+    return ladder;
+}
+
+// Whether each output of the chain matches that of the same contracts priced as a batch
+auto matchesBatch(const Chain<value_type> &chain, const ChainResults<value_type> &results, const OutputMask outputs) -> bool {
+    OptionBatch<value_type> batch;
+    for (const auto type : { OptionType::Call, OptionType::Put }) {
+        for (std::size_t strike = 0; strike < chain.size(); ++strike) {
+            batch.push(type, OptionValues<value_type> { chain.underlyingPrice_, chain.strikes_[strike], chain.timeToExpiry_,
+                                                        chain.volatility(strike), chain.riskFreeInterest_,
+                                                        chain.dividendYield_ });
+        }
+    }
+    BatchResults<value_type> expected;
+    BatchPricer<value_type> pricer(outputs);
+    pricer(batch, expected);
+
+    for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+        if (!outputs.contains(static_cast<Output>(output))) {
+            continue;
+        }
+        const auto &expectedColumn = expected.column(static_cast<Output>(output));
+        for (std::size_t strike = 0; strike < chain.size(); ++strike) {
+            const auto call = results.calls_.column(static_cast<Output>(output))[strike];
+            const auto put = results.puts_.column(static_cast<Output>(output))[strike];
+            const auto expectedCall = expectedColumn[strike];
+            const auto expectedPut = expectedColumn[chain.size() + strike];
+            const auto tolerance = [](value_type value) { return 1E-12 * std::max<value_type>(1, std::fabs(value)); };
+            if (!compareFloat(call, expectedCall, tolerance(expectedCall))
+                || !compareFloat(put, expectedPut, tolerance(expectedPut))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+TEST_CASE("Chains of strikes are priced as their contracts", "[chain]")
+{
+    const auto strikes = ladder(50.0, 0.25, 500);
+
+    SECTION("Of a single volatility, for each selection of outputs")
+    {
+        const std::vector<value_type> volatility { 0.22 };
+        const Chain<value_type> chain { 100.00, strikes, 0.75, volatility, 0.03, 0.01 };
+        for (const auto outputs : { OutputMask::all(), OutputMask::firstOrder(), OutputMask { Output::Price },
+                                    OutputMask { Output::Speed, Output::Volga } }) {
+            ChainResults<value_type> results;
+            ChainPricer<value_type> pricer(outputs);
+            pricer(chain, results);
+            REQUIRE(results.calls_.size() == strikes.size());
+            REQUIRE(results.puts_.size() == strikes.size());
+            REQUIRE(matchesBatch(chain, results, outputs));
+        }
+    }
+
+    SECTION("Of volatilities by strike")
+    {
+        std::vector<value_type> volatilities(strikes.size());
+        for (std::size_t strike = 0; strike < strikes.size(); ++strike) {
+            volatilities[strike] = 0.15 + 0.0004 * std::fabs(strikes[strike] - 100.00);
+        }
+        const auto results = priceChain(100.00, strikes, 0.25, volatilities, 0.04, 0.0, OutputMask::all());
+        REQUIRE(matchesBatch(Chain<value_type> { 100.00, strikes, 0.25, volatilities, 0.04, 0.0 }, results, OutputMask::all()));
+    }
+
+    SECTION("By the dispatched kernel, across a pool, as on the calling thread")
+    {
+        const std::vector<value_type> volatility { 0.3 };
+        const Chain<value_type> chain { 95.50, strikes, 1.5, volatility, 0.02, 0.015 };
+        ChainResults<value_type> serial;
+        priceChain(chain, serial, OutputMask::all());
+        REQUIRE(matchesBatch(chain, serial, OutputMask::all()));
+
+        ThreadPool pool(4);
+        ChainResults<value_type> parallel;
+        priceChain(chain, parallel, OutputMask::all(), &pool);
+        for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+            REQUIRE(parallel.calls_.column(static_cast<Output>(output)) == serial.calls_.column(static_cast<Output>(output)));
+            REQUIRE(parallel.puts_.column(static_cast<Output>(output)) == serial.puts_.column(static_cast<Output>(output)));
+        }
+    }
+
+    SECTION("Invalid strikes are reported by index")
+    {
+        auto invalid = strikes;
+        invalid[7] = -1.0;
+        REQUIRE_THROWS_WITH(priceChain(100.00, invalid, 0.5, std::vector<value_type> { 0.2 }, 0.03, 0.0),
+                            Contains("Strike 7") && Contains("Price cannot be less than zero"));
+        REQUIRE_THROWS_AS(priceChain(100.00, strikes, 0.5, std::vector<value_type> { 0.2, 0.3 }, 0.03, 0.0),
+                          std::runtime_error);
+        REQUIRE_THROWS_AS(priceChain(100.00, strikes, 0.5, std::vector<value_type> { 1.2 }, 0.03, 0.0),
+                          std::runtime_error);
+        REQUIRE_THROWS_AS(priceChain(100.00, strikes, 0.5, std::vector<value_type> { 0.2 }, -0.03, 0.0),
+                          std::runtime_error);
+    }
+}
+
+TEST_CASE("Chain runs of the bsm binary", "[chain][input]")
+{
+    ArgParser parser;
+    const auto expiry = getDateOffset(90);
+
+    SECTION("Ladders are generated inclusive of both ends")
+    {
+        const Args in { "-u", "100", "-t", expiry, "--chain", "80:120:0.1", "-v", "0.25" };
+        REQUIRE(parser.populateArgs(in));
+        REQUIRE(parser.isChainRun());
+        const auto chain = parser.getChain();
+        REQUIRE(chain.strikes_.size() == 401);
+        REQUIRE(chain.strikes_.front() == 80.0);
+        REQUIRE(compareFloat(chain.strikes_.back(), 120.0, 1E-9));
+        REQUIRE(chain.volatilities_ == std::vector<value_type> { 0.25 });
+        REQUIRE(compareFloat(chain.riskFreeInterest_, INTEREST));
+    }
+
+    SECTION("Chain runs require only the underlying price and expiry")
+    {
+        const Args noExpiry { "-u", "100", "--chain", "80:120:1" };
+        const Args noUnderlying { "--chain", "80:120:1" };
+        REQUIRE_FALSE(parser.populateArgs(noExpiry));
+        REQUIRE_FALSE(parser.populateArgs(noUnderlying));
+        REQUIRE_FALSE(parser.isBatchRun());
+    }
+
+    SECTION("Invalid ladders are rejected")
+    {
+        const auto ladder = [&](const char *spec) {
+            const Args in { "-u", "100", "-t", expiry, "--chain", spec };
+            ArgParser ladderParser;
+            REQUIRE(ladderParser.populateArgs(in));
+            return ladderParser.getChain();
+        };
+        REQUIRE(ladder("80:120:1").strikes_.size() == 41);
+        for (const auto *spec : { "80:120", "80:120:0", "120:80:1", "80:120:1:2", "80::1", "80:120:x" }) {
+            REQUIRE_THROWS_WITH(ladder(spec), Contains("Invalid strike ladder given for --chain") && Contains(spec));
+        }
+        REQUIRE_THROWS_WITH(ladder("0:1E9:1E-3"), Contains("cannot be of more than 100000 strikes"));
+    }
+}
@@ -0,0 +1,148 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+using Catch::Matchers::Contains;
+
+namespace
+{
+
+auto contents(const std::filesystem::path &path) -> std::string {
+    std::ifstream file(path, std::ios::binary);
+    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+auto hashOf(std::initializer_list<std::string_view> lines) -> std::uint64_t {
+    LineHash hash;
+    for (const auto line : lines) {
+        hash.add(line);
+    }
+    return hash.value();
+}
+
+// Write and commit a chunk of the given results
+void commit(Checkpoint &checkpoint, std::size_t index, std::string_view results) {
+    auto file = checkpoint.open(index);
+    std::fwrite(results.data(), sizeof(char), results.size(), file.get());
+    checkpoint.commit(index, std::move(file), Chunk { 100, 98, hashOf({ results }), 0 });
+}
+
+}
+
+TEST_CASE("Input lines are hashed by content and line", "[checkpoint]")
+{
+    REQUIRE(hashOf({ "call,100.00,95.00", "put,100.00,95.00" }) == hashOf({ "call,100.00,95.00", "put,100.00,95.00" }));
+    REQUIRE(hashOf({ "call,100.00,95.00", "put,100.00,95.00" }) != hashOf({ "call,100.00,95.00", "put,100.00,95.01" }));
+    REQUIRE(hashOf({ "call,100.00", ",95.00" }) != hashOf({ "call,100.00,", "95.00" }));
+    REQUIRE(hashOf({ "" }) != hashOf({ "", "" }));
+}
+
+TEST_CASE("Checkpointed chunks", "[checkpoint]")
+{
+    const auto directory = std::filesystem::temp_directory_path() / "bsm_tst_checkpoint";
+    std::filesystem::remove_all(directory);
+    const auto outputs = OutputMask { Output::Price, Output::Delta };
+
+    SECTION("Committed chunks are renamed in place, and found complete by a rerun")
+    {
+        {
+            Checkpoint checkpoint(directory, 100, Format::CSV, outputs);
+            REQUIRE(checkpoint.completed(0) == nullptr);
+            commit(checkpoint, 0, "Call Option Value: 12.69 Δ: 0.743\n");
+            commit(checkpoint, 1, "Put Option Value: 2.51 Δ: -0.257\n");
+            REQUIRE_FALSE(checkpoint.chunks().has_value());
+        }
+        REQUIRE(contents(directory / "chunk-000001.out") == "Put Option Value: 2.51 Δ: -0.257\n");
+        REQUIRE_FALSE(std::filesystem::exists(directory / "chunk-000001.out.pending"));
+
+        Checkpoint checkpoint(directory, 100, Format::CSV, outputs);
+        const auto *chunk = checkpoint.completed(1);
+        REQUIRE(chunk != nullptr);
+        REQUIRE(chunk->lines_ == 100);
+        REQUIRE(chunk->contracts_ == 98);
+        REQUIRE(chunk->hash_ == hashOf({ "Put Option Value: 2.51 Δ: -0.257\n" }));
+        REQUIRE(checkpoint.completed(0) != nullptr);
+        REQUIRE(checkpoint.completed(2) == nullptr);
+
+        checkpoint.finish(2);
+        REQUIRE(Checkpoint(directory, 100, Format::CSV, outputs).chunks() == 2);
+    }
+
+    SECTION("Chunks left pending, or whose results are since lost, are not complete")
+    {
+        {
+            Checkpoint checkpoint(directory, 100, Format::NDJSON, outputs);
+            commit(checkpoint, 0, "{\"option_type\":\"call\",\"price\":12.69}\n");
+            commit(checkpoint, 1, "{\"option_type\":\"put\",\"price\":2.51}\n");
+            auto pending = checkpoint.open(2);
+            std::fputs("{\"option_type\":\"call\"", pending.get());
+        }
+        std::filesystem::resize_file(directory / "chunk-000001.ndjson", 10);
+
+        Checkpoint checkpoint(directory, 100, Format::NDJSON, outputs);
+        REQUIRE(checkpoint.completed(0) != nullptr);
+        REQUIRE(checkpoint.completed(1) == nullptr);
+        REQUIRE(checkpoint.completed(2) == nullptr);
+
+        // Rewriting the chunk replaces its pending file
+        commit(checkpoint, 2, "{\"option_type\":\"put\",\"price\":2.51}\n");
+        REQUIRE(contents(directory / "chunk-000002.ndjson") == "{\"option_type\":\"put\",\"price\":2.51}\n");
+    }
+
+    SECTION("Checkpoints of other settings are rejected")
+    {
+        {
+            Checkpoint checkpoint(directory, 100, Format::CSV, outputs);
+            commit(checkpoint, 0, "Call Option Value: 12.69 Δ: 0.743\n");
+        }
+        REQUIRE_THROWS_WITH(Checkpoint(directory, 50, Format::CSV, outputs), Contains("other chunk lines"));
+        REQUIRE_THROWS_AS(Checkpoint(directory, 100, Format::NDJSON, outputs), std::runtime_error);
+        REQUIRE_THROWS_AS(Checkpoint(directory, 100, Format::CSV, OutputMask::all()), std::runtime_error);
+        REQUIRE_NOTHROW(Checkpoint(directory, 100, Format::CSV, outputs));
+        REQUIRE_THROWS_AS(Checkpoint(directory / "other", 0, Format::CSV, outputs), std::runtime_error);
+    }
+
+    SECTION("Checkpoints of another valuation date, or other surfaces, curves or dividends, are rejected")
+    {
+        std::filesystem::create_directories(directory);
+        const auto surfaces = directory / "surfaces.csv", curves = directory / "curves.csv";
+        const auto dividends = directory / "dividends.csv";
+        std::ofstream(surfaces) << "0,0.5,1.0,0.2\n0,0.5,1.1,0.21\n";
+        std::ofstream(curves) << "0,1.0,0.97\n";
+        std::ofstream(dividends) << "0,0.25,1.5\n";
+        const auto inputs = RunInputs { "2000-01-03", surfaces, curves, dividends };
+        {
+            Checkpoint checkpoint(directory / "run", 100, Format::CSV, outputs, inputs);
+            commit(checkpoint, 0, "Call Option Value: 12.69 Δ: 0.743\n");
+        }
+        REQUIRE_NOTHROW(Checkpoint(directory / "run", 100, Format::CSV, outputs, inputs));
+        REQUIRE_THROWS_WITH(Checkpoint(directory / "run", 100, Format::CSV, outputs, RunInputs { "2000-01-04", surfaces, curves, dividends }),
+                            Contains("other valuation date"));
+        REQUIRE_THROWS_WITH(Checkpoint(directory / "run", 100, Format::CSV, outputs, RunInputs { "2000-01-03", std::nullopt, curves, dividends }),
+                            Contains("other surfaces"));
+        REQUIRE_THROWS_WITH(Checkpoint(directory / "run", 100, Format::CSV, outputs, RunInputs { "2000-01-03", surfaces, curves, std::nullopt }),
+                            Contains("other dividends"));
+        REQUIRE_THROWS_WITH(Checkpoint(directory / "run", 100, Format::CSV, outputs), Contains("other valuation date"));
+
+        // Inputs are compared by content, rather than by path
+        std::ofstream(curves) << "0,1.0,0.96\n";
+        REQUIRE_THROWS_WITH(Checkpoint(directory / "run", 100, Format::CSV, outputs, inputs), Contains("other curves"));
+        std::ofstream(curves) << "0,1.0,0.97\n";
+        const auto moved = directory / "moved.csv";
+        std::filesystem::rename(curves, moved);
+        REQUIRE_NOTHROW(Checkpoint(directory / "run", 100, Format::CSV, outputs, RunInputs { "2000-01-03", surfaces, moved, dividends }));
+        REQUIRE_THROWS_WITH(Checkpoint(directory / "run", 100, Format::CSV, outputs, inputs), Contains("Cannot open"));
+    }
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,231 @@
+#include "compressed_reader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(BSM_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(BSM_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+using Catch::Matchers::Contains;
+
+namespace
+{
+
+using File = std::unique_ptr<std::FILE, decltype(&std::fclose)>;
+
+// Lines of varying length, over several blocks, the last without a newline
+auto makeText() -> std::string {
+    std::string text;
+    for (std::size_t line = 0; text.size() < 3 * CompressedReader::BLOCK_SIZE; ++line) {
+        text += "call,100.00," + std::to_string(line) + std::string(line % 97, '0') + ",0.2,0.03,0.01,\n";
+    }
+    text += "put,100.00,95.00,0.2,0.03,0.01,";
+    return text;
+}
+
+auto lines(std::string_view text) -> std::vector<std::string> {
+    std::vector<std::string> lines;
+    while (!text.empty()) {
+        const auto pos = text.find('\n');
+        lines.emplace_back(text.substr(0, pos));
+        text.remove_prefix((pos == std::string_view::npos) ? text.size() : pos + 1);
+    }
+    return lines;
+}
+
+auto write(const std::string &bytes) -> File {
+    File file(std::tmpfile(), &std::fclose);
+    std::fwrite(bytes.data(), 1, bytes.size(), file.get());
+    std::rewind(file.get());
+    return file;
+}
+
+auto readAll(CompressedReader &reader) -> std::vector<std::string> {
+    std::vector<std::string> lines;
+    while (const auto line = reader.next()) {
+        lines.emplace_back(line.value());
+    }
+    return lines;
+}
+
+#if defined(BSM_HAVE_ZLIB)
+// Text compressed as the given number of concatenated gzip members
+auto gzip(std::string_view text, std::size_t members) -> std::string {
+    std::string compressed;
+    const auto size = (text.size() + members - 1) / members;
+    for (std::size_t offset = 0; offset < text.size(); offset += size) {
+        const auto part = text.substr(offset, size);
+        z_stream stream {};
+        REQUIRE(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+        std::string out(deflateBound(&stream, static_cast<uLong>(part.size())), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(part.data()));
+        stream.avail_in = static_cast<uInt>(part.size());
+        stream.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream.avail_out = static_cast<uInt>(out.size());
+        REQUIRE(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        compressed += out;
+    }
+    return compressed;
+}
+#endif
+
+#if defined(BSM_HAVE_ZSTD)
+// Text compressed as the given number of zstd frames, each ending in a checksum
+// of its content, where given
+auto zstd(std::string_view text, std::size_t frames, bool checksum = false) -> std::string {
+    const std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+    REQUIRE_FALSE(ZSTD_isError(ZSTD_CCtx_setParameter(context.get(), ZSTD_c_checksumFlag, checksum ? 1 : 0)));
+    std::string compressed;
+    const auto size = (text.size() + frames - 1) / frames;
+    for (std::size_t offset = 0; offset < text.size(); offset += size) {
+        const auto part = text.substr(offset, size);
+        std::string out(ZSTD_compressBound(part.size()), '\0');
+        const auto written = ZSTD_compress2(context.get(), out.data(), out.size(), part.data(), part.size());
+        REQUIRE_FALSE(ZSTD_isError(written));
+        out.resize(written);
+        compressed += out;
+    }
+    return compressed;
+}
+#endif
+
+}
+
+TEST_CASE("Compression is detected by magic number", "[input][compressed]")
+{
+    for (const auto &[bytes, compression] : {
+             std::pair { std::string("\x1F\x8B\x08"), Compression::Gzip },
+             std::pair { std::string("\x28\xB5\x2F\xFD"), Compression::Zstd },
+             std::pair { std::string("option_type,"), Compression::None },
+             std::pair { std::string(), Compression::None },
+         }) {
+        auto file = write(bytes);
+        REQUIRE(detectCompression(file.get()) == compression);
+        // The magic number is left to be read
+        REQUIRE(std::getc(file.get()) == (bytes.empty() ? EOF : static_cast<unsigned char>(bytes.front())));
+    }
+}
+
+#if defined(BSM_HAVE_ZLIB)
+TEST_CASE("Gzip input is read line by line", "[input][compressed]")
+{
+    const auto text = makeText();
+    const auto expected = lines(text);
+
+    SECTION("Lines spanning blocks and members are read whole")
+    {
+        for (const auto members : { std::size_t{1}, std::size_t{5} }) {
+            auto file = write(gzip(text, members));
+            CompressedReader reader(file.get(), detectCompression(file.get()));
+            REQUIRE(reader.threads() == 1);
+            REQUIRE(readAll(reader) == expected);
+            REQUIRE_FALSE(reader.next().has_value());
+        }
+    }
+
+    SECTION("Truncated input is reported once the lines before it are read")
+    {
+        const auto compressed = gzip(text, 1);
+        auto file = write(compressed.substr(0, compressed.size() / 2));
+        CompressedReader reader(file.get(), Compression::Gzip);
+        std::size_t read = 0;
+        REQUIRE_THROWS_WITH([&] { while (reader.next()) { ++read; } }(), Contains("truncated"));
+        REQUIRE(read > 0);
+    }
+
+    SECTION("Corrupt input is reported")
+    {
+        auto compressed = gzip(text, 1);
+        compressed[compressed.size() / 2] ^= 0x55;
+        compressed[compressed.size() / 2 + 1] ^= 0x55;
+        auto file = write(compressed);
+        CompressedReader reader(file.get(), Compression::Gzip);
+        REQUIRE_THROWS_AS([&] { while (reader.next()) {} }(), std::runtime_error);
+    }
+
+    SECTION("Readers may be destroyed before their input is read")
+    {
+        auto file = write(gzip(text, 1));
+        CompressedReader reader(file.get(), Compression::Gzip);
+        REQUIRE(reader.next().value() == expected.front());
+    }
+}
+#endif
+
+#if defined(BSM_HAVE_ZSTD)
+TEST_CASE("Zstd input is read line by line", "[input][compressed]")
+{
+    const auto text = makeText();
+    const auto expected = lines(text);
+
+    SECTION("Frames are decompressed in turn, or in parallel, in order")
+    {
+        for (const auto frames : { std::size_t{1}, std::size_t{12} }) {
+            for (const auto threads : { std::size_t{1}, std::size_t{4} }) {
+                auto file = write(zstd(text, frames));
+                CompressedReader reader(file.get(), detectCompression(file.get()), threads);
+                REQUIRE(reader.threads() == ((frames > 1) ? threads : 1));
+                REQUIRE(readAll(reader) == expected);
+            }
+        }
+    }
+
+    SECTION("Truncated input is reported")
+    {
+        for (const auto threads : { std::size_t{1}, std::size_t{4} }) {
+            const auto compressed = zstd(text, 4);
+            auto file = write(compressed.substr(0, compressed.size() - 10));
+            CompressedReader reader(file.get(), Compression::Zstd, threads);
+            REQUIRE_THROWS_AS([&] { while (reader.next()) {} }(), std::runtime_error);
+        }
+    }
+
+    SECTION("Corrupt frames decompressed in parallel are reported once the lines before them are read")
+    {
+        // A large frame, and a small one, which fails well before the large frame is
+        // decompressed. Its checksum is corrupted, so that the frames are still indexed.
+        std::string large;
+        while (large.size() < CompressedReader::MAX_FRAME_SIZE / 2) {
+            large += text + "\n";
+        }
+        auto small = zstd(text.substr(0, 100), 1, true);
+        small.back() ^= 0x55;
+        auto file = write(zstd(large, 1, true) + small);
+        CompressedReader reader(file.get(), Compression::Zstd, 2);
+        REQUIRE(reader.threads() == 2);
+
+        std::vector<std::string> read;
+        REQUIRE_THROWS_WITH([&] { while (const auto line = reader.next()) { read.emplace_back(line.value()); } }(),
+                            Contains("checksum"));
+        large.pop_back();
+        const auto expected = lines(large);
+        REQUIRE(read.size() == expected.size());
+        REQUIRE(std::equal(read.begin(), read.end(), expected.begin()));
+    }
+}
+#endif
+
+TEST_CASE("Unsupported compression is rejected", "[input][compressed]")
+{
+    auto file = write("\x28\xB5\x2F\xFD");
+    for (const auto compression : { Compression::None, Compression::Gzip, Compression::Zstd }) {
+        if (!compressionSupported(compression)) {
+            REQUIRE_THROWS_AS(CompressedReader(file.get(), compression), std::runtime_error);
+        }
+    }
+    REQUIRE_FALSE(compressionSupported(Compression::None));
+}
@@ -0,0 +1,196 @@
+#include "batch.h"
+#include "constants.h"
+#include "discount_curve.h"
+#include "input_reader.h"
+#include "options.h"
+#include "thread_pool.h"
+#include "tst_helpers.h"
+
+#include <cmath>
+#include <sstream>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+using Catch::Matchers::Contains;
+
+TEST_CASE("Discount curve interpolation", "[curve]")
+{
+    const DiscountCurve<value_type> curve({ 0.5, 1.0, 2.0 }, { 0.99, 0.975, 0.94 });
+
+    SECTION("Nodes are reproduced exactly")
+    {
+        REQUIRE(compareFloat(curve.discount(0.5), 0.99, 1E-12));
+        REQUIRE(compareFloat(curve.discount(1.0), 0.975, 1E-12));
+        REQUIRE(compareFloat(curve.discount(2.0), 0.94, 1E-12));
+        REQUIRE(curve.discount(0.0) == 1.0);
+    }
+
+    SECTION("Forward rates are flat between nodes")
+    {
+        const auto forward = std::log(0.99 / 0.975) / 0.5;
+        REQUIRE(compareFloat(curve.forwardRate(0.5, 1.0), forward, 1E-12));
+        REQUIRE(compareFloat(curve.forwardRate(0.6, 0.9), forward, 1E-12));
+        REQUIRE(compareFloat(curve.discount(0.75), std::sqrt(0.99 * 0.975), 1E-12));
+        REQUIRE_THROWS(curve.forwardRate(1.0, 1.0));
+    }
+
+    SECTION("The last forward rate is extrapolated")
+    {
+        const auto forward = std::log(0.975 / 0.94);
+        REQUIRE(compareFloat(curve.forwardRate(2.0, 5.0), forward, 1E-12));
+        REQUIRE(compareFloat(curve.discount(3.0), 0.94 * std::exp(-forward), 1E-12));
+    }
+
+    SECTION("Zero rates imply the discount factors")
+    {
+        for (const auto time : { 0.25, 0.5, 1.5, 3.0 }) {
+            const auto discount = curve(time);
+            REQUIRE(compareFloat(discount.factor_, curve.discount(time), 1E-12));
+            REQUIRE(compareFloat(discount.rate_, curve.zeroRate(time), 1E-12));
+            REQUIRE(compareFloat(std::exp(-discount.rate_ * time), discount.factor_, 1E-12));
+        }
+    }
+
+    SECTION("Curves built from zero rates match flat rates")
+    {
+        const auto flat = DiscountCurve<value_type>::fromZeroRates({ 1.0, 5.0 }, { 0.05, 0.05 });
+        REQUIRE(compareFloat(flat.discount(2.5), std::exp(-0.05 * 2.5), 1E-12));
+        REQUIRE(compareFloat(flat.zeroRate(0.1), 0.05, 1E-12));
+    }
+
+    SECTION("Malformed curves are rejected")
+    {
+        REQUIRE_THROWS(DiscountCurve<value_type>({}, {}));
+        REQUIRE_THROWS(DiscountCurve<value_type>({ 1.0, 0.5 }, { 0.99, 0.98 }));
+        REQUIRE_THROWS(DiscountCurve<value_type>({ 0.0 }, { 1.0 }));
+        REQUIRE_THROWS(DiscountCurve<value_type>({ 1.0 }, { 0.0 }));
+        REQUIRE_THROWS(DiscountCurve<value_type>({ 1.0 }, { 0.9, 0.8 }));
+    }
+}
+
+TEST_CASE("Discount factors are cached per expiry", "[curve]")
+{
+    const DiscountCurve<value_type> curve({ 0.5, 1.0, 2.0 }, { 0.99, 0.975, 0.94 });
+    DiscountCache<value_type> cache(curve);
+
+    const auto &first = cache(0.75);
+    const auto &second = cache(0.75);
+    REQUIRE(&first == &second);
+    REQUIRE(compareFloat(first.factor_, curve.discount(0.75), 1E-12));
+    cache(1.25);
+    REQUIRE(cache.size() == 2);
+}
+
+TEST_CASE("Discount curves read from CSV", "[curve]")
+{
+    SECTION("Curves are indexed by id")
+    {
+        std::istringstream input("curve_id,time,discount_factor\n"
+                                 "1,2.0,0.94\n1,0.5,0.99\n1,1.0,0.975\n");
+        const auto curves = readCurves<value_type>(input);
+        REQUIRE(curves.size() == 2);
+        REQUIRE(curves[0].empty());
+        REQUIRE(compareFloat(curves[1].discount(1.0), 0.975, 1E-12));
+    }
+
+    SECTION("Malformed fields are rejected")
+    {
+        std::istringstream input("0,1.0,abc\n");
+        REQUIRE_THROWS_WITH(readCurves<value_type>(input), Contains("Cannot parse"));
+    }
+
+    SECTION("Ids beyond the maximum, or of no curve, are rejected")
+    {
+        for (const auto *id : { "65536", "4294967295" }) {
+            std::istringstream input(std::string(id) + ",1.0,0.97\n");
+            REQUIRE_THROWS_WITH(readCurves<value_type>(input), Contains("cannot be greater than 65535"));
+        }
+        std::istringstream input("65535,1.0,0.97\n");
+        REQUIRE(readCurves<value_type>(input).size() == 65536);
+    }
+}
+
+TEST_CASE("Batches discounted from curves", "[curve]")
+{
+    const std::vector<DiscountCurve<value_type>> curves {
+        DiscountCurve<value_type>({ 0.5, 1.0, 2.0 }, { 0.99, 0.975, 0.94 }),
+    };
+
+    SECTION("Rows referencing a curve are priced at its zero rate")
+    {
+        OptionBatch<value_type> batch;
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 0.75, 0.20, 0.00 }, 0, NO_SURFACE, 0);
+        batch.push(OptionType::Put,  OptionValues<value_type> { 100.00, 105.00, 0.75, 0.20, 0.00 }, 0, NO_SURFACE, 0);
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 1.5, 0.20, 0.03 });
+
+        BatchPricer<value_type> pricer(OutputMask { Output::Price, Output::Rho }, MarketData<value_type> { {}, {}, curves });
+        BatchResults<value_type> results;
+        pricer(batch, results);
+
+        const auto rate = curves[0].zeroRate(0.75);
+        const BlackScholes<value_type> bsm;
+        REQUIRE(compareFloat(results.price_[0], bsm.callOptionValue(OptionValues<value_type> { 100.00, 95.00, 0.75, 0.20, rate }), 1E-12));
+        REQUIRE(compareFloat(results.price_[1], bsm.putOptionValue(OptionValues<value_type> { 100.00, 105.00, 0.75, 0.20, rate }), 1E-12));
+        REQUIRE(compareFloat(results.price_[2], bsm.callOptionValue(OptionValues<value_type> { 100.00, 95.00, 1.5, 0.20, 0.03 }), 1E-12));
+    }
+
+    SECTION("Parallel pricers discount each distinct expiry once, across chunks and batches")
+    {
+        OptionBatch<value_type> batch;
+        for (std::size_t row = 0; row < (4 * CHUNK_SIZE) + 3; ++row) {
+            const auto type = (row % 2) ? OptionType::Put : OptionType::Call;
+            const auto expiry = 0.25 + static_cast<value_type>(row % 3) * 0.5;
+            batch.push(type, OptionValues<value_type> { 100.00, 90.00 + static_cast<value_type>(row % 20), expiry, 0.20, 0.00 },
+                       0, NO_SURFACE, 0);
+        }
+
+        ThreadPool pool(4);
+        ParallelPricer<value_type> parallel(pool, OutputMask { Output::Price, Output::Rho }, MarketData<value_type> { {}, {}, curves });
+        BatchResults<value_type> results;
+        parallel(batch, results);
+        parallel(batch, results);
+        REQUIRE(parallel.discounts().size() == 1);
+        REQUIRE(parallel.discounts()[0].size() == 3);
+
+        BatchPricer<value_type> serial(OutputMask { Output::Price, Output::Rho }, MarketData<value_type> { {}, {}, curves });
+        BatchResults<value_type> expected;
+        serial(batch, expected);
+        REQUIRE(results.price_ == expected.price_);
+        REQUIRE(results.rho_ == expected.rho_);
+    }
+
+    SECTION("Flat curves price as flat rates")
+    {
+        const std::vector<DiscountCurve<value_type>> flat { DiscountCurve<value_type>::fromZeroRates({ 1.0 }, { 0.04 }) };
+        OptionBatch<value_type> batch;
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 0.75, 0.20, 0.00 }, 0, NO_SURFACE, 0);
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 0.75, 0.20, 0.04 });
+
+        BatchPricer<value_type> pricer(OutputMask { Output::Price }, MarketData<value_type> { {}, {}, flat });
+        BatchResults<value_type> results;
+        pricer(batch, results);
+        REQUIRE(compareFloat(results.price_[0], results.price_[1], 1E-12));
+    }
+
+    SECTION("Unknown curves are rejected")
+    {
+        OptionBatch<value_type> batch;
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 0.75, 0.20, 0.00 }, 0, NO_SURFACE, 4);
+        BatchPricer<value_type> pricer(OutputMask { Output::Price }, MarketData<value_type> { {}, {}, curves });
+        BatchResults<value_type> results;
+        REQUIRE_THROWS_WITH(pricer(batch, results), Contains("Cannot find discount curve 4"));
+    }
+
+    SECTION("CSV input gives a curve id in place of rate")
+    {
+        InputReader<value_type> reader(Format::CSV);
+        const auto expiry = getDateOffset(30);
+        const auto [type, values, surface, curve, position] = reader.getOptionValues("call,100.00,105.00," + expiry + ",0.2,@2,0.01,");
+        REQUIRE(values.has_value());
+        REQUIRE(surface == NO_SURFACE);
+        REQUIRE(curve == 2);
+        REQUIRE(values->riskFreeInterest_ == 0);
+        REQUIRE_FALSE(std::get<1>(reader.getOptionValues("call,100.00,105.00," + expiry + ",0.2,@,0.01,")).has_value());
+    }
+}
@@ -0,0 +1,161 @@
+#include "batch.h"
+#include "constants.h"
+#include "discount_curve.h"
+#include "finite_difference.h"
+#include "options.h"
+#include "thread_pool.h"
+#include "tst_helpers.h"
+#include "vol_surface.h"
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+
+TEST_CASE("Finite difference greeks agree with analytic greeks", "[finite_difference]")
+{
+    OptionBatch<value_type> batch;
+    for (const auto type : { OptionType::Call, OptionType::Put }) {
+        batch.push(type, OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 });
+        batch.push(type, OptionValues<value_type> { 40.00, 56.00, 1, 0.10, 0.08 });
+        batch.push(type, OptionValues<value_type> { 20.15, 35.20, 0.25, 0.25, 0.03, 0.02 });
+        batch.push(type, OptionValues<value_type> { 40.50, 40.50, 1.5, 0.3, 0.01 });
+    }
+
+    BatchPricer<value_type> pricer;
+    BatchResults<value_type> analytic;
+    pricer(batch, analytic);
+
+    SECTION("Analytic and numeric greeks are within tolerance")
+    {
+        ThreadPool pool(2);
+        FiniteDifference<value_type> numeric(pool);
+        BatchResults<value_type> results;
+        numeric(batch, results);
+
+        REQUIRE(results.size() == batch.size());
+        for (std::size_t row = 0; row < batch.size(); ++row) {
+            REQUIRE(results.price_[row] == analytic.price_[row]);
+            REQUIRE(compareFloat(results.delta_[row], analytic.delta_[row], DP3));
+            REQUIRE(compareFloat(results.gamma_[row], analytic.gamma_[row], DP3));
+            REQUIRE(compareFloat(results.theta_[row], analytic.theta_[row], DP3));
+            REQUIRE(compareFloat(results.vega_[row],  analytic.vega_[row],  DP3));
+            REQUIRE(compareFloat(results.rho_[row],   analytic.rho_[row],   DP3));
+        }
+        REQUIRE(FiniteDifference<value_type>::compare(analytic, results, 1E-4).empty());
+    }
+
+    SECTION("Rates at their lower bound are differenced one sided")
+    {
+        OptionBatch<value_type> zeroRate;
+        zeroRate.push(OptionType::Put, OptionValues<value_type> { 40.50, 40.50, 1.5, 0.3, 0.00 });
+        pricer(zeroRate, analytic);
+
+        ThreadPool pool(1);
+        FiniteDifference<value_type> numeric(pool);
+        BatchResults<value_type> results;
+        numeric(zeroRate, results);
+
+        REQUIRE(compareFloat(results.rho_[0], analytic.rho_[0], DP2));
+    }
+
+    SECTION("Inputs at their upper bounds are differenced within them")
+    {
+        OptionBatch<value_type> bounded;
+        bounded.push(OptionType::Call, OptionValues<value_type> { 99999.00, 99990.00, 0.5, 0.3, 0.03 });
+        bounded.push(OptionType::Put, OptionValues<value_type> { 100.00, 95.00, 10, 0.3, 0.03 });
+        bounded.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 1, 0.99995, 0.03 });
+        bounded.push(OptionType::Put, OptionValues<value_type> { 100.00, 95.00, 1, 0.3, 0.99995 });
+        pricer(bounded, analytic);
+
+        ThreadPool pool(1);
+        FiniteDifference<value_type> numeric(pool);
+        BatchResults<value_type> results;
+        REQUIRE_NOTHROW(numeric(bounded, results));
+        REQUIRE(FiniteDifference<value_type>::compare(analytic, results, DP2).empty());
+    }
+
+    SECTION("Volatilities of surface rows are looked up before bumping")
+    {
+        const std::vector<VolSurface<value_type>> surfaces {
+            VolSurface<value_type>({ 0.8, 1.0, 1.2 }, { 0.5, 2.0 }, { 0.26, 0.20, 0.23, 0.24, 0.19, 0.21 }),
+        };
+        const MarketData<value_type> market { {}, surfaces };
+        OptionBatch<value_type> surfaced;
+        surfaced.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 1, 0.2, 0.05 }, 0, 0);
+        surfaced.push(OptionType::Put, OptionValues<value_type> { 100.00, 110.00, 0.75, 0.2, 0.03 }, 0, 0);
+        surfaced.push(OptionType::Put, OptionValues<value_type> { 100.00, 110.00, 0.75, 0.2, 0.03 });
+
+        BatchPricer<value_type> surfacePricer(OutputMask::firstOrder(), market);
+        surfacePricer(surfaced, analytic);
+
+        ThreadPool pool(1);
+        FiniteDifference<value_type> numeric(pool, market);
+        BatchResults<value_type> results;
+        numeric(surfaced, results);
+
+        REQUIRE(results.price_ == analytic.price_);
+        REQUIRE(results.vega_[1] != results.vega_[2]);
+        REQUIRE(FiniteDifference<value_type>::compare(analytic, results, DP3).empty());
+
+        FiniteDifference<value_type> unsurfaced(pool);
+        REQUIRE_THROWS_WITH(unsurfaced(surfaced, results), "Cannot find volatility surface 0");
+    }
+
+    SECTION("Zero rates of curve rows are looked up before bumping")
+    {
+        const std::vector<DiscountCurve<value_type>> curves {
+            DiscountCurve<value_type>({ 0.5, 1.0, 5.0 }, { 0.99, 0.975, 0.88 }),
+        };
+        const MarketData<value_type> market { {}, {}, curves };
+        OptionBatch<value_type> discounted;
+        discounted.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 1, 0.2, 0 }, 0, NO_SURFACE, 0);
+        discounted.push(OptionType::Put, OptionValues<value_type> { 100.00, 110.00, 0.75, 0.2, 0 }, 0, NO_SURFACE, 0);
+        discounted.push(OptionType::Put, OptionValues<value_type> { 100.00, 110.00, 0.75, 0.2, 0 });
+
+        BatchPricer<value_type> curvePricer(OutputMask::firstOrder(), market);
+        curvePricer(discounted, analytic);
+
+        ThreadPool pool(1);
+        FiniteDifference<value_type> numeric(pool, market);
+        BatchResults<value_type> results;
+        numeric(discounted, results);
+
+        for (std::size_t row = 0; row < discounted.size(); ++row) {
+            REQUIRE(compareFloat(results.price_[row], analytic.price_[row], 1E-12));
+        }
+        REQUIRE(results.rho_[1] != results.rho_[2]);
+        REQUIRE(FiniteDifference<value_type>::compare(analytic, results, DP3).empty());
+
+        FiniteDifference<value_type> uncurved(pool);
+        REQUIRE_THROWS_WITH(uncurved(discounted, results), "Cannot find discount curve 0");
+    }
+
+    SECTION("Numeric greeks do not depend on the number of threads")
+    {
+        ThreadPool single(1);
+        ThreadPool multiple(4);
+        BatchResults<value_type> lhs, rhs;
+        FiniteDifference<value_type> singleNumeric(single);
+        FiniteDifference<value_type> multipleNumeric(multiple);
+        singleNumeric(batch, lhs);
+        multipleNumeric(batch, rhs);
+
+        for (const auto output : { Output::Delta, Output::Gamma, Output::Theta, Output::Vega, Output::Rho }) {
+            REQUIRE(lhs.column(output) == rhs.column(output));
+        }
+    }
+
+    SECTION("Divergent greeks are reported by row")
+    {
+        auto diverged = analytic;
+        diverged.gamma_[3] += 0.1;
+        diverged.rho_[5] *= 2;
+
+        const auto divergences = FiniteDifference<value_type>::compare(analytic, diverged, DP3);
+        REQUIRE(divergences.size() == 2);
+        REQUIRE(divergences[0].row_ == 3);
+        REQUIRE(divergences[0].output_ == Output::Gamma);
+        REQUIRE(divergences[1].row_ == 5);
+        REQUIRE(divergences[1].output_ == Output::Rho);
+    }
+}
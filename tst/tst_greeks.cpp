@@ -1,3 +1,4 @@
+#include "batch.h"
 #include "constants.h"
 #include "options.h"
 #include "tst_helpers.h"
@@ -25,13 +26,13 @@ TEST_CASE("Greek calculations derived from ITM CALL and OTM PUTs", "[itm_greeks]
     SECTION("ITM one year expiry CALL gamma")
     {
         Option<CallExecutor> option(std::move(input));
-        REQUIRE(compareFloat(option.gamma(), 0.019, DP3));
+        REQUIRE(compareFloat(option.gamma(), 0.018, DP3));
     }
 
     SECTION("OTM one year expiry PUT gamma")
     {
         Option<PutExecutor> option(std::move(input));
-        REQUIRE(compareFloat(option.gamma(), 0.019, DP3));
+        REQUIRE(compareFloat(option.gamma(), 0.018, DP3));
     }
 
     SECTION("ITM one year expiry CALL theta")
@@ -135,3 +136,61 @@ TEST_CASE("Greek calculations derived from OTM CALL and ITM PUTs", "[otm_greeks]
         REQUIRE(compareFloat(option.rho(), -51.464, DP3));
     }
 }
+
+TEST_CASE("Higher order greeks derived from ITM CALL and OTM PUTs", "[higher_order_greeks]")
+{
+    OptionValues<value_type> input { 100.00, 95.00, 1, 0.18, 0.05 };
+
+    SECTION("ITM one year expiry CALL vanna and volga")
+    {
+        Option<CallExecutor> option(std::move(input));
+        REQUIRE(compareFloat(option.vanna(), -0.847, DP3));
+        REQUIRE(compareFloat(option.volga(), 55.269, DP3));
+    }
+
+    SECTION("OTM one year expiry PUT vanna and volga")
+    {
+        Option<PutExecutor> option(std::move(input));
+        REQUIRE(compareFloat(option.vanna(), -0.847, DP3));
+        REQUIRE(compareFloat(option.volga(), 55.269, DP3));
+    }
+
+    SECTION("ITM one year expiry CALL charm")
+    {
+        Option<CallExecutor> option(std::move(input));
+        REQUIRE(compareFloat(option.charm(), -0.0134, 1E-4));
+    }
+
+    SECTION("ITM one year expiry CALL speed, zomma and colour")
+    {
+        Option<CallExecutor> option(std::move(input));
+        REQUIRE(compareFloat(option.speed(), -0.00083, 1E-5));
+        REQUIRE(compareFloat(option.zomma(), -0.0688, 1E-4));
+        REQUIRE(compareFloat(option.colour(), 0.00944, 1E-5));
+    }
+
+    SECTION("Half year expiry dividend paying CALL and PUT charm")
+    {
+        Option<CallExecutor> call(OptionValues<value_type> { 100.00, 95.00, 0.5, 0.18, 0.05, 0.03 });
+        Option<PutExecutor> put(OptionValues<value_type> { 100.00, 95.00, 0.5, 0.18, 0.05, 0.03 });
+        REQUIRE(compareFloat(call.charm(), 0.109, DP3));
+        REQUIRE(compareFloat(put.charm(), 0.080, DP3));
+    }
+
+    SECTION("Batch derives only the selected higher order greeks")
+    {
+        OptionBatch<value_type> batch;
+        batch.push(OptionType::Put, input);
+        batch.push(OptionType::Call, input);
+
+        BatchPricer<value_type> pricer({ Output::Delta, Output::Vanna, Output::Charm });
+        BatchResults<value_type> results;
+        pricer(batch, results);
+
+        REQUIRE(results.price_.empty());
+        REQUIRE(results.gamma_.empty());
+        REQUIRE(compareFloat(results.delta_[0], -0.257, DP3));
+        REQUIRE(compareFloat(results.vanna_[1], -0.847, DP3));
+        REQUIRE(compareFloat(results.charm_[1], -0.0134, 1E-4));
+    }
+}
@@ -3,10 +3,14 @@
 
 #include <chrono>
 #include <cmath>
+#include <coroutine>
+#include <exception>
 #include <iomanip>
 #include <iostream>
+#include <optional>
 #include <string>
 
+#include "async_pricer.h"
 #include "constants.h"
 
 namespace bsm
@@ -47,6 +51,25 @@ static auto dateToString(std::tm &time) -> std::string {
     return dateToString(offset);
 }
 
+// Coroutine which runs eagerly, and whose frame is freed on completion
+struct Detached
+{
+    struct promise_type
+    {
+        auto get_return_object() -> Detached { return {}; }
+        auto initial_suspend() noexcept -> std::suspend_never { return {}; }
+        auto final_suspend() noexcept -> std::suspend_never { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// Await the quote of a request of the pricer, setting the result once resumed
+inline auto quote(AsyncPricer<value_type> &pricer, OptionType type, OptionValues<value_type> values,
+                  std::optional<Quote<value_type>> &result) -> Detached {
+    result = co_await pricer.price(type, values);
+}
+
 } // bsm
 
 #endif
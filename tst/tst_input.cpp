@@ -1,7 +1,19 @@
 #include "arg_parser.h"
+#include "batch.h"
 #include "constants.h"
+#include "input_reader.h"
+#include "output_writer.h"
 #include "tst_helpers.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include "catch2/catch.hpp"
 
 using namespace bsm;
@@ -124,4 +136,342 @@ TEST_CASE("Input interface to bsm binary", "[input]")
         REQUIRE(parser.populateArgs(in));
         REQUIRE_THROWS(parser.getOptionValues(), Contains("Price"), Contains("greater than 100000"));
     }
+
+    SECTION("Verify selected outputs are parsed alongside contract flags")
+    {
+        const value_type daysOffset = 30;
+        const Args in { "-o", "put", "-u", "95", "-s", "100", "-t", getDateOffset(daysOffset), "--outputs", "price,delta,vega" };
+        REQUIRE(parser.populateArgs(in));
+        REQUIRE(!parser.isBatchRun());
+        REQUIRE(parser.getOutputs() == OutputMask { Output::Price, Output::Delta, Output::Vega });
+        REQUIRE(parser.getOptionType() == OptionType::Put);
+    }
+
+    SECTION("Verify first order outputs are selected by default")
+    {
+        const value_type daysOffset = 30;
+        const Args in { "-o", "put", "-u", "95", "-s", "100", "-t", getDateOffset(daysOffset) };
+        REQUIRE(parser.populateArgs(in));
+        REQUIRE(parser.getOutputs() == OutputMask::firstOrder());
+    }
+
+    SECTION("Verify run options without contract flags select a batch run")
+    {
+        const Args in { "--outputs", "delta" };
+        REQUIRE(parser.populateArgs(in));
+        REQUIRE(parser.isBatchRun());
+        REQUIRE(parser.getOutputs() == OutputMask { Output::Delta });
+    }
+
+    SECTION("Verify unknown outputs are rejected")
+    {
+        const Args in { "--outputs", "price,omega" };
+        REQUIRE(parser.populateArgs(in));
+        REQUIRE_THROWS(parser.getOutputs(), Contains("Unknown output"));
+    }
+
+    SECTION("Verify run options require a value")
+    {
+        const Args in { "--outputs" };
+        REQUIRE(!parser.populateArgs(in));
+    }
+
+    SECTION("Verify arguments are parsed in place from argv")
+    {
+        const auto date = getDateOffset(30);
+        const char *argv[] { "bsm", "-o", "Call", "--threads", "3", "-u", "95", "-s", "100", "-t", date.c_str(), "-d", "0.01" };
+        REQUIRE(parser.populateArgs(static_cast<int>(std::size(argv)), argv));
+        REQUIRE(parser.getNumberArgs() == 6);
+        REQUIRE(parser.getOptionType() == OptionType::Call);
+        REQUIRE(parser.getThreads() == 3);
+
+        auto values = parser.getOptionValues();
+        REQUIRE(values.underlyingPrice_ == 95.0);
+        REQUIRE(values.dividendYield_ == 0.01);
+        REQUIRE(values.volatility_ == IMPLIED_VOL);
+    }
+
+    SECTION("Verify contract flags require a value, and numbers are well formed")
+    {
+        const Args missing { "-o", "call", "-u", "95", "-s", "100", "-t" };
+        REQUIRE(!parser.populateArgs(missing));
+
+        const Args in { "-o", "call", "-u", "95x", "-s", "100", "-t", getDateOffset(30) };
+        REQUIRE(parser.populateArgs(in));
+        REQUIRE_THROWS_WITH(parser.getOptionValues(), Contains("Invalid number given for --underlying-price"));
+    }
+
+    SECTION("Verify flags are found by short and long name")
+    {
+        static_assert(findFlag("-u")->flag_ == Flag::Underlying);
+        static_assert(findFlag("--rate-of-interest")->flag_ == Flag::Interest);
+        static_assert(findFlag("--affinity")->kind_ == FlagKind::Run);
+        static_assert(findFlag("") == nullptr && findFlag("--underlying") == nullptr);
+        static_assert(NUM_BASE_FLAGS == 4 && NUM_ALL_FLAGS == 7);
+    }
+}
+
+TEST_CASE("Whole inputs are read into a single buffer", "[input]")
+{
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> file(std::tmpfile(), &std::fclose);
+    REQUIRE(file);
+
+    // More than a read, so that the file is read in several, into the buffer reserved by its size
+    std::string contents;
+    for (std::size_t line = 0; contents.size() <= BufferReader::READ_SIZE; ++line) {
+        contents += "line " + std::to_string(line) + "\n";
+    }
+    contents += "\nlast";
+    std::fwrite(contents.data(), 1, contents.size(), file.get());
+    std::rewind(file.get());
+
+    BufferReader reader(file.get());
+    REQUIRE(reader.size() == contents.size());
+
+    std::size_t lines = 0;
+    std::optional<std::string_view> line, previous;
+    while ((line = reader.next())) {
+        if (lines < 2) {
+            REQUIRE(line.value() == "line " + std::to_string(lines));
+        }
+        previous.swap(line);
+        ++lines;
+    }
+    REQUIRE(previous.value() == "last");
+    REQUIRE(lines == static_cast<std::size_t>(std::count(contents.begin(), contents.end(), '\n')) + 1);
+}
+
+TEST_CASE("NDJSON contracts are read by field name", "[input]")
+{
+    InputReader<value_type> reader(Format::NDJSON);
+    const auto expiry = getDateOffset(30);
+
+    SECTION("Fields are read in any order, skipping unknown fields")
+    {
+        const auto line = R"({"book_id": 7, "meta": {"desk": "fx", "tags": ["a", "}"]}, "strike_price": 105.0,)"
+                          R"( "option_type": "put", "underlying_price": 1e2, "expiry_time": ")" + expiry +
+                          R"(", "implied_volatility": 0.25, "interest_rate": "@3", "dividend_yield": 0.01, "quantity": -2.5})";
+        const auto [type, values, surface, curve, position] = reader.getOptionValues(line);
+        REQUIRE(type == OptionType::Put);
+        REQUIRE(values.has_value());
+        REQUIRE(values->underlyingPrice_ == 100.0);
+        REQUIRE(values->strikePrice_ == 105.0);
+        REQUIRE(compareFloat(values->timeToExpiry_, 30 / DAY_TO_YEAR, DP3));
+        REQUIRE(values->volatility_ == 0.25);
+        REQUIRE(values->dividendYield_ == 0.01);
+        REQUIRE(surface == NO_SURFACE);
+        REQUIRE(curve == 3);
+        REQUIRE(position.quantity_ == -2.5);
+        REQUIRE(position.book_ == 7);
+        REQUIRE(position.underlying_ == 0);
+    }
+
+    SECTION("Omitted volatility, rate and yield take their defaults")
+    {
+        const auto [type, values, surface, curve, position] = reader.getOptionValues(
+            R"({"option_type":"call","underlying_price":95,"strike_price":100,"time_to_expiry":0.5})");
+        REQUIRE(type == OptionType::Call);
+        REQUIRE(values.has_value());
+        REQUIRE(values->timeToExpiry_ == 0.5);
+        REQUIRE(values->volatility_ == IMPLIED_VOL);
+        REQUIRE(values->riskFreeInterest_ == INTEREST);
+        REQUIRE(values->dividendYield_ == YIELD);
+        REQUIRE(position.quantity_ == 1);
+    }
+
+    SECTION("Malformed or incomplete contracts are rejected")
+    {
+        for (const auto *line : {
+                 R"({"option_type":"call","underlying_price":95,"strike_price":100})",
+                 R"({"option_type":"swap","underlying_price":95,"strike_price":100,"time_to_expiry":0.5})",
+                 R"({"option_type":"call","underlying_price":"95","strike_price":100,"time_to_expiry":0.5})",
+                 R"({"option_type":"call","underlying_price":95 "strike_price":100,"time_to_expiry":0.5})",
+                 R"({"option_type":"call","underlying_price":95,"strike_price":100,"time_to_expiry":0.5)",
+                 R"({"option_type":"call","underlying_price":95,"strike_price":100,"time_to_expiry":0.5} x)",
+                 R"({"option_type":"call","underlying_price":95,"strike_price":100,"time_to_expiry":0.5,"interest_rate":"3"})",
+                 R"(["call",95,100,0.5])",
+             }) {
+            REQUIRE_FALSE(std::get<1>(reader.getOptionValues(line)).has_value());
+        }
+    }
+
+    SECTION("Request ids are read raw, even of lines which are not contracts")
+    {
+        REQUIRE(std::get<1>(reader.getOptionValues(
+            R"({"id": {"desk": "fx", "seq": 7} ,"option_type":"call","underlying_price":95,"strike_price":100,"time_to_expiry":0.5})")).has_value());
+        REQUIRE(reader.requestId() == R"({"desk": "fx", "seq": 7})");
+
+        REQUIRE_FALSE(std::get<1>(reader.getOptionValues(R"({"option_type":"swap","id":"a-1"})")).has_value());
+        REQUIRE(reader.requestId() == R"("a-1")");
+
+        REQUIRE_FALSE(std::get<1>(reader.getOptionValues("not json")).has_value());
+        REQUIRE(reader.requestId().empty());
+    }
+
+    SECTION("Formats are selected by name")
+    {
+        REQUIRE(parseFormat("csv") == Format::CSV);
+        REQUIRE(parseFormat("ndjson") == Format::NDJSON);
+        REQUIRE_THROWS_AS(parseFormat("json"), std::runtime_error);
+    }
+}
+
+TEST_CASE("NDJSON results are written by output name", "[input]")
+{
+    OptionBatch<value_type> batch;
+    batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 0.5, 0.2, 0.03 });
+    batch.push(OptionType::Put, OptionValues<value_type> { 100.00, 95.00, 0.5, 0.2, 0.03 });
+
+    BatchResults<value_type> results;
+    results.resize(batch.size());
+    results.price_ = { 0.1, 2.5 };
+    results.delta_ = { 0.75, std::numeric_limits<value_type>::quiet_NaN() };
+
+    NdjsonWriter<value_type> writer(OutputMask { Output::Price, Output::Delta });
+    REQUIRE(writer.format(batch, results) ==
+            "{\"option_type\":\"call\",\"price\":0.1,\"delta\":0.75}\n"
+            "{\"option_type\":\"put\",\"price\":2.5,\"delta\":null}\n");
+
+    SECTION("Results are keyed by request, with an error object for each line which is not a contract")
+    {
+        const std::vector<NdjsonRequest> requests {
+            { 1, "\"a-1\"", true }, { 2, "", false }, { 4, "", true }, { 5, "7", false },
+        };
+        REQUIRE(writer.format(batch, results, requests) ==
+                "{\"id\":\"a-1\",\"option_type\":\"call\",\"price\":0.1,\"delta\":0.75}\n"
+                "{\"line\":2,\"error\":\"Cannot read contract\"}\n"
+                "{\"line\":4,\"option_type\":\"put\",\"price\":2.5,\"delta\":null}\n"
+                "{\"id\":7,\"error\":\"Cannot read contract\"}\n");
+
+        REQUIRE(writer.format(OptionBatch<value_type> {}, results, std::vector<NdjsonRequest> { { 9, "", false } }) ==
+                "{\"line\":9,\"error\":\"Cannot read contract\"}\n");
+        REQUIRE_THROWS_AS(writer.format(OptionBatch<value_type> {}, results, std::vector<NdjsonRequest> { { 9, "", true } }),
+                          std::runtime_error);
+    }
+}
+
+TEST_CASE("CSV columns are mapped by header", "[input]")
+{
+    InputReader<value_type> reader(Format::CSV);
+    const auto expiry = getDateOffset(30);
+
+    SECTION("Columns are found by name, in any order, skipping unknown columns")
+    {
+        REQUIRE_FALSE(std::get<1>(reader.getOptionValues(
+            "trade_id,strike_price, \"option_type\",desk,underlying_price,expiry_time,interest_rate,book_id\r")).has_value());
+        REQUIRE(reader.columns() == std::vector<ContractField> {
+            ContractField::None, ContractField::Strike, ContractField::OptionType, ContractField::None,
+            ContractField::Underlying, ContractField::Expiry, ContractField::Interest, ContractField::Book });
+
+        const auto [type, values, surface, curve, position] = reader.getOptionValues("T-1,105.00,put,not a number,100.00," + expiry + ",@2,4\r");
+        REQUIRE(type == OptionType::Put);
+        REQUIRE(values.has_value());
+        REQUIRE(values->underlyingPrice_ == 100.0);
+        REQUIRE(values->strikePrice_ == 105.0);
+        REQUIRE(compareFloat(values->timeToExpiry_, 30 / DAY_TO_YEAR, DP3));
+        REQUIRE(values->volatility_ == IMPLIED_VOL);
+        REQUIRE(values->dividendYield_ == YIELD);
+        REQUIRE(surface == NO_SURFACE);
+        REQUIRE(curve == 2);
+        REQUIRE(position.book_ == 4);
+
+        // Rows must give every column of the header
+        REQUIRE_FALSE(std::get<1>(reader.getOptionValues("T-1,105.00,put,x,100.00," + expiry + ",@2")).has_value());
+        REQUIRE_FALSE(std::get<1>(reader.getOptionValues("T-1,105.00,put,x,100.00," + expiry + ",@2,4,5")).has_value());
+    }
+
+    SECTION("Empty volatility, rate and yield fields take their defaults")
+    {
+        reader.getOptionValues("option_type,underlying_price,strike_price,time_to_expiry,implied_volatility,interest_rate,dividend_yield,");
+        const auto [type, values, surface, curve, position] = reader.getOptionValues("Call,100,95,0.5,,,,");
+        REQUIRE(type == OptionType::Call);
+        REQUIRE(values.has_value());
+        REQUIRE(values->timeToExpiry_ == 0.5);
+        REQUIRE(values->volatility_ == IMPLIED_VOL);
+        REQUIRE(values->riskFreeInterest_ == INTEREST);
+        REQUIRE(values->dividendYield_ == YIELD);
+    }
+
+    SECTION("Without a header, columns are positional, and the first line is a contract")
+    {
+        const auto [type, values, surface, curve, position] = reader.getOptionValues("put,100.00,105.00," + expiry + ",0.2,0.05,0.01,");
+        REQUIRE(type == OptionType::Put);
+        REQUIRE(values.has_value());
+        REQUIRE(values->volatility_ == 0.2);
+        REQUIRE(values->riskFreeInterest_ == 0.05);
+        REQUIRE(std::equal(reader.columns().begin(), reader.columns().end(), std::begin(CSV_DEFAULT_COLUMNS)));
+
+        // A header after the first line is not a contract
+        REQUIRE_FALSE(std::get<1>(reader.getOptionValues(
+            "option_type,underlying_price,strike_price,expiry_time,implied_volatility,interest_rate,dividend_yield,")).has_value());
+    }
+
+    SECTION("The legacy header, of misnamed volatility and rate columns, is read by position")
+    {
+        REQUIRE_FALSE(std::get<1>(reader.getOptionValues(
+            "option_type,underlying_price,strike_price,expiry_time,interest_rate,implied_volatility,dividend_yield,")).has_value());
+        REQUIRE(std::equal(reader.columns().begin(), reader.columns().end(), std::begin(CSV_DEFAULT_COLUMNS)));
+
+        const auto [type, values, surface, curve, position] = reader.getOptionValues("put,100.00,105.00," + expiry + ",0.2,0.05,0.01,");
+        REQUIRE(values.has_value());
+        REQUIRE(values->volatility_ == 0.2);
+        REQUIRE(values->riskFreeInterest_ == 0.05);
+
+        // Named in any other order, or with other columns, they are mapped by name
+        InputReader<value_type> named(Format::CSV);
+        named.getOptionValues("option_type,underlying_price,strike_price,expiry_time,interest_rate,implied_volatility,dividend_yield,book_id");
+        REQUIRE(named.columns()[4] == ContractField::Interest);
+    }
+
+    SECTION("Headers without a required column are rejected")
+    {
+        REQUIRE_THROWS_WITH(reader.getOptionValues("option_type,underlying_price,expiry_time"), Contains("strike_price"));
+        InputReader<value_type> undated(Format::CSV);
+        REQUIRE_THROWS_WITH(undated.getOptionValues("option_type,underlying_price,strike_price"), Contains("expiry_time"));
+    }
+}
+
+TEST_CASE("The shipped sample input is priced as before headers were mapped", "[input]")
+{
+    std::ifstream file(BSM_TEST_INPUT_DIR "/bsm.csv");
+    REQUIRE(file);
+    // Contracts are moved to an expiry yet to pass
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+        if (!lines.empty() && !line.empty()) {
+            const auto begin = line.find(',', line.find(',', line.find(',') + 1) + 1) + 1;
+            line.replace(begin, line.find(',', begin) - begin, getDateOffset(90));
+        }
+        lines.push_back(line);
+    }
+    REQUIRE(lines.size() > 1);
+
+    // Read with its header, and as every line was once read, by position without it
+    const auto read = [](const auto begin, const auto end) {
+        InputReader<value_type> reader(Format::CSV);
+        OptionBatch<value_type> batch;
+        for (auto line = begin; line != end; ++line) {
+            const auto [type, values, surface, curve, position] = reader.getOptionValues(*line);
+            if (values) {
+                batch.push(type, values.value());
+            }
+        }
+        return batch;
+    };
+    const auto headed = read(lines.begin(), lines.end());
+    const auto positional = read(lines.begin() + 1, lines.end());
+    REQUIRE(headed.size() == 4);
+    REQUIRE(positional.size() == headed.size());
+    REQUIRE(headed.volatility_ == positional.volatility_);
+    REQUIRE(headed.riskFreeInterest_ == positional.riskFreeInterest_);
+    REQUIRE(headed.volatility_[0] == 0.1);
+    REQUIRE(headed.riskFreeInterest_[0] == 0.02);
+
+    BatchPricer<value_type> pricer(OutputMask::all());
+    BatchResults<value_type> headedResults, positionalResults;
+    pricer(headed, headedResults);
+    pricer(positional, positionalResults);
+    REQUIRE(headedResults.price_ == positionalResults.price_);
+    REQUIRE(headedResults.vega_ == positionalResults.vega_);
+    REQUIRE(headedResults.rho_ == positionalResults.rho_);
 }
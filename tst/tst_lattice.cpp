@@ -0,0 +1,110 @@
+#include "batch.h"
+#include "constants.h"
+#include "lattice.h"
+#include "options.h"
+#include "thread_pool.h"
+#include "tst_helpers.h"
+
+#include <cmath>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+
+TEST_CASE("European lattice prices converge to Black Scholes", "[lattice]")
+{
+    const OptionValues<value_type> input { 100.00, 95.00, 1, 0.18, 0.05, 0.02 };
+    const BlackScholes<value_type> bsm;
+
+    for (const auto method : { LatticeMethod::Binomial, LatticeMethod::Trinomial }) {
+        const auto name = (method == LatticeMethod::Binomial) ? "binomial" : "trinomial";
+
+        DYNAMIC_SECTION("Unsmoothed " << name << " lattice CALL and PUT")
+        {
+            const Lattice<value_type> lattice(2000, Exercise::European, method);
+            REQUIRE(compareFloat(lattice.callOptionValue(input), bsm.callOptionValue(input), DP2));
+            REQUIRE(compareFloat(lattice.putOptionValue(input), bsm.putOptionValue(input), DP2));
+        }
+
+        DYNAMIC_SECTION("Smoothed and extrapolated " << name << " lattice CALL and PUT, with fewer steps")
+        {
+            const Lattice<value_type> lattice(200, Exercise::European, method, Smoothing::BlackScholesRichardson);
+            REQUIRE(compareFloat(lattice.callOptionValue(input), bsm.callOptionValue(input), DP3));
+            REQUIRE(compareFloat(lattice.putOptionValue(input), bsm.putOptionValue(input), DP3));
+        }
+    }
+}
+
+TEST_CASE("American lattice prices", "[lattice]")
+{
+    // Reference value of 4.478, as given by Longstaff & Schwartz (2001)
+    const OptionValues<value_type> input { 36.00, 40.00, 1, 0.20, 0.06 };
+
+    SECTION("American PUT carries an early exercise premium")
+    {
+        const Lattice<value_type> lattice(2000);
+        REQUIRE(compareFloat(lattice.putOptionValue(input), 4.478, DP2));
+        REQUIRE(lattice.putOptionValue(input) > BlackScholes<value_type>().putOptionValue(input));
+    }
+
+    SECTION("American trinomial PUT with BBSR smoothing converges in fewer steps")
+    {
+        const Lattice<value_type> lattice(200, Exercise::American, LatticeMethod::Trinomial, Smoothing::BlackScholesRichardson);
+        REQUIRE(compareFloat(lattice.putOptionValue(input), 4.478, DP2));
+    }
+
+    SECTION("American CALL without dividends is never exercised early")
+    {
+        const Lattice<value_type> lattice(2000);
+        REQUIRE(compareFloat(lattice.callOptionValue(input), BlackScholes<value_type>().callOptionValue(input), DP2));
+    }
+
+    SECTION("Lattice pricing through the option interface")
+    {
+        Option<PutExecutor, value_type, Lattice<value_type>> option(OptionValues<value_type> { 36.00, 40.00, 1, 0.20, 0.06 },
+                                                                    Lattice<value_type>(2000));
+        REQUIRE(compareFloat(option(), 4.478, DP2));
+    }
+
+    SECTION("Greeks through the option interface are of the lattice")
+    {
+        // Smoothed lattices converge smoothly, so are differenced as stably as the closed form
+        const OptionValues<value_type> atTheMoney { 40.00, 40.00, 1, 0.20, 0.02 };
+        Option<PutExecutor, value_type, Lattice<value_type>> european(
+            OptionValues<value_type>(atTheMoney),
+            Lattice<value_type>(500, Exercise::European, LatticeMethod::Binomial, Smoothing::BlackScholesRichardson));
+        Option<PutExecutor> closedForm { OptionValues<value_type>(atTheMoney) };
+        for (const auto output : { Output::Delta, Output::Gamma, Output::Theta, Output::Vega, Output::Rho }) {
+            REQUIRE(compareFloat(european.greek(output), closedForm.greek(output), 0.01 * std::fabs(closedForm.greek(output))));
+        }
+
+        // Early exercise of the deep in the money put takes its delta nearer to -1
+        const OptionValues<value_type> inTheMoney { 36.00, 40.00, 1, 0.20, 0.06 };
+        Option<PutExecutor, value_type, Lattice<value_type>> american(OptionValues<value_type>(inTheMoney), Lattice<value_type>(2000));
+        Option<PutExecutor> europeanDelta { OptionValues<value_type>(inTheMoney), OutputMask { Output::Delta } };
+        REQUIRE(american.delta() < europeanDelta.delta() - 0.05);
+        REQUIRE(std::isnan(american.vanna()));
+    }
+
+    SECTION("Lattice batches priced in parallel match serial pricing")
+    {
+        OptionBatch<value_type> batch;
+        for (std::size_t row = 0; row < 600; ++row) {
+            const auto type = (row % 3) ? OptionType::Put : OptionType::Call;
+            batch.push(type, OptionValues<value_type> { 30.00 + static_cast<value_type>(row % 20), 40.00, 1, 0.20, 0.06 });
+        }
+
+        const Lattice<value_type> lattice(100);
+        BatchPricer<value_type, Lattice<value_type>> serial(OutputMask { Output::Price }, {}, lattice);
+        BatchResults<value_type> serialResults;
+        serial(batch, serialResults);
+
+        ThreadPool pool(4);
+        ParallelPricer<value_type, Lattice<value_type>> parallel(pool, OutputMask { Output::Price }, {}, lattice);
+        BatchResults<value_type> parallelResults;
+        parallel(batch, parallelResults);
+
+        REQUIRE(serialResults.price_ == parallelResults.price_);
+        REQUIRE(compareFloat(serialResults.price_[4], lattice.putOptionValue(batch.values(4)), 0));
+    }
+}
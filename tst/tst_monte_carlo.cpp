@@ -0,0 +1,276 @@
+#include "batch.h"
+#include "brownian_bridge.h"
+#include "constants.h"
+#include "monte_carlo.h"
+#include "options.h"
+#include "philox.h"
+#include "sobol.h"
+#include "thread_pool.h"
+#include "tst_helpers.h"
+
+#include <cmath>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+
+TEST_CASE("Philox counter based random numbers", "[monte_carlo]")
+{
+    SECTION("Known answers, as given by Random123")
+    {
+        using Counter = Philox4x32::Counter;
+        REQUIRE(Philox4x32(Philox4x32::Key { 0, 0 })(Counter { 0, 0, 0, 0 })
+                == Counter { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 });
+        REQUIRE(Philox4x32(Philox4x32::Key { 0xffffffff, 0xffffffff })(Counter { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff })
+                == Counter { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd });
+        REQUIRE(Philox4x32(Philox4x32::Key { 0xa4093822, 0x299f31d0 })(Counter { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 })
+                == Counter { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 });
+    }
+
+    SECTION("Uniforms lie within the open unit interval")
+    {
+        REQUIRE(Philox4x32::uniform<value_type>(0) > 0);
+        REQUIRE(Philox4x32::uniform<value_type>(0xffffffff) < 1);
+    }
+}
+
+TEST_CASE("Sobol low discrepancy sequence", "[monte_carlo]")
+{
+    const Sobol sobol(SOBOL_DIMENSIONS);
+    std::vector<std::uint32_t> points(1024 * SOBOL_DIMENSIONS);
+    sobol.generate(0, 1024, points);
+
+    SECTION("Leading points, in Gray code order")
+    {
+        const auto point = [&](std::size_t index, std::size_t dim) { return points[(index * SOBOL_DIMENSIONS) + dim]; };
+        REQUIRE(point(0, 0) == 0);
+        REQUIRE(point(1, 0) == 0x80000000);
+        REQUIRE(point(2, 0) == 0xC0000000);
+        REQUIRE(point(3, 0) == 0x40000000);
+        REQUIRE(point(2, 1) == 0x40000000);
+        REQUIRE(point(4, 3) == 0xE0000000);
+    }
+
+    SECTION("Each dimension is stratified over every power of two points")
+    {
+        for (std::size_t dim = 0; dim < SOBOL_DIMENSIONS; ++dim) {
+            std::vector<int> strata(1024, 0);
+            for (std::size_t index = 0; index < 1024; ++index) {
+                ++strata[points[(index * SOBOL_DIMENSIONS) + dim] >> 22];
+            }
+            REQUIRE(std::all_of(strata.begin(), strata.end(), [](int count) { return count == 1; }));
+        }
+    }
+
+    SECTION("Points generated from an offset match the full sequence")
+    {
+        std::vector<std::uint32_t> offset(100 * SOBOL_DIMENSIONS);
+        sobol.generate(517, 100, offset);
+        REQUIRE(std::equal(offset.begin(), offset.end(), points.begin() + (517 * SOBOL_DIMENSIONS)));
+    }
+
+    SECTION("Dimensions beyond those bundled are rejected")
+    {
+        REQUIRE_THROWS(Sobol(SOBOL_DIMENSIONS + 1));
+        REQUIRE_THROWS(MonteCarlo<value_type>(Simulation { 1024, SOBOL_DIMENSIONS + 1, MC_SEED, true, true, Sequence::Sobol }));
+    }
+}
+
+TEST_CASE("Brownian bridge construction", "[monte_carlo]")
+{
+    // The bridge is a linear map of independent normals, which must preserve their
+    // covariance for the increments to be independent standard normals, i.e. be orthogonal
+    for (const std::size_t steps : { 1, 5, 8, 12 }) {
+        const BrownianBridge<value_type> bridge(steps);
+        std::vector<std::vector<value_type>> columns(steps, std::vector<value_type>(steps));
+        for (std::size_t i = 0; i < steps; ++i) {
+            std::vector<value_type> unit(steps, 0);
+            unit[i] = 1;
+            bridge.transform(unit.data(), columns[i].data());
+        }
+
+        for (std::size_t row = 0; row < steps; ++row) {
+            for (std::size_t col = 0; col < steps; ++col) {
+                value_type covariance = 0;
+                for (std::size_t i = 0; i < steps; ++i) {
+                    covariance += columns[i][row] * columns[i][col];
+                }
+                REQUIRE(compareFloat(covariance, (row == col) ? 1 : 0, 1E-12));
+            }
+        }
+    }
+}
+
+TEST_CASE("Monte Carlo prices converge to Black Scholes", "[monte_carlo]")
+{
+    const OptionValues<value_type> input { 100.00, 95.00, 0.75, 0.25, 0.05, 0.02 };
+    const BlackScholes<value_type> bsm;
+
+    SECTION("Plain simulation CALL and PUT lie within their standard error")
+    {
+        const MonteCarlo<value_type> mc(Simulation { 1 << 18, 1, MC_SEED, false, false });
+        const auto call = mc.estimate<CallExecutor>(input);
+        const auto put = mc.estimate<PutExecutor>(input);
+
+        REQUIRE(call.paths_ == (1 << 18));
+        REQUIRE(std::fabs(call.value_ - bsm.callOptionValue(input)) < 4 * call.standardError_);
+        REQUIRE(std::fabs(put.value_ - bsm.putOptionValue(input)) < 4 * put.standardError_);
+        REQUIRE(compareFloat(call.value_, bsm.callOptionValue(input), 0.1));
+        REQUIRE(compareFloat(put.value_, bsm.putOptionValue(input), 0.1));
+    }
+
+    SECTION("Antithetic paths reduce the standard error")
+    {
+        const MonteCarlo<value_type> plain(Simulation { 1 << 16, 1, MC_SEED, false, false });
+        const MonteCarlo<value_type> antithetic(Simulation { 1 << 16, 1, MC_SEED, true, false });
+        const auto estimate = antithetic.estimate<CallExecutor>(input);
+
+        REQUIRE(estimate.standardError_ < plain.estimate<CallExecutor>(input).standardError_);
+        REQUIRE(std::fabs(estimate.value_ - bsm.callOptionValue(input)) < 4 * estimate.standardError_);
+    }
+
+    SECTION("European control variate recovers the closed form value")
+    {
+        const MonteCarlo<value_type> mc(Simulation { 1 << 12 });
+        REQUIRE(compareFloat(mc.callOptionValue(input), bsm.callOptionValue(input), 1E-9));
+        REQUIRE(compareFloat(mc.putOptionValue(input), bsm.putOptionValue(input), 1E-9));
+    }
+
+    SECTION("Multi step paths converge to the terminal distribution")
+    {
+        const MonteCarlo<value_type> mc(Simulation { 1 << 16, 12, MC_SEED, true, false });
+        const auto estimate = mc.estimate<PutExecutor>(input);
+        REQUIRE(std::fabs(estimate.value_ - bsm.putOptionValue(input)) < 4 * estimate.standardError_);
+    }
+}
+
+TEST_CASE("Monte Carlo path dependent payoffs", "[monte_carlo]")
+{
+    const OptionValues<value_type> input { 100.00, 100.00, 1, 0.30, 0.04, 0.01 };
+    constexpr std::size_t steps = 12;
+
+    const auto geometricAverage = [&](std::span<const value_type> path) {
+        value_type logSum = 0;
+        for (const auto spot : path) {
+            logSum += std::log(spot);
+        }
+        return std::max<value_type>(std::exp(logSum / static_cast<value_type>(path.size())) - input.strikePrice_, 0);
+    };
+
+    // Closed form value of a call on the discrete geometric average
+    const auto n = static_cast<value_type>(steps);
+    const auto dt = input.timeToExpiry_ / n;
+    const auto mean = std::log(input.underlyingPrice_)
+        + ((input.riskFreeInterest_ - input.dividendYield_ - (input.volatility_ * input.volatility_ / 2)) * dt * (n + 1) / 2);
+    const auto deviation = input.volatility_ * std::sqrt(dt * (n + 1) * ((2 * n) + 1) / (6 * n));
+    const auto dTwo = (mean - std::log(input.strikePrice_)) / deviation;
+    const BlackScholes<value_type> bsm;
+    const auto expected = input.interestDiscount_
+        * ((std::exp(mean + (deviation * deviation / 2)) * bsm.cumulNormalDist(dTwo + deviation))
+           - (input.strikePrice_ * bsm.cumulNormalDist(dTwo)));
+
+    SECTION("Geometric average CALL converges to its closed form value")
+    {
+        const MonteCarlo<value_type> mc(Simulation { 1 << 17, steps, MC_SEED, true, false });
+        const auto estimate = mc.estimate<CallExecutor>(input, geometricAverage);
+        REQUIRE(std::fabs(estimate.value_ - expected) < 4 * estimate.standardError_);
+    }
+
+    SECTION("European control variate reduces the standard error")
+    {
+        const MonteCarlo<value_type> plain(Simulation { 1 << 16, steps, MC_SEED, true, false });
+        const MonteCarlo<value_type> controlled(Simulation { 1 << 16, steps, MC_SEED, true, true });
+        const auto estimate = controlled.estimate<CallExecutor>(input, geometricAverage);
+
+        REQUIRE(estimate.standardError_ < plain.estimate<CallExecutor>(input, geometricAverage).standardError_);
+        REQUIRE(std::fabs(estimate.value_ - expected) < 4 * estimate.standardError_);
+    }
+
+    SECTION("Estimates do not depend on the number of threads")
+    {
+        const MonteCarlo<value_type> mc(Simulation { 50000, steps });
+        ThreadPool pool(4);
+        const auto serial = mc.estimate<CallExecutor>(input, geometricAverage);
+        const auto parallel = mc.estimate<CallExecutor>(input, geometricAverage, &pool);
+
+        REQUIRE(serial.value_ == parallel.value_);
+        REQUIRE(serial.standardError_ == parallel.standardError_);
+        REQUIRE(serial.paths_ == 50000);
+    }
+}
+
+TEST_CASE("Quasi-random Monte Carlo", "[monte_carlo]")
+{
+    const OptionValues<value_type> input { 100.00, 95.00, 0.75, 0.25, 0.05, 0.02 };
+    const BlackScholes<value_type> bsm;
+
+    SECTION("Sobol CALL and PUT converge faster than pseudo-random paths")
+    {
+        const MonteCarlo<value_type> pseudo(Simulation { 1 << 14, 1, MC_SEED, false, false });
+        const MonteCarlo<value_type> sobol(Simulation { 1 << 14, 1, MC_SEED, false, false, Sequence::Sobol });
+
+        const auto call = sobol.estimate<CallExecutor>(input);
+        const auto put = sobol.estimate<PutExecutor>(input);
+
+        REQUIRE(call.paths_ == (1 << 14));
+        REQUIRE(call.standardError_ < pseudo.estimate<CallExecutor>(input).standardError_ / 10);
+        REQUIRE(put.standardError_ < pseudo.estimate<PutExecutor>(input).standardError_ / 10);
+        REQUIRE(std::fabs(call.value_ - bsm.callOptionValue(input)) < 4 * call.standardError_);
+        REQUIRE(std::fabs(put.value_ - bsm.putOptionValue(input)) < 4 * put.standardError_);
+        REQUIRE(compareFloat(call.value_, bsm.callOptionValue(input), DP2 * 2));
+        REQUIRE(compareFloat(put.value_, bsm.putOptionValue(input), DP2 * 2));
+    }
+
+    SECTION("Bridged multi step paths converge to the terminal distribution")
+    {
+        const MonteCarlo<value_type> mc(Simulation { 1 << 14, 12, MC_SEED, true, false, Sequence::Sobol });
+        const auto estimate = mc.estimate<CallExecutor>(input);
+        REQUIRE(std::fabs(estimate.value_ - bsm.callOptionValue(input)) < 4 * estimate.standardError_);
+        REQUIRE(compareFloat(estimate.value_, bsm.callOptionValue(input), DP2));
+    }
+
+    SECTION("Estimates do not depend on the number of threads")
+    {
+        const MonteCarlo<value_type> mc(Simulation { 100000, 6, MC_SEED, true, true, Sequence::Sobol });
+        ThreadPool pool(4);
+        const auto serial = mc.estimate<PutExecutor>(input);
+        const auto parallel = mc.estimate<PutExecutor>(input, &pool);
+
+        REQUIRE(serial.value_ == parallel.value_);
+        REQUIRE(serial.standardError_ == parallel.standardError_);
+    }
+}
+
+TEST_CASE("Monte Carlo pricing through the option and batch interfaces", "[monte_carlo]")
+{
+    const MonteCarlo<value_type> mc(Simulation { 1 << 12 });
+
+    SECTION("Option interface")
+    {
+        Option<CallExecutor, value_type, MonteCarlo<value_type>> option(OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 }, mc);
+        REQUIRE(compareFloat(option(), BlackScholes<value_type>().callOptionValue(OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 }), DP3));
+
+        // Greeks are of the simulation, repriced over the same paths
+        Option<CallExecutor> closedForm(OptionValues<value_type> { 100.00, 95.00, 1, 0.18, 0.05 });
+        REQUIRE(compareFloat(option.delta(), closedForm.delta(), 0.01));
+        REQUIRE(compareFloat(option.vega(), closedForm.vega(), 0.5));
+        REQUIRE(std::isnan(option.speed()));
+    }
+
+    SECTION("Batches priced in parallel match scalar pricing")
+    {
+        OptionBatch<value_type> batch;
+        for (std::size_t row = 0; row < 300; ++row) {
+            const auto type = (row % 2) ? OptionType::Put : OptionType::Call;
+            batch.push(type, OptionValues<value_type> { 80.00 + static_cast<value_type>(row % 40), 100.00, 0.5, 0.25, 0.03 });
+        }
+
+        ThreadPool pool(4);
+        ParallelPricer<value_type, MonteCarlo<value_type>> parallel(pool, OutputMask { Output::Price }, {}, mc);
+        BatchResults<value_type> results;
+        parallel(batch, results);
+
+        REQUIRE(compareFloat(results.price_[7], mc.putOptionValue(batch.values(7)), 0));
+        REQUIRE(compareFloat(results.price_[298], mc.callOptionValue(batch.values(298)), 0));
+    }
+}
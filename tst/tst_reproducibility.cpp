@@ -0,0 +1,114 @@
+#include "aggregation.h"
+#include "batch.h"
+#include "constants.h"
+#include "discount_curve.h"
+#include "finite_difference.h"
+#include "options.h"
+#include "output_writer.h"
+#include "reduction.h"
+#include "thread_pool.h"
+#include "tst_helpers.h"
+#include "vol_surface.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <string>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+
+TEST_CASE("Compensated sums", "[reproducibility]")
+{
+    SECTION("Cancelled low order terms are recovered")
+    {
+        CompensatedSum sum;
+        for (const auto term : { 1E16, 1.0, -1E16, 1.0 }) {
+            sum += term;
+        }
+        REQUIRE(sum.value() == 2.0);
+    }
+
+    SECTION("Partial sums combine as one sum")
+    {
+        CompensatedSum whole, lhs, rhs;
+        for (int i = 0; i < 1000; ++i) {
+            const auto term = ((i % 2) ? -1.0 : 1.0) * (1E10 + (0.1 * i));
+            whole += term;
+            ((i < 500) ? lhs : rhs) += term;
+        }
+        lhs += rhs;
+        REQUIRE(lhs.value() == whole.value());
+        REQUIRE(compareFloat(whole.value(), -50.0, 1E-9));
+    }
+}
+
+TEST_CASE("Parallel results are identical regardless of thread count", "[reproducibility]")
+{
+    const std::vector<VolSurface<value_type>> surfaces {
+        VolSurface<value_type>({ 0.8, 1.0, 1.2 }, { 0.5, 2.0 }, { 0.26, 0.20, 0.23, 0.24, 0.21, 0.22 }),
+    };
+    const std::vector<DiscountCurve<value_type>> curves {
+        DiscountCurve<value_type>({ 0.5, 1.0, 5.0 }, { 0.99, 0.975, 0.88 }),
+    };
+    const MarketData<value_type> market { {}, surfaces, curves };
+    const auto outputs = OutputMask::all();
+
+    // More rows than a batch, across several chunks, with a partial final chunk
+    OptionBatch<value_type> batch;
+    for (std::size_t row = 0; row < BATCH_SIZE + 333; ++row) {
+        const auto type = (row % 5 < 2) ? OptionType::Put : OptionType::Call;
+        const auto strike = 70.0 + static_cast<value_type>(row % 61);
+        const auto time = 0.05 + static_cast<value_type>(row % 53) * 0.09;
+        const auto quantity = static_cast<value_type>(static_cast<int>(row % 17) - 8) * 1.5;
+        batch.push(type, OptionValues<value_type> { 100.00, strike, time, 0.19, 0.02, 0.01 },
+                   static_cast<std::uint32_t>(row % 4),
+                   (row % 3 == 0) ? 0 : NO_SURFACE,
+                   (row % 7 == 0) ? 0 : NO_CURVE,
+                   quantity, static_cast<std::uint32_t>(row % 5));
+    }
+
+    struct Run
+    {
+        std::string contracts;
+        std::string aggregates;
+        BatchResults<value_type> numeric;
+    };
+
+    const auto run = [&](std::size_t threads) {
+        ThreadPool pool(threads);
+        ParallelPricer<value_type> pricer(pool, outputs, market);
+        Aggregator<value_type> aggregator(pool, outputs);
+        FiniteDifference<value_type> numeric(pool, market);
+        OutputWriter<value_type> writer(outputs);
+        AggregateWriter aggregateWriter(outputs);
+
+        Run result;
+        BatchResults<value_type> results;
+        pricer(batch, results);
+        aggregator(batch, results);
+        numeric(batch, result.numeric);
+        result.contracts = writer.format(batch, results);
+        result.aggregates = aggregateWriter.format(aggregator.totals());
+        return result;
+    };
+
+    const auto serial = run(1);
+    REQUIRE_FALSE(serial.contracts.empty());
+    REQUIRE_FALSE(serial.aggregates.empty());
+
+    for (const auto threads : { std::size_t{2}, std::size_t{8}, defaultThreads() }) {
+        const auto parallel = run(threads);
+        REQUIRE(parallel.contracts == serial.contracts);
+        REQUIRE(parallel.aggregates == serial.aggregates);
+        for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+            const auto &lhs = parallel.numeric.column(static_cast<Output>(output));
+            const auto &rhs = serial.numeric.column(static_cast<Output>(output));
+            REQUIRE(lhs.size() == rhs.size());
+            REQUIRE(std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](value_type left, value_type right) {
+                return std::bit_cast<std::uint64_t>(left) == std::bit_cast<std::uint64_t>(right);
+            }));
+        }
+    }
+}
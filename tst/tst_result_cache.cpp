@@ -0,0 +1,256 @@
+#include "async_pricer.h"
+#include "batch.h"
+#include "constants.h"
+#include "lattice.h"
+#include "options.h"
+#include "result_cache.h"
+#include "thread_pool.h"
+#include "tst_helpers.h"
+
+#include <coroutine>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+
+namespace
+{
+
+// Batch of distinct contracts, each repeated once, in reverse order, after all of them
+auto repeatedBatch(std::size_t distinct) -> OptionBatch<value_type> {
+    OptionBatch<value_type> batch;
+    for (std::size_t row = 0; row < 2 * distinct; ++row) {
+        const auto contract = (row < distinct) ? row : (2 * distinct - row - 1);
+        const auto type = (contract % 3 == 0) ? OptionType::Put : OptionType::Call;
+        const auto strike = 70.0 + static_cast<value_type>(contract % 61);
+        const auto time = 0.05 + static_cast<value_type>(contract % 53) * 0.09;
+        batch.push(type, OptionValues<value_type> { 100.00, strike, time, 0.19, 0.02, 0.01 });
+    }
+    return batch;
+}
+
+auto identical(const BatchResults<value_type> &lhs, const BatchResults<value_type> &rhs) -> bool {
+    for (std::size_t output = 0; output < NUM_OUTPUTS; ++output) {
+        const auto &lhsColumn = lhs.column(static_cast<Output>(output));
+        const auto &rhsColumn = rhs.column(static_cast<Output>(output));
+        if (lhsColumn.size() != rhsColumn.size()
+            || std::memcmp(lhsColumn.data(), rhsColumn.data(), lhsColumn.size() * sizeof(value_type)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+TEST_CASE("Contract keys", "[cache]")
+{
+    const OptionValues<value_type> values { 100.00, 95.00, 0.5, 0.2, 0.03, 0.01 };
+
+    SECTION("Equal inputs share a key, and differing types or inputs do not")
+    {
+        const ContractKey<value_type> call(OptionType::Call, values);
+        REQUIRE(call == ContractKey<value_type>(OptionType::Call, values));
+        REQUIRE(call.hash_ == ContractKey<value_type>(OptionType::Call, values).hash_);
+        REQUIRE_FALSE(call == ContractKey<value_type>(OptionType::Put, values));
+
+        auto bumped = values;
+        bumped.strikePrice_ = std::nextafter(values.strikePrice_, 100.0);
+        REQUIRE_FALSE(call == ContractKey<value_type>(OptionType::Call, bumped));
+    }
+
+    SECTION("Negative zero is keyed as zero")
+    {
+        auto zero = values;
+        auto negative = values;
+        zero.dividendYield_ = 0.0;
+        negative.dividendYield_ = -0.0;
+        const ContractKey<value_type> lhs(OptionType::Put, zero);
+        const ContractKey<value_type> rhs(OptionType::Put, negative);
+        REQUIRE(lhs == rhs);
+        REQUIRE(lhs.hash_ == rhs.hash_);
+    }
+}
+
+TEST_CASE("Result cache", "[cache]")
+{
+    const auto outputs = OutputMask { Output::Price, Output::Delta };
+    Quote<value_type> quote;
+    quote.values_[static_cast<std::size_t>(Output::Price)] = 4.25;
+
+    const auto key = [](std::size_t i) {
+        return ContractKey<value_type>(OptionType::Call,
+                                       OptionValues<value_type> { 100.00, 50.0 + static_cast<value_type>(i), 0.5, 0.2, 0.03 });
+    };
+
+    SECTION("Inserted quotes are found, and counted as hits")
+    {
+        ResultCache<value_type> cache(8, outputs);
+        Quote<value_type> found;
+        REQUIRE_FALSE(cache.find(key(0), found));
+        cache.insert(key(0), quote);
+        REQUIRE(cache.find(key(0), found));
+        REQUIRE(found.values_ == quote.values_);
+
+        const auto stats = cache.stats();
+        REQUIRE(stats.hits_ == 1);
+        REQUIRE(stats.misses_ == 1);
+        REQUIRE(stats.size_ == 1);
+        REQUIRE(stats.hitRate() == 0.5);
+    }
+
+    SECTION("Entries are evicted at capacity, sparing those referenced since the hand passed")
+    {
+        ResultCache<value_type> cache(3, outputs, 1);
+        for (std::size_t i = 0; i < 3; ++i) {
+            cache.insert(key(i), quote);
+        }
+        Quote<value_type> found;
+        REQUIRE(cache.find(key(0), found));
+
+        cache.insert(key(3), quote);
+        REQUIRE(cache.stats().evictions_ == 1);
+        REQUIRE(cache.stats().size_ == 3);
+        REQUIRE(cache.find(key(0), found));
+        REQUIRE_FALSE(cache.find(key(1), found));
+        REQUIRE(cache.find(key(2), found));
+        REQUIRE(cache.find(key(3), found));
+    }
+
+    SECTION("A cache holds at least one entry")
+    {
+        REQUIRE_THROWS_AS(ResultCache<value_type>(0, outputs), std::runtime_error);
+    }
+
+    SECTION("A cache holds no more entries than its capacity, however sharded")
+    {
+        for (const std::size_t capacity : { 1, 5, 16, 17, 100 }) {
+            ResultCache<value_type> cache(capacity, outputs);
+            REQUIRE(cache.capacity() == capacity);
+            for (std::size_t i = 0; i < 4 * capacity; ++i) {
+                cache.insert(key(i), quote);
+            }
+            REQUIRE(cache.stats().size_ <= capacity);
+        }
+
+        // A single entry is never evicted by its own insertion
+        ResultCache<value_type> single(1, outputs);
+        single.insert(key(0), quote);
+        single.insert(key(1), quote);
+        Quote<value_type> found;
+        REQUIRE(single.find(key(1), found));
+        REQUIRE_FALSE(single.find(key(0), found));
+    }
+}
+
+TEST_CASE("Cached batch pricing", "[cache]")
+{
+    const auto outputs = OutputMask::all();
+    const auto batch = repeatedBatch(300);
+
+    BatchResults<value_type> expected;
+    BatchPricer<value_type> uncached(outputs);
+    uncached(batch, expected);
+
+    SECTION("Repeated rows are priced once, with results identical to uncached pricing")
+    {
+        ResultCache<value_type> cache(1000, outputs);
+        BatchPricer<value_type> pricer(outputs, {}, {}, &cache);
+        BatchResults<value_type> results;
+        pricer(batch, results);
+        REQUIRE(identical(results, expected));
+        REQUIRE(cache.stats().hits_ == 0);
+        REQUIRE(cache.stats().size_ == 300);
+
+        // Repricing the batch is answered wholly by the cache
+        BatchResults<value_type> cached;
+        pricer(batch, cached);
+        REQUIRE(identical(cached, expected));
+        REQUIRE(cache.stats().hits_ == batch.size());
+        REQUIRE(cache.stats().size_ == 300);
+    }
+
+    SECTION("Results are unaffected by a cache too small to hold the batch")
+    {
+        ResultCache<value_type> cache(20, outputs, 4);
+        BatchPricer<value_type> pricer(outputs, {}, {}, &cache);
+        for (int run = 0; run < 3; ++run) {
+            BatchResults<value_type> results;
+            pricer(batch, results);
+            REQUIRE(identical(results, expected));
+        }
+        REQUIRE(cache.stats().evictions_ > 0);
+        REQUIRE(cache.stats().size_ <= cache.capacity());
+    }
+
+    SECTION("Parallel pricers sharing a cache match serial pricing")
+    {
+        ResultCache<value_type> cache(1000, outputs);
+        ThreadPool pool(4);
+        ParallelPricer<value_type> pricer(pool, outputs, {}, {}, &cache);
+        for (int run = 0; run < 2; ++run) {
+            BatchResults<value_type> results;
+            pricer(batch, results);
+            REQUIRE(identical(results, expected));
+        }
+    }
+
+    SECTION("A cache of other outputs is rejected")
+    {
+        ResultCache<value_type> cache(1000, OutputMask::firstOrder());
+        REQUIRE_THROWS_AS(BatchPricer<value_type>(outputs, {}, {}, &cache), std::runtime_error);
+    }
+
+    SECTION("A cache of another model is rejected")
+    {
+        using LatticePricer = BatchPricer<value_type, Lattice<value_type>>;
+        ResultCache<value_type> cache(1000, outputs);
+        BatchPricer<value_type> pricer(outputs, {}, {}, &cache);
+        BatchPricer<value_type> same(outputs, {}, {}, &cache);
+        REQUIRE_THROWS_WITH(LatticePricer(outputs, {}, Lattice<value_type>(), &cache),
+                            "Cannot share a result cache between different models");
+
+        // Nor are models of other settings shared
+        ResultCache<value_type> latticeCache(1000, outputs);
+        LatticePricer lattice(outputs, {}, Lattice<value_type>(100), &latticeCache);
+        LatticePricer sameLattice(outputs, {}, Lattice<value_type>(100), &latticeCache);
+        REQUIRE_THROWS_WITH(LatticePricer(outputs, {}, Lattice<value_type>(200), &latticeCache),
+                            "Cannot share a result cache between different models");
+
+        ThreadPool pool(2);
+        REQUIRE_THROWS_AS((ParallelPricer<value_type, Lattice<value_type>>(pool, outputs, {}, Lattice<value_type>(), &cache)),
+                          std::runtime_error);
+    }
+}
+
+TEST_CASE("Awaited quotes share a result cache", "[cache][async]")
+{
+    const auto outputs = OutputMask { Output::Price, Output::Delta, Output::Vega };
+    const OptionValues<value_type> values { 100.00, 95.00, 0.5, 0.2, 0.03 };
+    ResultCache<value_type> cache(64, outputs);
+    AsyncPricer<value_type> pricer(outputs, {}, {}, &cache);
+
+    // The same contract requested by several callers, and then again
+    std::vector<std::optional<Quote<value_type>>> results(6);
+    for (std::size_t i = 0; i < 4; ++i) {
+        quote(pricer, OptionType::Call, values, results[i]);
+    }
+    pricer.flush();
+    for (std::size_t i = 4; i < results.size(); ++i) {
+        quote(pricer, OptionType::Call, values, results[i]);
+    }
+    pricer.flush();
+
+    Option<CallExecutor> option(OptionValues<value_type>(values), outputs);
+    for (const auto &result : results) {
+        REQUIRE(result.has_value());
+        REQUIRE(result->values_ == results.front()->values_);
+        REQUIRE(compareFloat(result->values_[static_cast<std::size_t>(Output::Price)], option(), 1E-12));
+    }
+    REQUIRE(cache.stats().size_ == 1);
+    REQUIRE(cache.stats().hits_ == 2);
+}
@@ -0,0 +1,107 @@
+#include "thread_pool.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+
+TEST_CASE("Thread pool runs every chunk once", "[thread_pool]")
+{
+    ThreadPool pool(4);
+    REQUIRE(pool.size() == 4);
+
+    std::vector<int> visits(1000, 0);
+    pool.parallelFor(visits.size(), 64, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            ++visits[i];
+        }
+    });
+    REQUIRE(std::all_of(visits.begin(), visits.end(), [](int count) { return count == 1; }));
+
+    SECTION("Exceptions thrown by chunks are rethrown to the caller")
+    {
+        REQUIRE_THROWS(pool.parallelFor(visits.size(), 64, [](std::size_t begin, std::size_t) {
+            if (begin == 512) {
+                throw std::runtime_error("chunk failed");
+            }
+        }));
+    }
+}
+
+TEST_CASE("Pinned thread pools split chunks by node", "[thread_pool]")
+{
+    // Two nodes, both on CPU 0, so pinning succeeds on any machine
+    const std::vector<NumaNode> topology { { 0, { 0 } }, { 1, { 0 } } };
+
+    for (const auto placement : { Placement::Nodes, Placement::Cores }) {
+        ThreadPool pool(4, placement, topology);
+        REQUIRE(pool.size() == 4);
+        REQUIRE(pool.nodes() == 2);
+
+        std::vector<int> visits(1000, 0);
+        pool.parallelFor(visits.size(), 64, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                ++visits[i];
+            }
+        });
+        REQUIRE(std::all_of(visits.begin(), visits.end(), [](int count) { return count == 1; }));
+    }
+
+    SECTION("Unpinned pools share every chunk")
+    {
+        const ThreadPool pool(4, Placement::None, topology);
+        REQUIRE(pool.nodes() == 1);
+    }
+
+    SECTION("Placements are parsed by name")
+    {
+        REQUIRE(parsePlacement("nodes") == Placement::Nodes);
+        REQUIRE(parsePlacement("cores") == Placement::Cores);
+        REQUIRE(parsePlacement("none") == Placement::None);
+        REQUIRE_THROWS(parsePlacement("sockets"));
+    }
+}
+
+TEST_CASE("NUMA topology discovery", "[thread_pool]")
+{
+    SECTION("CPU lists are parsed as ranges")
+    {
+        REQUIRE(parseCpuList("0-3,8,10-11\n") == std::vector<std::uint32_t> { 0, 1, 2, 3, 8, 10, 11 });
+        REQUIRE(parseCpuList("5") == std::vector<std::uint32_t> { 5 });
+        REQUIRE(parseCpuList("").empty());
+        REQUIRE(parseCpuList("3-1").empty());
+        REQUIRE(parseCpuList("a-b").empty());
+    }
+
+    SECTION("Nodes are read from sysfs")
+    {
+        const auto root = std::filesystem::temp_directory_path() / "bsm_tst_nodes";
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root / "node0");
+        std::filesystem::create_directories(root / "node1");
+        std::ofstream(root / "online") << "0-1\n";
+        std::ofstream(root / "node0" / "cpulist") << "0-3,8-11\n";
+        std::ofstream(root / "node1" / "cpulist") << "4-7\n";
+
+        const auto nodes = discoverTopology(root.string());
+        REQUIRE(nodes.size() == 2);
+        REQUIRE(nodes[0].cpus_.size() == 8);
+        REQUIRE(nodes[1].id_ == 1);
+        REQUIRE(nodes[1].cpus_ == std::vector<std::uint32_t> { 4, 5, 6, 7 });
+        std::filesystem::remove_all(root);
+    }
+
+    SECTION("Machines without NUMA are a single node")
+    {
+        const auto nodes = discoverTopology("/nonexistent");
+        REQUIRE(nodes.size() == 1);
+        REQUIRE_FALSE(nodes[0].cpus_.empty());
+    }
+}
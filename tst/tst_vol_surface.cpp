@@ -0,0 +1,191 @@
+#include "batch.h"
+#include "constants.h"
+#include "input_reader.h"
+#include "options.h"
+#include "tst_helpers.h"
+#include "vol_surface.h"
+
+#include <sstream>
+
+#include "catch2/catch.hpp"
+
+using namespace bsm;
+using Catch::Matchers::Contains;
+
+TEST_CASE("Volatility surface grid axes", "[surface]")
+{
+    const GridAxis<value_type> regular({ 0.8, 0.9, 1.0, 1.1, 1.2 });
+    const GridAxis<value_type> irregular({ 0.8, 0.95, 1.0, 1.05, 1.2 });
+
+    SECTION("Regular spacing is detected")
+    {
+        REQUIRE(regular.regular());
+        REQUIRE_FALSE(irregular.regular());
+    }
+
+    SECTION("Constant time and binary search brackets agree")
+    {
+        for (const auto *axis : { &regular, &irregular }) {
+            for (value_type x = 0.75; x <= 1.25; x += 0.001) {
+                const auto [i, offset] = axis->bracket(x);
+                const auto clamped = std::clamp<value_type>(x, 0.8, 1.2);
+                REQUIRE(i < axis->size() - 1);
+                REQUIRE((*axis)[i] <= clamped);
+                REQUIRE(clamped <= (*axis)[i + 1]);
+                REQUIRE(compareFloat(offset, clamped - (*axis)[i], 1E-12));
+            }
+            // Exactly on each node
+            REQUIRE(axis->bracket((*axis)[2]).first == 2);
+        }
+    }
+
+    SECTION("Axes must be strictly increasing")
+    {
+        REQUIRE_THROWS(GridAxis<value_type>({ 0.8, 0.8, 1.0 }));
+        REQUIRE_THROWS(GridAxis<value_type>(std::vector<value_type> {}));
+    }
+}
+
+TEST_CASE("Volatility surface interpolation", "[surface]")
+{
+    const std::vector<value_type> moneyness { 0.8, 0.9, 1.0, 1.1, 1.2 };
+    const std::vector<value_type> expiries { 0.25, 1.0 };
+    const std::vector<value_type> vols {
+        0.30, 0.25, 0.20, 0.22, 0.26,
+        0.28, 0.24, 0.21, 0.22, 0.24,
+    };
+    const VolSurface<value_type> surface(moneyness, expiries, vols);
+
+    SECTION("Nodes are reproduced exactly")
+    {
+        for (std::size_t t = 0; t < expiries.size(); ++t) {
+            for (std::size_t k = 0; k < moneyness.size(); ++k) {
+                REQUIRE(compareFloat(surface.volatility(moneyness[k], expiries[t]), vols[(t * moneyness.size()) + k], 1E-12));
+            }
+        }
+    }
+
+    SECTION("Linear smiles are interpolated linearly")
+    {
+        const VolSurface<value_type> linear(moneyness, { 0.5 }, { 0.30, 0.28, 0.26, 0.24, 0.22 });
+        REQUIRE(compareFloat(linear.volatility(0.85, 0.5), 0.29, 1E-12));
+        REQUIRE(compareFloat(linear.volatility(1.13, 0.5), 0.234, 1E-12));
+    }
+
+    SECTION("Smiles are smooth between nodes")
+    {
+        const auto lhs = surface.volatility(1.0 - 1E-7, 0.25);
+        const auto rhs = surface.volatility(1.0 + 1E-7, 0.25);
+        REQUIRE(compareFloat(lhs, rhs, 1E-6));
+        REQUIRE(surface.volatility(0.95, 0.25) < 0.25);
+        REQUIRE(surface.volatility(0.95, 0.25) > 0.20);
+    }
+
+    SECTION("Total variance is interpolated linearly between expiries")
+    {
+        const auto variance = ((0.20 * 0.20 * 0.25) + (0.21 * 0.21 * 1.0)) / 2;
+        REQUIRE(compareFloat(surface.volatility(1.0, 0.625), std::sqrt(variance / 0.625), 1E-12));
+    }
+
+    SECTION("Volatility is extrapolated flat beyond the grid")
+    {
+        REQUIRE(compareFloat(surface.volatility(0.5, 0.25), 0.30, 1E-12));
+        REQUIRE(compareFloat(surface.volatility(1.5, 2.0), 0.24, 1E-12));
+        REQUIRE(compareFloat(surface.volatility(1.0, 0.1), 0.20, 1E-12));
+        REQUIRE(compareFloat(surface.volatility(100.00, 100.00, 0.25), 0.20, 1E-12));
+    }
+
+    SECTION("Surfaces require a volatility for every node")
+    {
+        REQUIRE_THROWS(VolSurface<value_type>(moneyness, expiries, { 0.2, 0.2 }));
+        REQUIRE_THROWS(VolSurface<value_type>({ 1.0 }, { 1.0 }, { 0.2 }));
+        REQUIRE_THROWS(VolSurface<value_type>(moneyness, { 1.0 }, { 0.2, 0.2, 1.2, 0.2, 0.2 }));
+    }
+}
+
+TEST_CASE("Volatility surfaces read from CSV", "[surface]")
+{
+    SECTION("Surfaces are indexed by id")
+    {
+        std::istringstream input("surface_id,expiry,moneyness,volatility\n"
+                                 "1,0.5,0.9,0.25\n1,0.5,1.1,0.21\n1,1.0,0.9,0.24\n1,1.0,1.1,0.22\n");
+        const auto surfaces = readSurfaces<value_type>(input);
+        REQUIRE(surfaces.size() == 2);
+        REQUIRE(surfaces[0].empty());
+        REQUIRE(compareFloat(surfaces[1].volatility(1.0, 0.5), 0.23, 1E-12));
+    }
+
+    SECTION("Incomplete grids are rejected")
+    {
+        std::istringstream input("0,0.5,0.9,0.25\n0,0.5,1.1,0.21\n0,1.0,0.9,0.24\n");
+        REQUIRE_THROWS_WITH(readSurfaces<value_type>(input), Contains("every moneyness node"));
+    }
+
+    SECTION("Malformed fields are rejected")
+    {
+        std::istringstream input("0,0.5,x,0.25\n");
+        REQUIRE_THROWS_WITH(readSurfaces<value_type>(input), Contains("Cannot parse"));
+    }
+
+    SECTION("Ids beyond the maximum, or of no surface, are rejected")
+    {
+        for (const auto *id : { "65536", "4294967295" }) {
+            std::istringstream input(std::string(id) + ",0.5,1.0,0.25\n");
+            REQUIRE_THROWS_WITH(readSurfaces<value_type>(input), Contains("cannot be greater than 65535"));
+        }
+        std::istringstream input("65535,0.5,0.9,0.25\n65535,0.5,1.1,0.21\n");
+        REQUIRE(readSurfaces<value_type>(input).size() == 65536);
+    }
+}
+
+TEST_CASE("Batches priced from volatility surfaces", "[surface]")
+{
+    const std::vector<VolSurface<value_type>> surfaces {
+        VolSurface<value_type>({ 0.9, 1.0, 1.1 }, { 0.5, 1.0 }, { 0.24, 0.20, 0.22, 0.23, 0.19, 0.21 }),
+    };
+
+    SECTION("Rows referencing a surface are priced at its volatility")
+    {
+        OptionBatch<value_type> batch;
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 0.75, 0.00, 0.05 }, 0, 0);
+        batch.push(OptionType::Put,  OptionValues<value_type> { 100.00, 105.00, 1.0, 0.00, 0.05 }, 0, 0);
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 0.75, 0.18, 0.05 });
+
+        BatchPricer<value_type> pricer(OutputMask { Output::Price, Output::Vega }, MarketData<value_type> { {}, surfaces });
+        BatchResults<value_type> results;
+        pricer(batch, results);
+
+        const auto callVol = surfaces[0].volatility(100.00, 95.00, 0.75);
+        const auto putVol = surfaces[0].volatility(100.00, 105.00, 1.0);
+        const BlackScholes<value_type> bsm;
+        REQUIRE(compareFloat(results.price_[0], bsm.callOptionValue(OptionValues<value_type> { 100.00, 95.00, 0.75, callVol, 0.05 }), 1E-12));
+        REQUIRE(compareFloat(results.price_[1], bsm.putOptionValue(OptionValues<value_type> { 100.00, 105.00, 1.0, putVol, 0.05 }), 1E-12));
+        REQUIRE(compareFloat(results.price_[2], bsm.callOptionValue(OptionValues<value_type> { 100.00, 95.00, 0.75, 0.18, 0.05 }), 1E-12));
+        REQUIRE(results.vega_[0] > 0);
+    }
+
+    SECTION("Unknown surfaces are rejected")
+    {
+        OptionBatch<value_type> batch;
+        batch.push(OptionType::Call, OptionValues<value_type> { 100.00, 95.00, 0.75, 0.00, 0.05 }, 0, 3);
+        BatchPricer<value_type> pricer(OutputMask { Output::Price }, MarketData<value_type> { {}, surfaces });
+        BatchResults<value_type> results;
+        REQUIRE_THROWS_WITH(pricer(batch, results), Contains("Cannot find volatility surface 3"));
+    }
+
+    SECTION("CSV input gives a surface id in place of volatility")
+    {
+        InputReader<value_type> reader(Format::CSV);
+        const auto expiry = getDateOffset(30);
+        const auto [type, values, surface, curve, position] = reader.getOptionValues("put,100.00,105.00," + expiry + ",@7,0.05,0.01,");
+        REQUIRE(type == OptionType::Put);
+        REQUIRE(values.has_value());
+        REQUIRE(surface == 7);
+        REQUIRE(curve == NO_CURVE);
+        REQUIRE(values->volatility_ == 0);
+
+        const auto [plainType, plainValues, plainSurface, plainCurve, plainPosition] = reader.getOptionValues("call,100.00,105.00," + expiry + ",0.2,0.05,0.01,");
+        REQUIRE(plainSurface == NO_SURFACE);
+        REQUIRE_FALSE(std::get<1>(reader.getOptionValues("call,100.00,105.00," + expiry + ",@x,0.05,0.01,")).has_value());
+    }
+}